@@ -0,0 +1,538 @@
+#include <stdlib.h>
+#include <math.h>
+#include "batch.h"
+
+/*
+	@file batch.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the batch collision tests. Each test is written once for every vector
+	unit, and the widest one the CPU has is picked when the program starts, so the file builds
+	without any -m flags and still runs on CPUs that lack AVX. Every width does the same float
+	math in the same order as smack.cpp, so all of them agree with it bit for bit.
+ */
+
+// Only x86 built with GCC or Clang gets the vector versions, everything else uses the scalar ones
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BATCH_X86
+#include <immintrin.h>
+#endif
+
+// Keep a * b + c as two roundings, fusing them would stop the answers matching smack.cpp
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+// The names of the vector units, in the same order as the enum
+const char* batchLevelNames[NUM_BATCH_LEVELS] = {
+	"scalar",
+	"sse",
+	"avx2",
+	"avx512"
+};
+
+// The signatures of each test
+typedef uint32_t (*PointInCircleFunc)(float radius, float sx, float sy, const TargetBlock* block);
+typedef uint32_t (*PointInBoxFunc)(float x, float y, float halfW, float halfH, const TargetBlock* block);
+typedef uint32_t (*BoxInBoxFunc)(float x, float y, float w, float h, const TargetBlock* block);
+typedef uint32_t (*PointInTriangleFunc)(const float tri[3][2], const TargetBlock* block);
+
+// A struct holding every test for one vector unit
+typedef struct {
+	PointInCircleFunc pointInCircle;
+	PointInBoxFunc pointInBox;
+	BoxInBoxFunc boxInBox;
+	PointInTriangleFunc pointInTriangle;
+} BatchFuncs;
+
+/*
+	This function makes a mask with a bit set for every target in a block.
+	@param count The number of targets.
+	@return A mask with the low count bits set.
+ */
+static uint32_t countMask(int count)
+{
+	return (count >= 32) ? 0xFFFFFFFFu : ((1u << count) - 1);
+}
+
+/*
+	This function creates an empty block of targets.
+	@return A pointer to the block that was made.
+*/
+TargetBlock* createTargetBlock()
+{
+	// Clear it all so the lanes past the end of a block always hold real numbers
+	TargetBlock* block = (TargetBlock*)calloc(1, sizeof(TargetBlock));
+	return block;
+}
+
+/*
+	This function frees a block of targets.
+	@param block A pointer to the block to destroy.
+*/
+void destroyTargetBlock(TargetBlock* block)
+{
+	free(block);
+}
+
+
+
+/* Scalar tests */
+
+
+
+/*
+	These check one target at a time, the same way smack.cpp does.
+ */
+static uint32_t scalarPointInCircle(float radius, float sx, float sy, const TargetBlock* block)
+{
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k++){
+		float xSide = sx - block->x[k];
+		float ySide = sy - block->y[k];
+		float d = (xSide * xSide) + (ySide * ySide);
+		if (d < (radius * radius))
+			hits |= 1u << k;
+	}
+	return hits;
+}
+
+static uint32_t scalarPointInBox(float x, float y, float halfW, float halfH, const TargetBlock* block)
+{
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k++){
+		if ((fabsf(block->x[k] - x) <= halfW) && (fabsf(block->y[k] - y) <= halfH))
+			hits |= 1u << k;
+	}
+	return hits;
+}
+
+static uint32_t scalarBoxInBox(float x, float y, float w, float h, const TargetBlock* block)
+{
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k++){
+		if ((fabsf(x - block->x[k]) <= ((block->w[k] + w) / 2)) &&
+			(fabsf(y - block->y[k]) <= ((block->h[k] + h) / 2)))
+			hits |= 1u << k;
+	}
+	return hits;
+}
+
+static uint32_t scalarPointInTriangle(const float tri[3][2], const TargetBlock* block)
+{
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k++){
+		float px = block->x[k];
+		float py = block->y[k];
+		// Which side of each edge the point is on
+		bool b1 = ((px - tri[1][0]) * (tri[0][1] - tri[1][1]) - (tri[0][0] - tri[1][0]) * (py - tri[1][1])) < 0.0f;
+		bool b2 = ((px - tri[2][0]) * (tri[1][1] - tri[2][1]) - (tri[1][0] - tri[2][0]) * (py - tri[2][1])) < 0.0f;
+		bool b3 = ((px - tri[0][0]) * (tri[2][1] - tri[0][1]) - (tri[2][0] - tri[0][0]) * (py - tri[0][1])) < 0.0f;
+		if ((b1 == b2) && (b2 == b3))
+			hits |= 1u << k;
+	}
+	return hits;
+}
+
+// The scalar tests
+static const BatchFuncs scalarFuncs = { scalarPointInCircle, scalarPointInBox, scalarBoxInBox, scalarPointInTriangle };
+
+
+
+#ifdef BATCH_X86
+
+/* SSE tests, 4 targets at a time */
+
+
+
+/*
+	These check 4 targets per instruction, a block is walked a vector at a time and the lanes
+	past its end are masked off at the end.
+ */
+__attribute__((target("sse2")))
+static uint32_t ssePointInCircle(float radius, float sx, float sy, const TargetBlock* block)
+{
+	__m128 cx = _mm_set1_ps(sx);
+	__m128 cy = _mm_set1_ps(sy);
+	__m128 r2 = _mm_set1_ps(radius * radius);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 4){
+		__m128 xSide = _mm_sub_ps(cx, _mm_loadu_ps(&block->x[k]));
+		__m128 ySide = _mm_sub_ps(cy, _mm_loadu_ps(&block->y[k]));
+		__m128 d = _mm_add_ps(_mm_mul_ps(xSide, xSide), _mm_mul_ps(ySide, ySide));
+		hits |= (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(d, r2)) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("sse2")))
+static uint32_t ssePointInBox(float x, float y, float halfW, float halfH, const TargetBlock* block)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 cx = _mm_set1_ps(x);
+	__m128 cy = _mm_set1_ps(y);
+	__m128 hw = _mm_set1_ps(halfW);
+	__m128 hh = _mm_set1_ps(halfH);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 4){
+		__m128 dx = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(&block->x[k]), cx));
+		__m128 dy = _mm_andnot_ps(sign, _mm_sub_ps(_mm_loadu_ps(&block->y[k]), cy));
+		__m128 in = _mm_and_ps(_mm_cmple_ps(dx, hw), _mm_cmple_ps(dy, hh));
+		hits |= (uint32_t)_mm_movemask_ps(in) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("sse2")))
+static uint32_t sseBoxInBox(float x, float y, float w, float h, const TargetBlock* block)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 half = _mm_set1_ps(2.0f);
+	__m128 cx = _mm_set1_ps(x);
+	__m128 cy = _mm_set1_ps(y);
+	__m128 bw = _mm_set1_ps(w);
+	__m128 bh = _mm_set1_ps(h);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 4){
+		__m128 dx = _mm_andnot_ps(sign, _mm_sub_ps(cx, _mm_loadu_ps(&block->x[k])));
+		__m128 dy = _mm_andnot_ps(sign, _mm_sub_ps(cy, _mm_loadu_ps(&block->y[k])));
+		__m128 reachX = _mm_div_ps(_mm_add_ps(_mm_loadu_ps(&block->w[k]), bw), half);
+		__m128 reachY = _mm_div_ps(_mm_add_ps(_mm_loadu_ps(&block->h[k]), bh), half);
+		__m128 in = _mm_and_ps(_mm_cmple_ps(dx, reachX), _mm_cmple_ps(dy, reachY));
+		hits |= (uint32_t)_mm_movemask_ps(in) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("sse2")))
+static uint32_t ssePointInTriangle(const float tri[3][2], const TargetBlock* block)
+{
+	__m128 zero = _mm_setzero_ps();
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 4){
+		__m128 px = _mm_loadu_ps(&block->x[k]);
+		__m128 py = _mm_loadu_ps(&block->y[k]);
+		uint32_t side[3];
+		// Which side of each edge the points are on (edge e runs from corner e to corner e + 1)
+		for (int e = 0; e < 3; e++){
+			const float* v1 = tri[e];
+			const float* v2 = tri[(e + 1) % 3];
+			__m128 s = _mm_sub_ps(
+				_mm_mul_ps(_mm_sub_ps(px, _mm_set1_ps(v2[0])), _mm_set1_ps(v1[1] - v2[1])),
+				_mm_mul_ps(_mm_set1_ps(v1[0] - v2[0]), _mm_sub_ps(py, _mm_set1_ps(v2[1]))));
+			side[e] = (uint32_t)_mm_movemask_ps(_mm_cmplt_ps(s, zero));
+		}
+		hits |= (~(side[0] ^ side[1]) & ~(side[1] ^ side[2]) & 0xFu) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+// The SSE tests
+static const BatchFuncs sseFuncs = { ssePointInCircle, ssePointInBox, sseBoxInBox, ssePointInTriangle };
+
+
+
+/* AVX2 tests, 8 targets at a time */
+
+
+
+/*
+	These are the SSE tests at twice the width.
+ */
+__attribute__((target("avx2")))
+static uint32_t avx2PointInCircle(float radius, float sx, float sy, const TargetBlock* block)
+{
+	__m256 cx = _mm256_set1_ps(sx);
+	__m256 cy = _mm256_set1_ps(sy);
+	__m256 r2 = _mm256_set1_ps(radius * radius);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 8){
+		__m256 xSide = _mm256_sub_ps(cx, _mm256_loadu_ps(&block->x[k]));
+		__m256 ySide = _mm256_sub_ps(cy, _mm256_loadu_ps(&block->y[k]));
+		__m256 d = _mm256_add_ps(_mm256_mul_ps(xSide, xSide), _mm256_mul_ps(ySide, ySide));
+		hits |= (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(d, r2, _CMP_LT_OQ)) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("avx2")))
+static uint32_t avx2PointInBox(float x, float y, float halfW, float halfH, const TargetBlock* block)
+{
+	__m256 sign = _mm256_set1_ps(-0.0f);
+	__m256 cx = _mm256_set1_ps(x);
+	__m256 cy = _mm256_set1_ps(y);
+	__m256 hw = _mm256_set1_ps(halfW);
+	__m256 hh = _mm256_set1_ps(halfH);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 8){
+		__m256 dx = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_loadu_ps(&block->x[k]), cx));
+		__m256 dy = _mm256_andnot_ps(sign, _mm256_sub_ps(_mm256_loadu_ps(&block->y[k]), cy));
+		__m256 in = _mm256_and_ps(_mm256_cmp_ps(dx, hw, _CMP_LE_OQ), _mm256_cmp_ps(dy, hh, _CMP_LE_OQ));
+		hits |= (uint32_t)_mm256_movemask_ps(in) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("avx2")))
+static uint32_t avx2BoxInBox(float x, float y, float w, float h, const TargetBlock* block)
+{
+	__m256 sign = _mm256_set1_ps(-0.0f);
+	__m256 half = _mm256_set1_ps(2.0f);
+	__m256 cx = _mm256_set1_ps(x);
+	__m256 cy = _mm256_set1_ps(y);
+	__m256 bw = _mm256_set1_ps(w);
+	__m256 bh = _mm256_set1_ps(h);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 8){
+		__m256 dx = _mm256_andnot_ps(sign, _mm256_sub_ps(cx, _mm256_loadu_ps(&block->x[k])));
+		__m256 dy = _mm256_andnot_ps(sign, _mm256_sub_ps(cy, _mm256_loadu_ps(&block->y[k])));
+		__m256 reachX = _mm256_div_ps(_mm256_add_ps(_mm256_loadu_ps(&block->w[k]), bw), half);
+		__m256 reachY = _mm256_div_ps(_mm256_add_ps(_mm256_loadu_ps(&block->h[k]), bh), half);
+		__m256 in = _mm256_and_ps(_mm256_cmp_ps(dx, reachX, _CMP_LE_OQ), _mm256_cmp_ps(dy, reachY, _CMP_LE_OQ));
+		hits |= (uint32_t)_mm256_movemask_ps(in) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("avx2")))
+static uint32_t avx2PointInTriangle(const float tri[3][2], const TargetBlock* block)
+{
+	__m256 zero = _mm256_setzero_ps();
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 8){
+		__m256 px = _mm256_loadu_ps(&block->x[k]);
+		__m256 py = _mm256_loadu_ps(&block->y[k]);
+		uint32_t side[3];
+		// Which side of each edge the points are on (edge e runs from corner e to corner e + 1)
+		for (int e = 0; e < 3; e++){
+			const float* v1 = tri[e];
+			const float* v2 = tri[(e + 1) % 3];
+			__m256 s = _mm256_sub_ps(
+				_mm256_mul_ps(_mm256_sub_ps(px, _mm256_set1_ps(v2[0])), _mm256_set1_ps(v1[1] - v2[1])),
+				_mm256_mul_ps(_mm256_set1_ps(v1[0] - v2[0]), _mm256_sub_ps(py, _mm256_set1_ps(v2[1]))));
+			side[e] = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(s, zero, _CMP_LT_OQ));
+		}
+		hits |= (~(side[0] ^ side[1]) & ~(side[1] ^ side[2]) & 0xFFu) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+// The AVX2 tests
+static const BatchFuncs avx2Funcs = { avx2PointInCircle, avx2PointInBox, avx2BoxInBox, avx2PointInTriangle };
+
+
+
+/* AVX-512 tests, 16 targets at a time */
+
+
+
+/*
+	These are the AVX2 tests at twice the width, the compares write straight into mask registers.
+ */
+__attribute__((target("avx512f")))
+static uint32_t avx512PointInCircle(float radius, float sx, float sy, const TargetBlock* block)
+{
+	__m512 cx = _mm512_set1_ps(sx);
+	__m512 cy = _mm512_set1_ps(sy);
+	__m512 r2 = _mm512_set1_ps(radius * radius);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 16){
+		__m512 xSide = _mm512_sub_ps(cx, _mm512_loadu_ps(&block->x[k]));
+		__m512 ySide = _mm512_sub_ps(cy, _mm512_loadu_ps(&block->y[k]));
+		__m512 d = _mm512_add_ps(_mm512_mul_ps(xSide, xSide), _mm512_mul_ps(ySide, ySide));
+		hits |= (uint32_t)_mm512_cmp_ps_mask(d, r2, _CMP_LT_OQ) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("avx512f")))
+static uint32_t avx512PointInBox(float x, float y, float halfW, float halfH, const TargetBlock* block)
+{
+	__m512 cx = _mm512_set1_ps(x);
+	__m512 cy = _mm512_set1_ps(y);
+	__m512 hw = _mm512_set1_ps(halfW);
+	__m512 hh = _mm512_set1_ps(halfH);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 16){
+		__m512 dx = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(&block->x[k]), cx));
+		__m512 dy = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(&block->y[k]), cy));
+		__mmask16 in = _mm512_cmp_ps_mask(dx, hw, _CMP_LE_OQ) & _mm512_cmp_ps_mask(dy, hh, _CMP_LE_OQ);
+		hits |= (uint32_t)in << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("avx512f")))
+static uint32_t avx512BoxInBox(float x, float y, float w, float h, const TargetBlock* block)
+{
+	__m512 half = _mm512_set1_ps(2.0f);
+	__m512 cx = _mm512_set1_ps(x);
+	__m512 cy = _mm512_set1_ps(y);
+	__m512 bw = _mm512_set1_ps(w);
+	__m512 bh = _mm512_set1_ps(h);
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 16){
+		__m512 dx = _mm512_abs_ps(_mm512_sub_ps(cx, _mm512_loadu_ps(&block->x[k])));
+		__m512 dy = _mm512_abs_ps(_mm512_sub_ps(cy, _mm512_loadu_ps(&block->y[k])));
+		__m512 reachX = _mm512_div_ps(_mm512_add_ps(_mm512_loadu_ps(&block->w[k]), bw), half);
+		__m512 reachY = _mm512_div_ps(_mm512_add_ps(_mm512_loadu_ps(&block->h[k]), bh), half);
+		__mmask16 in = _mm512_cmp_ps_mask(dx, reachX, _CMP_LE_OQ) & _mm512_cmp_ps_mask(dy, reachY, _CMP_LE_OQ);
+		hits |= (uint32_t)in << k;
+	}
+	return hits & countMask(block->count);
+}
+
+__attribute__((target("avx512f")))
+static uint32_t avx512PointInTriangle(const float tri[3][2], const TargetBlock* block)
+{
+	__m512 zero = _mm512_setzero_ps();
+	uint32_t hits = 0;
+	for (int k = 0; k < block->count; k += 16){
+		__m512 px = _mm512_loadu_ps(&block->x[k]);
+		__m512 py = _mm512_loadu_ps(&block->y[k]);
+		uint32_t side[3];
+		// Which side of each edge the points are on (edge e runs from corner e to corner e + 1)
+		for (int e = 0; e < 3; e++){
+			const float* v1 = tri[e];
+			const float* v2 = tri[(e + 1) % 3];
+			__m512 s = _mm512_sub_ps(
+				_mm512_mul_ps(_mm512_sub_ps(px, _mm512_set1_ps(v2[0])), _mm512_set1_ps(v1[1] - v2[1])),
+				_mm512_mul_ps(_mm512_set1_ps(v1[0] - v2[0]), _mm512_sub_ps(py, _mm512_set1_ps(v2[1]))));
+			side[e] = (uint32_t)_mm512_cmp_ps_mask(s, zero, _CMP_LT_OQ);
+		}
+		hits |= (~(side[0] ^ side[1]) & ~(side[1] ^ side[2]) & 0xFFFFu) << k;
+	}
+	return hits & countMask(block->count);
+}
+
+// The AVX-512 tests
+static const BatchFuncs avx512Funcs = { avx512PointInCircle, avx512PointInBox, avx512BoxInBox, avx512PointInTriangle };
+
+#endif
+
+
+
+/* Picking a vector unit */
+
+
+
+/*
+	This function finds the widest vector unit this CPU has.
+	@return One of the BATCH_ levels.
+*/
+int batchBestLevel()
+{
+#ifdef BATCH_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return BATCH_AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return BATCH_AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return BATCH_SSE;
+#endif
+	return BATCH_SCALAR;
+}
+
+/*
+	This function finds the tests for a vector unit.
+	@param level One of the BATCH_ levels.
+	@return A pointer to the tests.
+ */
+static const BatchFuncs* levelFuncs(int level)
+{
+#ifdef BATCH_X86
+	if (level == BATCH_AVX512)
+		return &avx512Funcs;
+	if (level == BATCH_AVX2)
+		return &avx2Funcs;
+	if (level == BATCH_SSE)
+		return &sseFuncs;
+#endif
+	return &scalarFuncs;
+}
+
+// The vector unit in use and its tests, picked before main runs
+static int currentLevel = batchBestLevel();
+static const BatchFuncs* current = levelFuncs(currentLevel);
+
+/*
+	This function finds the vector unit the batch tests are running on.
+	@return One of the BATCH_ levels.
+*/
+int batchLevel()
+{
+	return currentLevel;
+}
+
+/*
+	This function picks the vector unit the batch tests run on, so the widths can be compared.
+	It must not be called while a world is being stepped.
+	@param level One of the BATCH_ levels.
+	@return True if the CPU has it, false (leaving things as they were) otherwise.
+*/
+bool setBatchLevel(int level)
+{
+	if ((level < 0) || (level > batchBestLevel()))
+		return false;
+	currentLevel = level;
+	current = levelFuncs(level);
+	return true;
+}
+
+
+
+/* The batch tests */
+
+
+
+/*
+	This function checks which points in a block lie inside a circle.
+	@param radius The radius of the circle.
+	@param sx The x co-ordinate of the circle.
+	@param sy The y co-ordinate of the circle.
+	@param block The points to check.
+	@return A mask with bit k set if point k is in the circle.
+*/
+uint32_t batchPointInCircle(float radius, float sx, float sy, const TargetBlock* block)
+{
+	return current->pointInCircle(radius, sx, sy, block);
+}
+
+/*
+	This function checks which points in a block lie inside a box.
+	@param x The x co-ordinate of the center of the box.
+	@param y The y co-ordinate of the center of the box.
+	@param halfW Half the width of the box.
+	@param halfH Half the height of the box.
+	@param block The points to check.
+	@return A mask with bit k set if point k is in the box.
+*/
+uint32_t batchPointInBox(float x, float y, float halfW, float halfH, const TargetBlock* block)
+{
+	return current->pointInBox(x, y, halfW, halfH, block);
+}
+
+/*
+	This function checks which boxes in a block overlap a box.
+	@param x The x co-ordinate of the center of the box.
+	@param y The y co-ordinate of the center of the box.
+	@param w The full width of the box.
+	@param h The full height of the box.
+	@param block The boxes to check, centered on their positions.
+	@return A mask with bit k set if box k overlaps the box.
+*/
+uint32_t batchBoxInBox(float x, float y, float w, float h, const TargetBlock* block)
+{
+	return current->boxInBox(x, y, w, h, block);
+}
+
+/*
+	This function checks which points in a block lie inside a triangle.
+	@param tri The three corners of the triangle.
+	@param block The points to check.
+	@return A mask with bit k set if point k is in the triangle.
+*/
+uint32_t batchPointInTriangle(const float tri[3][2], const TargetBlock* block)
+{
+	return current->pointInTriangle(tri, block);
+}
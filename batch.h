@@ -0,0 +1,136 @@
+#ifndef __BATCH__
+#define __BATCH__
+
+#include <stdint.h>
+
+/*
+	@file batch.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines collision tests that check one object (the probe) against a whole
+	block of others (the targets) at once. Each test gives back a mask with bit k set if target k
+	was hit. The tests run on the widest vector unit the CPU has (SSE does 4 targets at a time,
+	AVX2 does 8, and AVX-512 does 16), picked when the program starts. Every width gives exactly
+	the same answer as the scalar tests in smack.cpp.
+*/
+
+// The most targets a block can hold (a multiple of the widest vector, and it must fit in the mask)
+#define BATCH_MAX 32
+
+// The vector units a batch test can run on, from narrowest to widest
+enum {
+	BATCH_SCALAR,
+	BATCH_SSE,
+	BATCH_AVX2,
+	BATCH_AVX512,
+	NUM_BATCH_LEVELS
+};
+
+// The names of the vector units, in the same order as the enum
+extern const char* batchLevelNames[NUM_BATCH_LEVELS];
+
+// A struct holding a block of targets packed side by side for the batch tests
+typedef struct {
+	// The position of each target
+	float x[BATCH_MAX];
+	float y[BATCH_MAX];
+	// The full width and height of each target (only boxes use these)
+	float w[BATCH_MAX];
+	float h[BATCH_MAX];
+	// The pool slot each target came from
+	int slot[BATCH_MAX];
+	// The number of targets in the block
+	int count;
+} TargetBlock;
+
+/*
+	This function creates an empty block of targets.
+	@return A pointer to the block that was made.
+ */
+TargetBlock* createTargetBlock();
+
+/*
+	This function frees a block of targets.
+	@param block A pointer to the block to destroy.
+ */
+void destroyTargetBlock(TargetBlock* block);
+
+/*
+	This function finds the vector unit the batch tests are running on.
+	@return One of the BATCH_ levels.
+ */
+int batchLevel();
+
+/*
+	This function finds the widest vector unit this CPU has.
+	@return One of the BATCH_ levels.
+ */
+int batchBestLevel();
+
+/*
+	This function picks the vector unit the batch tests run on, so the widths can be compared.
+	It must not be called while a world is being stepped.
+	@param level One of the BATCH_ levels.
+	@return True if the CPU has it, false (leaving things as they were) otherwise.
+ */
+bool setBatchLevel(int level);
+
+/*
+	This function checks which points in a block lie inside a circle.
+	@param radius The radius of the circle.
+	@param sx The x co-ordinate of the circle.
+	@param sy The y co-ordinate of the circle.
+	@param block The points to check.
+	@return A mask with bit k set if point k is in the circle.
+ */
+uint32_t batchPointInCircle(float radius, float sx, float sy, const TargetBlock* block);
+
+/*
+	This function checks which points in a block lie inside a box.
+	@param x The x co-ordinate of the center of the box.
+	@param y The y co-ordinate of the center of the box.
+	@param halfW Half the width of the box.
+	@param halfH Half the height of the box.
+	@param block The points to check.
+	@return A mask with bit k set if point k is in the box.
+ */
+uint32_t batchPointInBox(float x, float y, float halfW, float halfH, const TargetBlock* block);
+
+/*
+	This function checks which boxes in a block overlap a box.
+	@param x The x co-ordinate of the center of the box.
+	@param y The y co-ordinate of the center of the box.
+	@param w The full width of the box.
+	@param h The full height of the box.
+	@param block The boxes to check, centered on their positions.
+	@return A mask with bit k set if box k overlaps the box.
+ */
+uint32_t batchBoxInBox(float x, float y, float w, float h, const TargetBlock* block);
+
+/*
+	This function checks which points in a block lie inside a triangle.
+	@param tri The three corners of the triangle.
+	@param block The points to check.
+	@return A mask with bit k set if point k is in the triangle.
+ */
+uint32_t batchPointInTriangle(const float tri[3][2], const TargetBlock* block);
+
+/*
+	This function finds the first target hit in a mask.
+	@param mask A mask from one of the batch tests, it must not be 0.
+	@return The index of the lowest bit set.
+ */
+inline int batchFirstHit(uint32_t mask)
+{
+#if defined(__GNUC__)
+	return __builtin_ctz(mask);
+#else
+	int k = 0;
+	while (!(mask & 1)){
+		mask >>= 1;
+		k++;
+	}
+	return k;
+#endif
+}
+
+#endif
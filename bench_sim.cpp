@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include "objects.h"
+#include "datastructures.h"
+#include "rng.h"
+#include "world.h"
+#include "profiler.h"
+
+/*
+	@file bench_sim.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This program benchmarks stepping the simulation. It builds a world holding a given number of
+	asteroids, aliens, missles, and explosions, steps it with stepWorld (the same path the game's
+	update loop takes), and reports ns/tick, entities/sec, ns/entity, and allocations/tick as CSV.
+	ns/entity is what a tick costs for each thing in the world, it stays flat as long as the
+	simulation scales linearly.
+	Every few ticks the world is put back the way it was built, so the load does not drain away.
+	Given --sweep it runs each kind of load from 10 up to 100k (or the max given) entities.
+	Usage: bench_sim [--asteroids=N] [--aliens=N] [--missles=N] [--explosions=N] [--ticks=N]
+		[--seed=N] [--sweep[=MAX]] [--csv=FILE]
+ */
+
+// The number of ticks timed for each run if none are asked for
+#define BENCH_DEFAULT_TICKS 256
+// How many ticks run before the world is put back the way it was built
+#define BENCH_EPISODE_TICKS 32
+// The most entities a sweep goes up to if none is asked for
+#define BENCH_SWEEP_MAX 100000
+// The random stream the load is drawn from, kept apart from every stream the world uses
+#define BENCH_STREAM 1
+// How to run this program
+#define BENCH_USAGE "Usage: %s [--asteroids=N] [--aliens=N] [--missles=N] [--explosions=N] [--ticks=N] [--seed=N] [--sweep[=MAX]] [--csv=FILE]\n"
+
+// A struct describing how much of everything a benchmark world holds
+typedef struct {
+	// What to call the load in the CSV
+	const char* name;
+	// How many of each thing to put in the world (there is always at least one asteroid,
+	// otherwise the world starts a new screen every tick)
+	int asteroids;
+	int aliens;
+	int missles;
+	int explosions;
+} BenchScenario;
+
+// The number of heap allocations made so far, counted by the malloc wrappers below
+static unsigned long long allocations = 0;
+
+#ifdef __GLIBC__
+// Count every allocation by wrapping glibc's allocator, new and delete go through these too
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* malloc(size_t size) { allocations++; return __libc_malloc(size); }
+extern "C" void* calloc(size_t count, size_t size) { allocations++; return __libc_calloc(count, size); }
+extern "C" void* realloc(void* ptr, size_t size) { allocations++; return __libc_realloc(ptr, size); }
+// Whether allocations are being counted
+#define BENCH_COUNTS_ALLOCATIONS true
+#else
+#define BENCH_COUNTS_ALLOCATIONS false
+#endif
+
+/*
+	This function picks a random co-ordinate somewhere in the window.
+	@param rng The stream to draw from.
+	@param lower The lower edge of the window.
+	@param upper The upper edge of the window.
+	@return The co-ordinate.
+ */
+static float randomCoord(Rng* rng, float lower, float upper)
+{
+	return lower + ((upper - lower) * (rngNext(rng) >> 8) / (float)(1 << 24));
+}
+
+/*
+	This function fills a fresh world with a scenario's load, spread evenly over the window.
+	@param world A pointer to the world to fill, made with room for everything in the scenario.
+	@param scenario The load to put in it.
+	@param rng The stream to draw positions and directions from.
+ */
+static void populateWorld(World* world, const BenchScenario* scenario, Rng* rng)
+{
+	// Keep the player alive so the game never restarts under us
+	world->p->deathsLeft = INT_MAX / 2;
+
+	// Replace the first screen's asteroids with our own, scattered over the whole window
+	ObjectPool* asteroids = world->asteroids;
+	clearPool(asteroids);
+	addAsteroids(world, (scenario->asteroids > 0) ? scenario->asteroids : 1);
+	for (int i = 0; i < asteroids->highWater; i++){
+		asteroids->motion->posX[i] = randomCoord(rng, BOUND_X_LOWER, BOUND_X_UPPER);
+		asteroids->motion->posY[i] = randomCoord(rng, BOUND_Y_LOWER, BOUND_Y_UPPER);
+	}
+
+	// Add aliens, each with its own stream like the ones the world spawns
+	for (int i = 0; i < scenario->aliens; i++){
+		Rng stream;
+		seedRng(&stream, world->seed, RNG_STREAM_ALIENS + world->aliensSpawned++);
+		Alien* a = initAlienShip(rngInt(rng, 2), world->aliens, &stream);
+		if (a == NULL)
+			break;
+		a->positionVector[X_] = randomCoord(rng, BOUND_X_LOWER, BOUND_X_UPPER);
+		a->positionVector[Y_] = randomCoord(rng, BOUND_Y_LOWER, BOUND_Y_UPPER);
+	}
+
+	// Add missles flying every which way, half the player's and half the aliens'
+	for (int i = 0; i < scenario->missles; i++){
+		ObjectPool* shots = (i & 1) ? world->alienShots : world->playerShots;
+		Missle* m = (Missle*)poolAdd(shots);
+		if (m == NULL)
+			break;
+		float angle = randomCoord(rng, 0.0f, 6.2831853f);
+		m->directionVector[X_] = cosf(angle);
+		m->directionVector[Y_] = sinf(angle);
+		m->vMag = MISSLE_V;
+		int slot = poolIndexOf(m, shots);
+		shots->motion->posX[slot] = randomCoord(rng, BOUND_X_LOWER, BOUND_X_UPPER);
+		shots->motion->posY[slot] = randomCoord(rng, BOUND_Y_LOWER, BOUND_Y_UPPER);
+		shots->motion->velX[slot] = m->vMag * m->directionVector[X_];
+		shots->motion->velY[slot] = m->vMag * m->directionVector[Y_];
+		// Stagger their ages so they do not all expire on the same tick
+		shots->motion->age[slot] = (float)rngInt(rng, MISSLE_AGE_MAX / 2);
+	}
+
+	// Add explosions
+	for (int i = 0; i < scenario->explosions; i++){
+		float x = randomCoord(rng, BOUND_X_LOWER, BOUND_X_UPPER);
+		float y = randomCoord(rng, BOUND_Y_LOWER, BOUND_Y_UPPER);
+		if (makeExplosion(x, y, Z_LEVEL, world->explosions) == NULL)
+			break;
+	}
+}
+
+/*
+	This function counts everything in a world.
+	@param world A pointer to the world.
+	@return The number of asteroids, aliens, missles, and explosions in it.
+ */
+static long long countEntities(const World* world)
+{
+	return (long long)world->asteroids->size + world->aliens->size + world->playerShots->size +
+		world->alienShots->size + world->explosions->size;
+}
+
+/*
+	This function benchmarks one scenario and writes a row of CSV for it.
+	@param out Where to write the row.
+	@param scenario The load to benchmark.
+	@param ticks The number of ticks to time.
+	@param seed The seed for the world and the load.
+	@return True if it ran, false if the world could not be snapshotted.
+ */
+static bool runScenario(FILE* out, const BenchScenario* scenario, int ticks, uint64_t seed)
+{
+	// Size every pool to fit the load, with room to spare for splits and new explosions
+	WorldConfig config;
+	defaultWorldConfig(&config);
+	config.seed = seed;
+	config.maxAsteroids = scenario->asteroids + (scenario->asteroids / 2) + MAX_ASTEROIDS;
+	config.maxAliens = scenario->aliens + MAX_ALIENS;
+	config.maxMissles = scenario->missles + MAX_MISSLES;
+	config.maxExplosions = scenario->explosions + scenario->asteroids + scenario->aliens + MAX_EXPLOSIONS;
+	World* world = createWorld(&config);
+	Rng rng;
+	seedRng(&rng, seed, BENCH_STREAM);
+	populateWorld(world, scenario, &rng);
+
+	// Remember the world as built so every episode starts from the same load
+	size_t capacity = worldSnapshotSize(world);
+	void* snapshot = malloc(capacity);
+	size_t size = snapshotWorld(world, snapshot, capacity);
+	if (size == 0){
+		free(snapshot);
+		destroyWorld(world);
+		return false;
+	}
+
+	// Time the ticks, but not putting the world back between episodes
+	int64_t elapsed = 0;
+	unsigned long long allocated = 0;
+	long long entityTicks = 0;
+	for (int done = 0; done < ticks; done += BENCH_EPISODE_TICKS){
+		restoreWorld(world, snapshot, size);
+		int episode = ((ticks - done) < BENCH_EPISODE_TICKS) ? (ticks - done) : BENCH_EPISODE_TICKS;
+		for (int t = 0; t < episode; t++){
+			entityTicks += countEntities(world);
+			unsigned long long allocationsBefore = allocations;
+			int64_t start = profileNow();
+			stepWorld(world, 0);
+			elapsed += profileNow() - start;
+			allocated += allocations - allocationsBefore;
+		}
+	}
+
+	// Write the row
+	double seconds = elapsed / 1e9;
+	fprintf(out, "%s,%d,%d,%d,%d,%d,%.1f,%.0f,%.1f,", scenario->name, scenario->asteroids, scenario->aliens,
+		scenario->missles, scenario->explosions, ticks, (ticks > 0) ? ((double)elapsed / ticks) : 0.0,
+		(seconds > 0) ? (entityTicks / seconds) : 0.0, (entityTicks > 0) ? ((double)elapsed / entityTicks) : 0.0);
+	if (BENCH_COUNTS_ALLOCATIONS)
+		fprintf(out, "%.2f\n", (ticks > 0) ? ((double)allocated / ticks) : 0.0);
+	else fprintf(out, "\n");
+	fflush(out);
+
+	free(snapshot);
+	destroyWorld(world);
+	return true;
+}
+
+/*
+	This is the main function. It runs one scenario, or sweeps every kind of load, and writes CSV.
+	@param argc The number of arguments given
+	@param argv The argument vector
+	@return EXIT_SUCCESS, or EXIT_FAILURE if the arguments were bad
+*/
+int main(int argc, char** argv)
+{
+	BenchScenario single = { "custom", 1, 0, 0, 0 };
+	int ticks = BENCH_DEFAULT_TICKS;
+	uint64_t seed = 1;
+	int sweepMax = 0;
+	const char* csvPath = NULL;
+
+	// Read the arguments
+	for (int i = 1; i < argc; i++){
+		if (strncmp(argv[i], "--asteroids=", 12) == 0)
+			single.asteroids = atoi(argv[i] + 12);
+		else if (strncmp(argv[i], "--aliens=", 9) == 0)
+			single.aliens = atoi(argv[i] + 9);
+		else if (strncmp(argv[i], "--missles=", 10) == 0)
+			single.missles = atoi(argv[i] + 10);
+		else if (strncmp(argv[i], "--explosions=", 13) == 0)
+			single.explosions = atoi(argv[i] + 13);
+		else if (strncmp(argv[i], "--ticks=", 8) == 0)
+			ticks = atoi(argv[i] + 8);
+		else if (strncmp(argv[i], "--seed=", 7) == 0)
+			seed = strtoull(argv[i] + 7, NULL, 10);
+		else if (strcmp(argv[i], "--sweep") == 0)
+			sweepMax = BENCH_SWEEP_MAX;
+		else if (strncmp(argv[i], "--sweep=", 8) == 0)
+			sweepMax = atoi(argv[i] + 8);
+		else if (strncmp(argv[i], "--csv=", 6) == 0)
+			csvPath = argv[i] + 6;
+		else {
+			fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			fprintf(stderr, BENCH_USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if ((ticks <= 0) || (sweepMax < 0) || (single.asteroids < 0) || (single.aliens < 0) ||
+		(single.missles < 0) || (single.explosions < 0)){
+		fprintf(stderr, BENCH_USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Write to the file if one was given, otherwise to the screen
+	FILE* out = stdout;
+	if (csvPath != NULL){
+		out = fopen(csvPath, "w");
+		if (out == NULL){
+			fprintf(stderr, "Could not open %s\n", csvPath);
+			return EXIT_FAILURE;
+		}
+	}
+	fprintf(out, "scenario,asteroids,aliens,missles,explosions,ticks,ns_per_tick,entities_per_sec,ns_per_entity,allocs_per_tick\n");
+
+	bool ok = true;
+	if (sweepMax == 0)
+		ok = runScenario(out, &single, ticks, seed);
+	else {
+		// Grow each kind of load on its own, then all of them together, by steps of about sqrt(10)
+		for (int kind = 0; (kind < 5) && ok; kind++){
+			for (double n = 10; ((int)n <= sweepMax) && ok; n *= sqrt(10.0)){
+				int count = (int)(n + 0.5);
+				BenchScenario s = { "", 1, 0, 0, 0 };
+				switch (kind){
+				case 0:
+					s.name = "asteroids";
+					s.asteroids = count;
+					break;
+				case 1:
+					s.name = "aliens";
+					s.aliens = count;
+					break;
+				case 2:
+					s.name = "missles";
+					s.missles = count;
+					break;
+				case 3:
+					s.name = "explosions";
+					s.explosions = count;
+					break;
+				default:
+					// A busy screen: a quarter asteroids, half missles, the rest aliens and explosions
+					s.name = "mixed";
+					s.asteroids = (count / 4 > 0) ? (count / 4) : 1;
+					s.missles = count / 2;
+					s.aliens = count / 8;
+					s.explosions = count - s.asteroids - s.missles - s.aliens;
+					break;
+				}
+				ok = runScenario(out, &s, ticks, seed);
+			}
+		}
+	}
+
+	if (out != stdout)
+		fclose(out);
+	if (!ok){
+		fprintf(stderr, "Could not snapshot the benchmark world\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
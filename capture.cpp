@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capture.h"
+#include "trace.h"
+#ifdef _WIN32
+// Windows has popen under another name
+#define popen _popen
+#define pclose _pclose
+#else
+#include <signal.h>
+#endif
+
+/*
+	@file capture.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements frame capture. The ring of frames has one writer (whoever draws) and one
+	reader (the background thread), so handing a frame over is a copy and an atomic store, no lock.
+	Colors are turned into YUV with the usual BT.601 integer formulas, in the range players expect.
+ */
+
+/*
+	This function turns a frame into the three planes of a Y4M frame, top row first. Each chroma
+	sample is the average of a 2x2 block of pixels (the last row or column repeats if the size is odd).
+	@param capture A pointer to the capture.
+	@param frame The frame, RGBA bottom row first.
+	@param out Where to put the Y plane, then the U plane, then the V plane.
+ */
+static void convertYUV(const FrameCapture* capture, const unsigned char* frame, unsigned char* out)
+{
+	int width = capture->width;
+	int height = capture->height;
+	int chromaWidth = (width + 1) / 2;
+	int chromaHeight = (height + 1) / 2;
+	unsigned char* yPlane = out;
+	unsigned char* uPlane = yPlane + ((size_t)width * height);
+	unsigned char* vPlane = uPlane + ((size_t)chromaWidth * chromaHeight);
+
+	// Brightness, one per pixel
+	for (int row = 0; row < height; row++){
+		const unsigned char* src = frame + ((size_t)(height - 1 - row) * width * 4);
+		unsigned char* dst = yPlane + ((size_t)row * width);
+		for (int x = 0; x < width; x++, src += 4)
+			dst[x] = (unsigned char)((((66 * src[0]) + (129 * src[1]) + (25 * src[2]) + 128) >> 8) + 16);
+	}
+
+	// Color, one per 2x2 block
+	for (int row = 0; row < chromaHeight; row++){
+		int top = height - 1 - (row * 2);
+		int bottom = (top > 0) ? (top - 1) : top;
+		const unsigned char* rows[2] = { frame + ((size_t)top * width * 4), frame + ((size_t)bottom * width * 4) };
+		for (int cx = 0; cx < chromaWidth; cx++){
+			int left = cx * 2;
+			int right = ((left + 1) < width) ? (left + 1) : left;
+			int r = 0;
+			int g = 0;
+			int b = 0;
+			for (int k = 0; k < 2; k++){
+				r += rows[k][(left * 4) + 0] + rows[k][(right * 4) + 0];
+				g += rows[k][(left * 4) + 1] + rows[k][(right * 4) + 1];
+				b += rows[k][(left * 4) + 2] + rows[k][(right * 4) + 2];
+			}
+			r = (r + 2) >> 2;
+			g = (g + 2) >> 2;
+			b = (b + 2) >> 2;
+			uPlane[((size_t)row * chromaWidth) + cx] = (unsigned char)((((-38 * r) - (74 * g) + (112 * b) + 128) >> 8) + 128);
+			vPlane[((size_t)row * chromaWidth) + cx] = (unsigned char)((((112 * r) - (94 * g) - (18 * b) + 128) >> 8) + 128);
+		}
+	}
+}
+
+/*
+	This function turns a frame into the pixels of a PPM image, top row first.
+	@param capture A pointer to the capture.
+	@param frame The frame, RGBA bottom row first.
+	@param out Where to put the RGB pixels.
+ */
+static void convertRGB(const FrameCapture* capture, const unsigned char* frame, unsigned char* out)
+{
+	for (int row = 0; row < capture->height; row++){
+		const unsigned char* src = frame + ((size_t)(capture->height - 1 - row) * capture->width * 4);
+		unsigned char* dst = out + ((size_t)row * capture->width * 3);
+		for (int x = 0; x < capture->width; x++)
+			memcpy(dst + (x * 3), src + (x * 4), 3);
+	}
+}
+
+/*
+	This function converts one frame and writes it out.
+	@param capture A pointer to the capture.
+	@param frame The frame, RGBA bottom row first.
+	@return True if the whole frame was written.
+ */
+static bool writeFrame(FrameCapture* capture, const unsigned char* frame)
+{
+	size_t pixels = (size_t)capture->width * capture->height;
+	size_t size;
+	if (capture->ppm){
+		convertRGB(capture, frame, capture->converted);
+		size = pixels * 3;
+		if (fprintf(capture->file, "P6\n%d %d\n255\n", capture->width, capture->height) < 0)
+			return false;
+	}
+	else {
+		convertYUV(capture, frame, capture->converted);
+		size = pixels + (2 * (size_t)((capture->width + 1) / 2) * ((capture->height + 1) / 2));
+		if (fputs("FRAME\n", capture->file) < 0)
+			return false;
+	}
+	return fwrite(capture->converted, 1, size, capture->file) == size;
+}
+
+/*
+	This function writes out every frame waiting in the ring, freeing each slot as it goes.
+	@param capture A pointer to the capture.
+ */
+static void writeFrames(FrameCapture* capture)
+{
+	uint64_t tail = capture->tail.load(std::memory_order_relaxed);
+	uint64_t head = capture->head.load(std::memory_order_acquire);
+	for (; tail != head; tail++){
+		const unsigned char* frame = capture->frames[tail & (CAPTURE_QUEUE_FRAMES - 1)];
+		// Once a write fails (the disk filled, or whatever was reading the pipe left) stop trying
+		if (!capture->failed.load(std::memory_order_relaxed) && writeFrame(capture, frame))
+			capture->written.fetch_add(1, std::memory_order_relaxed);
+		else {
+			capture->failed.store(true, std::memory_order_relaxed);
+			capture->dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+		capture->tail.store(tail + 1, std::memory_order_release);
+	}
+}
+
+/*
+	This function is run by the background thread, it writes out frames as they come in until told to stop.
+	@param capture A pointer to the capture the thread writes.
+ */
+static void writerMain(FrameCapture* capture)
+{
+	if (traceEnabled())
+		traceNameThread("capture writer");
+	std::unique_lock<std::mutex> guard(capture->lock);
+	for (;;){
+		// Anything handed over before we were told to quit still gets written
+		bool quitting = capture->quit;
+		guard.unlock();
+		writeFrames(capture);
+		guard.lock();
+		if (quitting)
+			return;
+		// Sleep until a frame is handed over (a missed wake up only costs one poll)
+		if (!capture->quit)
+			capture->wake.wait_for(guard, std::chrono::milliseconds(CAPTURE_POLL_MS));
+	}
+}
+
+/*
+	This function opens a capture and starts the thread that writes it.
+	@param path Where to write the frames: a file (or named pipe), or | followed by a command to pipe them to.
+	@param width The width of every frame in pixels.
+	@param height The height of every frame in pixels.
+	@param fps How many frames a second the video plays at.
+	@return A pointer to the capture, or NULL if the file could not be opened.
+*/
+FrameCapture* startCapture(const char* path, int width, int height, int fps)
+{
+	if ((width < 1) || (height < 1))
+		return NULL;
+	FILE* file;
+	bool pipe = false;
+	if (path[0] == '|'){
+		file = popen(path + 1, "w");
+		pipe = true;
+	}
+	else file = fopen(path, "wb");
+	if (file == NULL)
+		return NULL;
+#ifndef _WIN32
+	// If whatever is reading the pipe quits, let the writes fail instead of killing the game
+	if (pipe)
+		signal(SIGPIPE, SIG_IGN);
+#endif
+
+	// The atomics and the thread need real constructors
+	FrameCapture* capture = new FrameCapture();
+	capture->file = file;
+	capture->pipe = pipe;
+	size_t length = strlen(path);
+	capture->ppm = (length >= 4) && (strcmp(path + length - 4, ".ppm") == 0);
+	capture->width = width;
+	capture->height = height;
+	size_t pixels = (size_t)width * height;
+	for (int i = 0; i < CAPTURE_QUEUE_FRAMES; i++)
+		capture->frames[i] = (unsigned char*)malloc(pixels * 4);
+	// Big enough for either format
+	capture->converted = (unsigned char*)malloc(pixels * 3);
+	capture->head.store(0);
+	capture->tail.store(0);
+	capture->quit = false;
+	capture->written.store(0);
+	capture->dropped.store(0);
+	capture->failed.store(false);
+
+	// A Y4M stream starts with one header for the whole video (square pixels, chroma centered)
+	if (!capture->ppm)
+		fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, (fps > 0) ? fps : 1);
+	capture->writer = std::thread(writerMain, capture);
+	return capture;
+}
+
+/*
+	This function hands a frame to the capture. It never waits, if there is no room the frame is dropped.
+	@param capture A pointer to the capture.
+	@param pixels The frame, RGBA bottom row first (the way glReadPixels gives it). It is not read
+		if the frame is dropped.
+	@param width The width of the frame in pixels, frames of any other size than the capture's are dropped.
+	@param height The height of the frame in pixels.
+	@param stride How many pixels apart the rows of the frame are.
+	@return True if the frame was queued to be written.
+*/
+bool captureFrame(FrameCapture* capture, const void* pixels, int width, int height, int stride)
+{
+	// Drop it if it does not fit the video, if the writer has given up, or if the ring is full
+	uint64_t head = capture->head.load(std::memory_order_relaxed);
+	if ((width != capture->width) || (height != capture->height) || capture->failed.load(std::memory_order_relaxed) ||
+		((head - capture->tail.load(std::memory_order_acquire)) >= CAPTURE_QUEUE_FRAMES)){
+		capture->dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Copy it into the next free slot, then let the writer have it
+	unsigned char* frame = capture->frames[head & (CAPTURE_QUEUE_FRAMES - 1)];
+	size_t rowSize = (size_t)width * 4;
+	for (int y = 0; y < height; y++)
+		memcpy(frame + (y * rowSize), (const unsigned char*)pixels + ((size_t)y * stride * 4), rowSize);
+	capture->head.store(head + 1, std::memory_order_release);
+	capture->wake.notify_one();
+	return true;
+}
+
+/*
+	This function waits until there is room in the ring for another frame, or the writer has given up.
+	Only something that would rather be slow than drop frames (like the headless runner) should call it.
+	@param capture A pointer to the capture.
+*/
+void waitForCapture(FrameCapture* capture)
+{
+	while (((capture->head.load(std::memory_order_relaxed) - capture->tail.load(std::memory_order_acquire)) >= CAPTURE_QUEUE_FRAMES) &&
+		!capture->failed.load(std::memory_order_relaxed))
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+/*
+	This function writes out every frame still waiting, stops the writer, closes the file, and frees the capture.
+	@param capture A pointer to the capture.
+	@param written Where to put how many frames were written, or NULL.
+	@return The number of frames that were dropped.
+*/
+uint64_t stopCapture(FrameCapture* capture, uint64_t* written)
+{
+	if (capture == NULL)
+		return 0;
+	// Let the writer finish what is waiting, then leave
+	{
+		std::lock_guard<std::mutex> guard(capture->lock);
+		capture->quit = true;
+	}
+	capture->wake.notify_one();
+	capture->writer.join();
+
+	if (capture->pipe)
+		pclose(capture->file);
+	else fclose(capture->file);
+
+	uint64_t dropped = capture->dropped.load();
+	if (written != NULL)
+		*written = capture->written.load();
+	for (int i = 0; i < CAPTURE_QUEUE_FRAMES; i++)
+		free(capture->frames[i]);
+	free(capture->converted);
+	delete capture;
+	return dropped;
+}
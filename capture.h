@@ -0,0 +1,92 @@
+#ifndef __CAPTURE__
+#define __CAPTURE__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/*
+	@file capture.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines frame capture, which records what the game draws to a video. Handing
+	over a frame only copies it into a fixed ring of frames, a background thread converts each one
+	and writes it out, so drawing never waits on the disk. If the ring is full the frame is dropped.
+	Frames are written as raw Y4M (YUV 4:2:0, which ffmpeg and most players read straight off a pipe),
+	or as a stream of PPM images if the file name ends in .ppm. Nothing in here knows about OpenGL.
+*/
+
+// The number of frames that can be waiting to be written (must be a power of 2)
+#define CAPTURE_QUEUE_FRAMES 8
+// How often (in ms) the background thread looks for frames if it is not woken
+#define CAPTURE_POLL_MS 5
+
+// A struct holding a capture being recorded
+typedef struct {
+	// Where the frames go, whether it is a pipe to a program, and whether it gets PPM instead of Y4M
+	FILE* file;
+	bool pipe;
+	bool ppm;
+	// The size of every frame in pixels
+	int width;
+	int height;
+	// The frames, RGBA bottom row first, drawing fills them at head and the writer empties them at tail
+	unsigned char* frames[CAPTURE_QUEUE_FRAMES];
+	std::atomic<uint64_t> head;
+	std::atomic<uint64_t> tail;
+	// Room for one converted frame, only the writer touches it
+	unsigned char* converted;
+	// The thread writing the frames
+	std::thread writer;
+	// Guards quit, the writer waits on wake
+	std::mutex lock;
+	std::condition_variable wake;
+	bool quit;
+	// How many frames were written, and how many were dropped (the ring was full, the size was
+	// wrong, or the file stopped taking them)
+	std::atomic<uint64_t> written;
+	std::atomic<uint64_t> dropped;
+	// Set by the writer if a write fails, everything after it is dropped
+	std::atomic<bool> failed;
+} FrameCapture;
+
+/*
+	This function opens a capture and starts the thread that writes it.
+	@param path Where to write the frames: a file (or named pipe), or | followed by a command to pipe them to.
+	@param width The width of every frame in pixels.
+	@param height The height of every frame in pixels.
+	@param fps How many frames a second the video plays at.
+	@return A pointer to the capture, or NULL if the file could not be opened.
+ */
+FrameCapture* startCapture(const char* path, int width, int height, int fps);
+
+/*
+	This function hands a frame to the capture. It never waits, if there is no room the frame is dropped.
+	@param capture A pointer to the capture.
+	@param pixels The frame, RGBA bottom row first (the way glReadPixels gives it). It is not read
+		if the frame is dropped.
+	@param width The width of the frame in pixels, frames of any other size than the capture's are dropped.
+	@param height The height of the frame in pixels.
+	@param stride How many pixels apart the rows of the frame are.
+	@return True if the frame was queued to be written.
+ */
+bool captureFrame(FrameCapture* capture, const void* pixels, int width, int height, int stride);
+
+/*
+	This function waits until there is room in the ring for another frame, or the writer has given up.
+	Only something that would rather be slow than drop frames (like the headless runner) should call it.
+	@param capture A pointer to the capture.
+ */
+void waitForCapture(FrameCapture* capture);
+
+/*
+	This function writes out every frame still waiting, stops the writer, closes the file, and frees the capture.
+	@param capture A pointer to the capture.
+	@param written Where to put how many frames were written, or NULL.
+	@return The number of frames that were dropped.
+ */
+uint64_t stopCapture(FrameCapture* capture, uint64_t* written);
+
+#endif
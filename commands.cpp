@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "commands.h"
+
+/*
+	@file commands.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements draw commands. Every object in a scene becomes one mesh command with its
+	model matrix built the way the old glTranslatef, glRotatef, and glScalef calls built it, the
+	missles and explosions become one point command each, and then everything is sorted by key.
+ */
+
+//Because there is no pi in zmath :(
+#define PI 3.14159265f
+
+// The turns applied before an object's own spin, the way the old drawing code tipped each mesh over
+// Asteroids are not turned
+static const float noTurn[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+// Aliens are tipped 90 degrees about x so they lie flat
+static const float alienTurn[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f } };
+// The player is tipped 90 degrees about x and then 90 degrees about y so it points right
+static const float playerTurn[3][3] = { { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f } };
+
+/*
+	This function builds a model matrix the same way glTranslatef, a fixed turn, glRotatef, and glScalef would.
+	@param model Where to put the rows of the matrix.
+	@param pos Where to move to.
+	@param turn The fixed turn applied before the spin.
+	@param angle The angle to rotate by in degrees.
+	@param axis The axis to rotate about (it does not need to be unit length, a zero axis does not rotate).
+	@param scale How much to scale along each axis.
+ */
+static void buildModel(float (&model)[3][4], const float pos[3], const float (&turn)[3][3], float angle, const float axis[3], const float scale[3])
+{
+	// Start with no rotation
+	float r[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+	float length = sqrt((axis[X_] * axis[X_]) + (axis[Y_] * axis[Y_]) + (axis[Z_] * axis[Z_]));
+	if (length > 1.0e-4f){
+		float ax = axis[X_] / length;
+		float ay = axis[Y_] / length;
+		float az = axis[Z_] / length;
+		float radians = angle * (PI / 180.0f);
+		float c = cos(radians);
+		float s = sin(radians);
+		float t = 1.0f - c;
+		r[0][0] = (ax * ax * t) + c;
+		r[0][1] = (ax * ay * t) - (az * s);
+		r[0][2] = (ax * az * t) + (ay * s);
+		r[1][0] = (ay * ax * t) + (az * s);
+		r[1][1] = (ay * ay * t) + c;
+		r[1][2] = (ay * az * t) - (ax * s);
+		r[2][0] = (az * ax * t) - (ay * s);
+		r[2][1] = (az * ay * t) + (ax * s);
+		r[2][2] = (az * az * t) + c;
+	}
+	// Turn, then scale each column, then move
+	for (int row = 0; row < 3; row++){
+		for (int col = 0; col < 3; col++)
+			model[row][col] = ((turn[row][0] * r[0][col]) + (turn[row][1] * r[1][col]) + (turn[row][2] * r[2][col])) * scale[col];
+		model[row][3] = pos[row];
+	}
+}
+
+/*
+	This function makes a sort key.
+	@param pass The pass the command is drawn in.
+	@param mesh The mesh set the command draws with.
+	@param variant The mesh in the set the command draws with.
+	@param order The order the command was added in.
+	@return The key.
+ */
+static uint64_t makeKey(int pass, int mesh, int variant, int order)
+{
+	return ((uint64_t)pass << KEY_PASS_SHIFT) | ((uint64_t)mesh << KEY_MESH_SHIFT) |
+		((uint64_t)(variant & 0xFFFF) << KEY_VARIANT_SHIFT) | (uint64_t)(unsigned int)order;
+}
+
+/*
+	This function adds a mesh command for a scene object.
+	@param buffer A pointer to the command buffer.
+	@param object The object to draw.
+	@param mesh The mesh set to draw it with.
+	@param variant The mesh in the set to draw it with.
+	@param turn The fixed turn applied before the object's spin.
+ */
+static void addMesh(CommandBuffer* buffer, const SceneObject* object, int mesh, int variant, const float (&turn)[3][3])
+{
+	DrawCommand* command = &buffer->commands[buffer->count];
+	command->key = makeKey(PASS_MESHES, mesh, variant, buffer->count);
+	command->kind = COMMAND_MESH;
+	command->mesh = mesh;
+	command->variant = variant;
+	buildModel(command->model, object->pos, turn, object->spin, object->axis, object->scale);
+	memcpy(command->mat, object->mat, sizeof(command->mat));
+	buffer->count++;
+}
+
+/*
+	This function adds a point command, if there are any points to draw.
+	@param buffer A pointer to the command buffer.
+	@param first The first point to draw.
+	@param count How many points to draw.
+	@param size How big to draw them.
+ */
+static void addPoints(CommandBuffer* buffer, int first, int count, float size)
+{
+	if (count == 0)
+		return;
+	DrawCommand* command = &buffer->commands[buffer->count];
+	command->key = makeKey(PASS_POINTS, 0, 0, buffer->count);
+	command->kind = COMMAND_POINTS;
+	command->first = first;
+	command->count = count;
+	command->size = size;
+	buffer->count++;
+}
+
+/*
+	This function compares two commands by key, for qsort.
+	@param a The first command.
+	@param b The second command.
+	@return Less than, equal to, or more than 0 if the first is before, the same as, or after the second.
+ */
+static int compareCommands(const void* a, const void* b)
+{
+	uint64_t keyA = ((const DrawCommand*)a)->key;
+	uint64_t keyB = ((const DrawCommand*)b)->key;
+	return (keyA < keyB) ? -1 : ((keyA > keyB) ? 1 : 0);
+}
+
+/*
+	This function creates a command buffer with room for everything the world's pools can hold.
+	@param world The world whose scenes will be drawn.
+	@return A pointer to the command buffer.
+*/
+CommandBuffer* createCommandBuffer(const World* world)
+{
+	CommandBuffer* buffer = (CommandBuffer*)calloc(1, sizeof(CommandBuffer));
+	// Every asteroid and alien, the player, and the two runs of points
+	buffer->capacity = world->asteroids->capacity + world->aliens->capacity + 3;
+	buffer->commands = (DrawCommand*)malloc(buffer->capacity * sizeof(DrawCommand));
+	return buffer;
+}
+
+/*
+	This function frees a command buffer.
+	@param buffer A pointer to the command buffer to destroy.
+*/
+void destroyCommandBuffer(CommandBuffer* buffer)
+{
+	if (buffer == NULL)
+		return;
+	free(buffer->commands);
+	free(buffer);
+}
+
+/*
+	This function fills a command buffer with everything in a scene and sorts it by state.
+	The buffer points at the scene's points, so the scene must outlive the commands.
+	@param buffer A pointer to the command buffer.
+	@param scene The scene to draw.
+*/
+void buildCommands(CommandBuffer* buffer, const Scene* scene)
+{
+	buffer->count = 0;
+
+	// The aliens, the asteroids, and the player, in the order the old drawing code went in
+	for (int i = 0; i < scene->numAliens; i++){
+		const SceneObject* a = &scene->aliens[i];
+		addMesh(buffer, a, (a->mesh == ALIEN_CLASS_LARGE) ? MESH_ALIEN_LARGE : MESH_ALIEN_SMALL, 0, alienTurn);
+	}
+	for (int i = 0; i < scene->numAsteroids; i++)
+		addMesh(buffer, &scene->asteroids[i], MESH_ASTEROID, scene->asteroids[i].mesh, noTurn);
+	addMesh(buffer, &scene->player, MESH_PLAYER, 0, playerTurn);
+
+	// Every missle, then every bit of every explosion
+	buffer->points = scene->points;
+	buffer->numPoints = scene->numPoints;
+	addPoints(buffer, 0, scene->numShots, MISSLE_SIZE);
+	addPoints(buffer, scene->numShots, scene->numPoints - scene->numShots, EXPLOSION_PT_SIZE);
+
+	// Group everything that needs the same state
+	qsort(buffer->commands, buffer->count, sizeof(DrawCommand), compareCommands);
+}
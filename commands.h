@@ -0,0 +1,83 @@
+#ifndef __COMMANDS__
+#define __COMMANDS__
+
+#include <stdint.h>
+#include "scene.h"
+#include "meshes.h"
+
+/*
+	@file commands.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines draw commands, a plain description of one frame: which mesh to draw
+	with what transform and material, and which runs of points to draw at what size. A scene is
+	turned into a buffer of commands and the buffer is sorted by the state each command needs, so
+	whatever draws it (the GL renderer, or anything else) changes state as little as it can.
+	Nothing in here knows about GLUT or OpenGL.
+*/
+
+// The kinds of commands
+#define COMMAND_MESH 0
+#define COMMAND_POINTS 1
+
+// The passes a frame is drawn in, lit meshes first and then unlit points
+#define PASS_MESHES 0
+#define PASS_POINTS 1
+
+// Where each part of a sort key starts, the pass is most important and the order added least
+// (the low bits keep commands that need the same state in the order they were added)
+#define KEY_PASS_SHIFT 56
+#define KEY_MESH_SHIFT 48
+#define KEY_VARIANT_SHIFT 32
+
+// A struct holding one draw command
+typedef struct {
+	// What the commands are sorted by (pass, mesh set, mesh, then the order they were added)
+	uint64_t key;
+	// The kind of command, a COMMAND_ value
+	int kind;
+	// The set the mesh is in (a MESH_ value), and which mesh in the set (mesh commands only)
+	int mesh;
+	int variant;
+	// The rows of the model matrix, rotation and scale with the translation in the last column (mesh commands only)
+	float model[3][4];
+	// The material to draw with (mesh commands only)
+	float mat[4];
+	// The first of the frame's points to draw, how many, and how big (point commands only)
+	int first;
+	int count;
+	float size;
+} DrawCommand;
+
+// A struct holding every command for one frame
+typedef struct {
+	// The commands, sorted by key once built
+	DrawCommand* commands;
+	int count;
+	int capacity;
+	// The points the point commands draw from (the scene's)
+	const PointVertex* points;
+	int numPoints;
+} CommandBuffer;
+
+/*
+	This function creates a command buffer with room for everything the world's pools can hold.
+	@param world The world whose scenes will be drawn.
+	@return A pointer to the command buffer.
+ */
+CommandBuffer* createCommandBuffer(const World* world);
+
+/*
+	This function frees a command buffer.
+	@param buffer A pointer to the command buffer to destroy.
+ */
+void destroyCommandBuffer(CommandBuffer* buffer);
+
+/*
+	This function fills a command buffer with everything in a scene and sorts it by state.
+	The buffer points at the scene's points, so the scene must outlive the commands.
+	@param buffer A pointer to the command buffer.
+	@param scene The scene to draw.
+ */
+void buildCommands(CommandBuffer* buffer, const Scene* scene);
+
+#endif
@@ -1,131 +1,277 @@
-#include "objects.h"
+#include <stdlib.h>
+#include <string.h>
 #include "datastructures.h"
 
 /*
 	@file datastructures.cpp
 	@author Derek Batts - dsbatts@ncsu.edu
-	This file contains functions that implement a simple dynamic list object.
+	This file contains functions that implement a fixed capacity object pool.
+	Slots are reused through a free stack so adding and removing never touches the heap,
+	and every slot carries a generation so stale handles can be detected.
  */
 
 /*
-	This function creates a list.
-	@return A pointer to the list that was made.
+	This function creates a pool. All memory the pool will ever use is allocated here.
+	@param elemSize The size of the objects the pool holds.
+	@param capacity The max number of objects the pool can hold at once.
+	@param withMotion True if the pool should keep a motion store alongside its slots.
+	@return A pointer to the pool that was made.
 */
-ObjectList* createList()
+ObjectPool* createPool(int elemSize, int capacity, bool withMotion)
 {
-	// Allocate a new list
-	ObjectList* newList = (ObjectList*)malloc(sizeof(ObjectList));
-	// Initialize it and return it
-	newList->head = NULL;
-	newList->tail = NULL;
-	newList->size = 0;
-	return newList;
+	// Allocate a new pool
+	ObjectPool* newPool = (ObjectPool*)malloc(sizeof(ObjectPool));
+	// Allocate the slots and the bookkeeping for each slot
+	newPool->slots = (char*)calloc(capacity, elemSize);
+	newPool->generations = (unsigned int*)calloc(capacity, sizeof(unsigned int));
+	newPool->live = (bool*)calloc(capacity, sizeof(bool));
+	newPool->freeSlots = (int*)malloc(capacity * sizeof(int));
+	// Make the motion columns if this kind of object moves every tick
+	newPool->motion = withMotion ? createMotionStore(capacity) : NULL;
+	// Initialize the rest and return it
+	newPool->elemSize = elemSize;
+	newPool->capacity = capacity;
+	newPool->size = 0;
+	newPool->highWater = 0;
+	newPool->numFree = 0;
+	return newPool;
 }
 
 /*
-	This function adds a pointer of any type to the given list.
-	@param value The pointer to the thing you want to add to the list.
-	@param list A pointer to the list you want to add stuff to.
+	This function frees a pool and everything in it.
+	@param pool A pointer to the pool to destroy.
 */
-void addToList(void* value, ObjectList* list)
+void destroyPool(ObjectPool* pool)
 {
-	// Allocate a new node and initialize it
-	ObjectNode* newNode = (ObjectNode*)malloc(sizeof(ObjectNode));
-	newNode->next = NULL;
-	newNode->value = value;
-
-	// Check if the list is empty
-	if (list->size == 0)
-		list->head = newNode;
-	// Check if it only has one thing in it
-	else if (list->size == 1){
-		list->tail = newNode;
-		list->head->next = list->tail;
-	}
-	// Otherwise, add it to the end of the list
-	else {
-		list->tail->next = newNode;
-		list->tail = list->tail->next;
-	}
-	// Increment the size of the list
-	list->size++;
+	free(pool->slots);
+	free(pool->generations);
+	free(pool->live);
+	free(pool->freeSlots);
+	if (pool->motion != NULL)
+		destroyMotionStore(pool->motion);
+	free(pool);
 }
 
 /*
-	This function looks for a given pointer in a list and removes it if present.
-	This function will free the node storing the value, BUT WILL NOT FREE THE VALUE.
-	WARNING: This looks for values by comparing thier memory addresses not thier actual values.
-	@param value A pointer to the item you want to remove.
-	@param list A pointer to the list you want to remove it from.
-	@return True if the item was found and removed, false otherwise.
+	This function grabs a free slot from the pool and marks it live.
+	The slot (and its motion, if any) is zeroed before it is returned.
+	@param pool A pointer to the pool to take a slot from.
+	@return A pointer to the new object, or NULL if the pool is full.
 */
-bool removeFromList(void* value, ObjectList* list)
+void* poolAdd(ObjectPool* pool)
 {
-	// Make sure the list is not empty
-	if (list->size <= 0)
+	int index;
+	// Reuse a freed slot if there is one
+	if (pool->numFree > 0)
+		index = pool->freeSlots[--pool->numFree];
+	// Otherwise take the next untouched slot
+	else if (pool->highWater < pool->capacity)
+		index = pool->highWater++;
+	// We are full
+	else return NULL;
+
+	// Mark the slot live and hand back clean memory
+	pool->live[index] = true;
+	pool->size++;
+	char* value = pool->slots + ((size_t)index * pool->elemSize);
+	memset(value, 0, pool->elemSize);
+	if (pool->motion != NULL)
+		clearMotionSlot(pool->motion, index);
+	return value;
+}
+
+/*
+	This function frees the slot holding the given object. It runs in constant time.
+	The object must have come from this pool.
+	@param value A pointer to the object you want to remove.
+	@param pool A pointer to the pool you want to remove it from.
+	@return True if the object was live and got removed, false otherwise.
+*/
+bool poolRemove(void* value, ObjectPool* pool)
+{
+	// Work out which slot the object lives in
+	int index = poolIndexOf(value, pool);
+	if ((index < 0) || (index >= pool->highWater) || !pool->live[index])
 		return false;
-	// Check if what we are looking for is at the head
-	if (list->head->value == value){
-		// Remember the node
-		ObjectNode* temp = list->head;
-		// Move the head to the next node
-		list->head = list->head->next;
-		// Free the old head
-		free(temp);
-		// Decrement the size
-		list->size--;
-		// Check if the list is empty
-		if (list->size == 0){
-			list->head == NULL;
-			list->tail = NULL;
-		}
-		return true;
-	}
 
-	// Remember the previous node (the head at first)
-	ObjectNode* prev = list->head;
-
-	// Loop through the nodes looking for the value
-	for (ObjectNode* n = prev->next; n != NULL; n = n->next){
-		// Check for the value
-		if (n->value == value){
-			// Point the previous node's next field to the node infront of this one
-			prev->next = n->next;
-			// Free this node
-			free(n);
-			// Check if we were the tail, and update if so
-			if (prev->next == NULL)
-				list->tail = prev;
-			// Decrement the size and finish
-			list->size--;
-			return true;
+	// Kill the slot, invalidate old handles and put it on the free stack
+	pool->live[index] = false;
+	pool->generations[index]++;
+	pool->freeSlots[pool->numFree++] = index;
+	pool->size--;
+	// Park the slot so the motion kernels leave it alone
+	if (pool->motion != NULL)
+		clearMotionSlot(pool->motion, index);
+	return true;
+}
+
+/*
+	This function gets the object in a given slot.
+	@param pool A pointer to the pool to look in.
+	@param index The slot to look at.
+	@return A pointer to the object, or NULL if the slot is not live.
+*/
+void* poolSlot(ObjectPool* pool, int index)
+{
+	if (!pool->live[index])
+		return NULL;
+	return pool->slots + ((size_t)index * pool->elemSize);
+}
+
+/*
+	This function finds the slot a given object lives in.
+	@param value A pointer to an object in the pool.
+	@param pool A pointer to the pool the object is in.
+	@return The slot index of the object.
+*/
+int poolIndexOf(void* value, ObjectPool* pool)
+{
+	return (int)(((char*)value - pool->slots) / pool->elemSize);
+}
+
+/*
+	This function makes a handle for a given object that can be checked later,
+	even after the object has been removed and its slot reused.
+	@param value A pointer to a live object in the pool.
+	@param pool A pointer to the pool the object is in.
+	@return A handle to the object.
+*/
+ObjectHandle poolHandle(void* value, ObjectPool* pool)
+{
+	ObjectHandle handle;
+	handle.index = poolIndexOf(value, pool);
+	handle.generation = pool->generations[handle.index];
+	return handle;
+}
+
+/*
+	This function looks up the object a handle refers to.
+	@param handle The handle to look up.
+	@param pool A pointer to the pool the handle was made from.
+	@return A pointer to the object, or NULL if it has since been removed.
+*/
+void* poolLookup(ObjectHandle handle, ObjectPool* pool)
+{
+	// Make sure the handle is in range
+	if ((handle.index < 0) || (handle.index >= pool->highWater))
+		return NULL;
+	// The slot has been freed since the handle was made
+	if (pool->generations[handle.index] != handle.generation)
+		return NULL;
+	return poolSlot(pool, handle.index);
+}
+
+/*
+	This function removes everything from a pool. No memory is freed.
+	@param pool A pointer to the pool to clear
+*/
+void clearPool(ObjectPool* pool)
+{
+	// Invalidate every slot that was live
+	for (int i = 0; i < pool->highWater; i++){
+		if (pool->live[i]){
+			pool->live[i] = false;
+			pool->generations[i]++;
 		}
-		// Move prev with n
-		prev = n;
+		if (pool->motion != NULL)
+			clearMotionSlot(pool->motion, i);
 	}
-	return false;
+	// Reset the pool fields, every slot is untouched again
+	pool->size = 0;
+	pool->highWater = 0;
+	pool->numFree = 0;
 }
 
 /*
-	This function clears a list and frees all the nodes AND VALUES
-	ASSOCIATED WITH THEM.
-	@param list A pointer to the list to clear
+	This function works out how many bytes savePool will write for a pool as it is now.
+	@param pool A pointer to the pool.
+	@return The number of bytes.
 */
-void clearList(ObjectList* list)
+size_t poolSnapshotSize(const ObjectPool* pool)
 {
-	// Check for and empty list
-	if (list->size <= 0) return;
-	// Loop through all the nodes in the list
-	for (ObjectNode* node = list->head; node != NULL;){
-		// Free the value at a given node
-		free(node->value);
-		// Move the node and free the one we were loking at
-		ObjectNode* temp = node;
-		node = node->next;
-		free(temp);
+	// The counts, every generation, then the slots, live flags, free stack, and motion in use
+	size_t size = (3 * sizeof(int)) + (pool->capacity * sizeof(unsigned int));
+	size += (size_t)pool->highWater * (pool->elemSize + sizeof(bool));
+	size += (size_t)pool->numFree * sizeof(int);
+	if (pool->motion != NULL)
+		size += motionSnapshotSize(pool->highWater);
+	return size;
+}
+
+/*
+	This function works out the most bytes savePool could ever write for a pool.
+	@param pool A pointer to the pool.
+	@return The number of bytes.
+*/
+size_t poolMaxSnapshotSize(const ObjectPool* pool)
+{
+	// The free stack and the high water mark can never both be at capacity, but this is close enough
+	size_t size = (3 * sizeof(int)) + (pool->capacity * sizeof(unsigned int));
+	size += (size_t)pool->capacity * (pool->elemSize + sizeof(bool) + sizeof(int));
+	if (pool->motion != NULL)
+		size += motionSnapshotSize(pool->capacity);
+	return size;
+}
+
+/*
+	This function copies everything in a pool into a flat buffer.
+	Only slots below the high water mark are copied.
+	@param pool A pointer to the pool to save.
+	@param out Where to write, there must be poolSnapshotSize(pool) bytes of room.
+	@return A pointer just past what was written.
+*/
+char* savePool(const ObjectPool* pool, char* out)
+{
+	int counts[3] = { pool->size, pool->highWater, pool->numFree };
+	memcpy(out, counts, sizeof(counts));
+	out += sizeof(counts);
+	// Every generation is kept so handles behave the same after a restore
+	memcpy(out, pool->generations, pool->capacity * sizeof(unsigned int));
+	out += pool->capacity * sizeof(unsigned int);
+	// Slots past the high water mark have never been touched, so they are skipped
+	memcpy(out, pool->slots, (size_t)pool->highWater * pool->elemSize);
+	out += (size_t)pool->highWater * pool->elemSize;
+	memcpy(out, pool->live, pool->highWater * sizeof(bool));
+	out += pool->highWater * sizeof(bool);
+	memcpy(out, pool->freeSlots, pool->numFree * sizeof(int));
+	out += pool->numFree * sizeof(int);
+	if (pool->motion != NULL)
+		out = saveMotion(pool->motion, pool->highWater, out);
+	return out;
+}
+
+/*
+	This function puts a pool back the way it was when savePool was called.
+	The pool must have the same element size, capacity, and motion store as the one saved.
+	@param pool A pointer to the pool to load into.
+	@param in Where to read from.
+	@return A pointer just past what was read.
+*/
+const char* loadPool(ObjectPool* pool, const char* in)
+{
+	int counts[3];
+	memcpy(counts, in, sizeof(counts));
+	in += sizeof(counts);
+	int oldHighWater = pool->highWater;
+	pool->size = counts[0];
+	pool->highWater = counts[1];
+	pool->numFree = counts[2];
+	memcpy(pool->generations, in, pool->capacity * sizeof(unsigned int));
+	in += pool->capacity * sizeof(unsigned int);
+	memcpy(pool->slots, in, (size_t)pool->highWater * pool->elemSize);
+	in += (size_t)pool->highWater * pool->elemSize;
+	memcpy(pool->live, in, pool->highWater * sizeof(bool));
+	in += pool->highWater * sizeof(bool);
+	memcpy(pool->freeSlots, in, pool->numFree * sizeof(int));
+	in += pool->numFree * sizeof(int);
+	if (pool->motion != NULL)
+		in = loadMotion(pool->motion, pool->highWater, in);
+
+	// Anything we had above the restored high water mark is untouched again
+	for (int i = pool->highWater; i < oldHighWater; i++){
+		pool->live[i] = false;
+		if (pool->motion != NULL)
+			clearMotionSlot(pool->motion, i);
 	}
-	// Reset the list fields
-	list->size = 0;
-	list->head = NULL;
-	list->tail = NULL;
+	return in;
 }
@@ -1,58 +1,148 @@
-
-
 #ifndef __DEEZSTRUCTZ__
 #define __DEEZSTRUCTZ__
 
+#include "motion.h"
 
-#include "objects.h"
 /*
 	@file datastructures.h
 	@author Derek Batts - dsbatts@ncsu.edu
-	This header file defines functions and struct for lists of
-	Asteroids, missles, and explosions
+	This header file defines functions and structs for pools of
+	Asteroids, missles, aliens, and explosions
 */
 
-// A struct describing a node for a generic list
-typedef struct node {
-	void* value;
-	struct node* next;
-} ObjectNode;
+// A handle naming a slot in a pool along with the generation of the slot it was made for
+typedef struct {
+	// The slot the object lives in
+	int index;
+	// The generation of the slot when the handle was made
+	unsigned int generation;
+} ObjectHandle;
 
-// A struct containing basic data needed to manipulate a generic list
+// A struct describing a fixed capacity slab of objects of a single type
 typedef struct {
-	ObjectNode* head;
-	ObjectNode* tail;
+	// The storage for every slot, laid out back to back
+	char* slots;
+	// The size of a single object in bytes
+	int elemSize;
+	// The number of slots in the pool
+	int capacity;
+	// The number of live objects in the pool
 	int size;
-} ObjectList;
+	// One past the highest slot ever handed out, iteration can stop here
+	int highWater;
+	// The generation of each slot, bumped whenever the slot is freed
+	unsigned int* generations;
+	// Whether or not each slot holds a live object
+	bool* live;
+	// A stack of free slots below the high water mark
+	int* freeSlots;
+	// The number of slots on the free stack
+	int numFree;
+	// The per-tick state of every slot as columns, or NULL if the objects do not move on their own
+	MotionStore* motion;
+} ObjectPool;
+
+/*
+	This function creates a pool. All memory the pool will ever use is allocated here.
+	@param elemSize The size of the objects the pool holds.
+	@param capacity The max number of objects the pool can hold at once.
+	@param withMotion True if the pool should keep a motion store alongside its slots.
+	@return A pointer to the pool that was made.
+ */
+ObjectPool* createPool(int elemSize, int capacity, bool withMotion);
+
+/*
+	This function frees a pool and everything in it.
+	@param pool A pointer to the pool to destroy.
+ */
+void destroyPool(ObjectPool* pool);
+
+/*
+	This function grabs a free slot from the pool and marks it live.
+	The slot (and its motion, if any) is zeroed before it is returned.
+	@param pool A pointer to the pool to take a slot from.
+	@return A pointer to the new object, or NULL if the pool is full.
+ */
+void* poolAdd(ObjectPool* pool);
+
+/*
+	This function frees the slot holding the given object. It runs in constant time.
+	The object must have come from this pool.
+	@param value A pointer to the object you want to remove.
+	@param pool A pointer to the pool you want to remove it from.
+	@return True if the object was live and got removed, false otherwise.
+ */
+bool poolRemove(void* value, ObjectPool* pool);
+
+/*
+	This function gets the object in a given slot.
+	@param pool A pointer to the pool to look in.
+	@param index The slot to look at.
+	@return A pointer to the object, or NULL if the slot is not live.
+ */
+void* poolSlot(ObjectPool* pool, int index);
+
+/*
+	This function finds the slot a given object lives in.
+	@param value A pointer to an object in the pool.
+	@param pool A pointer to the pool the object is in.
+	@return The slot index of the object.
+ */
+int poolIndexOf(void* value, ObjectPool* pool);
+
+/*
+	This function makes a handle for a given object that can be checked later,
+	even after the object has been removed and its slot reused.
+	@param value A pointer to a live object in the pool.
+	@param pool A pointer to the pool the object is in.
+	@return A handle to the object.
+ */
+ObjectHandle poolHandle(void* value, ObjectPool* pool);
+
+/*
+	This function looks up the object a handle refers to.
+	@param handle The handle to look up.
+	@param pool A pointer to the pool the handle was made from.
+	@return A pointer to the object, or NULL if it has since been removed.
+ */
+void* poolLookup(ObjectHandle handle, ObjectPool* pool);
+
+/*
+	This function removes everything from a pool. No memory is freed.
+	@param pool A pointer to the pool to clear
+ */
+void clearPool(ObjectPool* pool);
 
 /*
-	This function creates a list.
-	@return A pointer to the list that was made.
+	This function works out how many bytes savePool will write for a pool as it is now.
+	@param pool A pointer to the pool.
+	@return The number of bytes.
  */
-ObjectList* createList();
+size_t poolSnapshotSize(const ObjectPool* pool);
 
 /*
-	This function adds a pointer of any type to the given list.
-	@param value The pointer to the thing you want to add to the list.
-	@param list A pointer to the list you want to add stuff to.
+	This function works out the most bytes savePool could ever write for a pool.
+	@param pool A pointer to the pool.
+	@return The number of bytes.
  */
-void addToList(void* value, ObjectList* list);
+size_t poolMaxSnapshotSize(const ObjectPool* pool);
 
 /*
-	This function looks for a given pointer in a list and removes it if present.
-	This function will free the node storing the value, BUT WILL NOT FREE THE VALUE.
-	WARNING: This looks for values by comparing thier memory addresses not thier actual values.
-	@param value A pointer to the item you want to remove.
-	@param list A pointer to the list you want to remove it from.
-	@return True if the item was found and removed, false otherwise.
+	This function copies everything in a pool into a flat buffer.
+	Only slots below the high water mark are copied.
+	@param pool A pointer to the pool to save.
+	@param out Where to write, there must be poolSnapshotSize(pool) bytes of room.
+	@return A pointer just past what was written.
  */
-bool removeFromList(void* value, ObjectList* list);
+char* savePool(const ObjectPool* pool, char* out);
 
 /*
-	This function clears a list and frees all the nodes AND VALUES
-	ASSOCIATED WITH THEM.
-	@param list A pointer to the list to clear
+	This function puts a pool back the way it was when savePool was called.
+	The pool must have the same element size, capacity, and motion store as the one saved.
+	@param pool A pointer to the pool to load into.
+	@param in Where to read from.
+	@return A pointer just past what was read.
  */
-void clearList(ObjectList* list);
+const char* loadPool(ObjectPool* pool, const char* in);
 
 #endif // !__DEEZSTRUCTZ__
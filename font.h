@@ -0,0 +1,24 @@
+#ifndef __FONT__
+#define __FONT__
+
+/*
+	@file font.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the fixed width font every renderer draws text with.
+	Nothing in here knows about GLUT or OpenGL.
+*/
+
+// How big each glyph of the font is in pixels
+#define GLYPH_WIDTH 8
+#define GLYPH_HEIGHT 13
+// How far below the baseline the glyphs go
+#define GLYPH_DESCENT 3
+// The characters the font has (printable ASCII), anything else is drawn as a space
+#define FIRST_GLYPH ' '
+#define LAST_GLYPH '~'
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+
+// The glyphs of the font, top row first, one byte a row with the leftmost pixel in the high bit
+extern const unsigned char fontGlyphs[NUM_GLYPHS][GLYPH_HEIGHT];
+
+#endif
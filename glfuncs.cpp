@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include "glfuncs.h"
+
+/*
+	@file glfuncs.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file holds the pointers to every GL function past 1.1 and looks them up.
+ */
+
+// Every pointer starts out empty
+#define GL_DEFINE_FUNCTION(type, name) type p##name = NULL;
+GL_FUNCTIONS(GL_DEFINE_FUNCTION)
+
+/*
+	This function checks the context is new enough for the renderer, then looks up every function
+	it uses. A context must be current. Some drivers hand out a pointer for any name at all, so the
+	version is checked first and a function that was found is not proof it works.
+	@param getProc The function to look them up with.
+	@return True if the context is new enough and every function was found, false (after printing why) otherwise.
+*/
+bool loadGLFunctions(GLGetProcFunc getProc)
+{
+	// The version string starts with major.minor (after a name, on some drivers)
+	const char* version = (const char*)glGetString(GL_VERSION);
+	int major = 0;
+	int minor = 0;
+	if (version != NULL){
+		const char* digits = version;
+		while ((*digits != '\0') && ((*digits < '0') || (*digits > '9')))
+			digits++;
+		sscanf(digits, "%d.%d", &major, &minor);
+	}
+	if ((major < GL_NEEDED_MAJOR) || ((major == GL_NEEDED_MAJOR) && (minor < GL_NEEDED_MINOR))){
+		fprintf(stderr, "OpenGL %d.%d is needed, this context is %s\n", GL_NEEDED_MAJOR, GL_NEEDED_MINOR,
+			(version != NULL) ? version : "unknown");
+		return false;
+	}
+
+	// Look each one up, stopping at the first the driver does not have
+#define GL_LOAD_FUNCTION(type, name) \
+	p##name = (type)getProc(#name); \
+	if (p##name == NULL){ \
+		fprintf(stderr, "OpenGL is missing %s\n", #name); \
+		return false; \
+	}
+	GL_FUNCTIONS(GL_LOAD_FUNCTION)
+#undef GL_LOAD_FUNCTION
+	return true;
+}
@@ -0,0 +1,108 @@
+#ifndef __GLFUNCS__
+#define __GLFUNCS__
+
+#include "GL/glut.h"
+#include <GL/glext.h>
+
+/*
+	@file glfuncs.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file looks up every OpenGL function newer than 1.1 that the renderer uses.
+	Windows only hands out 1.1 on its own, so everything past that is called through a pointer
+	found once a context exists. The pointers are named with a p in front and the usual names
+	are defined over them, so the rest of the code calls GL the normal way.
+	Do not define GL_GLEXT_PROTOTYPES anywhere this header is included.
+*/
+
+// The oldest OpenGL the renderer runs on
+#define GL_NEEDED_MAJOR 3
+#define GL_NEEDED_MINOR 3
+
+// Every function past GL 1.1 the renderer uses, with the type of its pointer
+#define GL_FUNCTIONS(F) \
+	F(PFNGLACTIVETEXTUREPROC, glActiveTexture) \
+	F(PFNGLGENBUFFERSPROC, glGenBuffers) \
+	F(PFNGLDELETEBUFFERSPROC, glDeleteBuffers) \
+	F(PFNGLBINDBUFFERPROC, glBindBuffer) \
+	F(PFNGLBUFFERDATAPROC, glBufferData) \
+	F(PFNGLBUFFERSUBDATAPROC, glBufferSubData) \
+	F(PFNGLMAPBUFFERPROC, glMapBuffer) \
+	F(PFNGLUNMAPBUFFERPROC, glUnmapBuffer) \
+	F(PFNGLGENVERTEXARRAYSPROC, glGenVertexArrays) \
+	F(PFNGLDELETEVERTEXARRAYSPROC, glDeleteVertexArrays) \
+	F(PFNGLBINDVERTEXARRAYPROC, glBindVertexArray) \
+	F(PFNGLENABLEVERTEXATTRIBARRAYPROC, glEnableVertexAttribArray) \
+	F(PFNGLVERTEXATTRIBPOINTERPROC, glVertexAttribPointer) \
+	F(PFNGLVERTEXATTRIBIPOINTERPROC, glVertexAttribIPointer) \
+	F(PFNGLVERTEXATTRIBDIVISORPROC, glVertexAttribDivisor) \
+	F(PFNGLDRAWARRAYSINSTANCEDPROC, glDrawArraysInstanced) \
+	F(PFNGLTEXBUFFERPROC, glTexBuffer) \
+	F(PFNGLCREATESHADERPROC, glCreateShader) \
+	F(PFNGLDELETESHADERPROC, glDeleteShader) \
+	F(PFNGLSHADERSOURCEPROC, glShaderSource) \
+	F(PFNGLCOMPILESHADERPROC, glCompileShader) \
+	F(PFNGLGETSHADERIVPROC, glGetShaderiv) \
+	F(PFNGLGETSHADERINFOLOGPROC, glGetShaderInfoLog) \
+	F(PFNGLCREATEPROGRAMPROC, glCreateProgram) \
+	F(PFNGLDELETEPROGRAMPROC, glDeleteProgram) \
+	F(PFNGLATTACHSHADERPROC, glAttachShader) \
+	F(PFNGLBINDATTRIBLOCATIONPROC, glBindAttribLocation) \
+	F(PFNGLLINKPROGRAMPROC, glLinkProgram) \
+	F(PFNGLGETPROGRAMIVPROC, glGetProgramiv) \
+	F(PFNGLGETPROGRAMINFOLOGPROC, glGetProgramInfoLog) \
+	F(PFNGLUSEPROGRAMPROC, glUseProgram) \
+	F(PFNGLGETUNIFORMLOCATIONPROC, glGetUniformLocation) \
+	F(PFNGLUNIFORM1IPROC, glUniform1i)
+
+// A pointer for each function
+#define GL_DECLARE_FUNCTION(type, name) extern type p##name;
+GL_FUNCTIONS(GL_DECLARE_FUNCTION)
+
+// Call each one by its usual name
+#define glActiveTexture pglActiveTexture
+#define glGenBuffers pglGenBuffers
+#define glDeleteBuffers pglDeleteBuffers
+#define glBindBuffer pglBindBuffer
+#define glBufferData pglBufferData
+#define glBufferSubData pglBufferSubData
+#define glMapBuffer pglMapBuffer
+#define glUnmapBuffer pglUnmapBuffer
+#define glGenVertexArrays pglGenVertexArrays
+#define glDeleteVertexArrays pglDeleteVertexArrays
+#define glBindVertexArray pglBindVertexArray
+#define glEnableVertexAttribArray pglEnableVertexAttribArray
+#define glVertexAttribPointer pglVertexAttribPointer
+#define glVertexAttribIPointer pglVertexAttribIPointer
+#define glVertexAttribDivisor pglVertexAttribDivisor
+#define glDrawArraysInstanced pglDrawArraysInstanced
+#define glTexBuffer pglTexBuffer
+#define glCreateShader pglCreateShader
+#define glDeleteShader pglDeleteShader
+#define glShaderSource pglShaderSource
+#define glCompileShader pglCompileShader
+#define glGetShaderiv pglGetShaderiv
+#define glGetShaderInfoLog pglGetShaderInfoLog
+#define glCreateProgram pglCreateProgram
+#define glDeleteProgram pglDeleteProgram
+#define glAttachShader pglAttachShader
+#define glBindAttribLocation pglBindAttribLocation
+#define glLinkProgram pglLinkProgram
+#define glGetProgramiv pglGetProgramiv
+#define glGetProgramInfoLog pglGetProgramInfoLog
+#define glUseProgram pglUseProgram
+#define glGetUniformLocation pglGetUniformLocation
+#define glUniform1i pglUniform1i
+
+// A function that finds a GL function by name (glutGetProcAddress, eglGetProcAddress, ...)
+typedef void* (*GLGetProcFunc)(const char* name);
+
+/*
+	This function checks the context is new enough for the renderer, then looks up every function
+	it uses. A context must be current. Some drivers hand out a pointer for any name at all, so the
+	version is checked first and a function that was found is not proof it works.
+	@param getProc The function to look them up with.
+	@return True if the context is new enough and every function was found, false (after printing why) otherwise.
+ */
+bool loadGLFunctions(GLGetProcFunc getProc);
+
+#endif
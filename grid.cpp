@@ -0,0 +1,276 @@
+#include <stdlib.h>
+#include <math.h>
+#include "objects.h"
+#include "grid.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*
+	@file grid.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the uniform grid used to find collision candidates.
+	Points are counting sorted into cells so building and querying never allocate.
+ */
+
+/*
+	This function wraps a cell index around the grid.
+	@param c The cell index, possibly off either end.
+	@param cells The number of cells along the side.
+	@return The cell index inside the grid.
+ */
+static inline int wrapCell(int c, int cells)
+{
+	c %= cells;
+	if (c < 0)
+		c += cells;
+	return c;
+}
+
+/*
+	This function finds the lowest set bit of a word.
+	@param bits The word, which must not be zero.
+	@return The index of the lowest set bit.
+ */
+static inline int lowestBit(unsigned long long bits)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return (int)index;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
+/*
+	This function creates a grid. All memory the grid will ever use is allocated here.
+	@param capacity The most points the grid will ever hold.
+	@return A pointer to the grid that was made.
+*/
+SpatialGrid* createGrid(int capacity)
+{
+	SpatialGrid* grid = (SpatialGrid*)malloc(sizeof(SpatialGrid));
+	// Allocate enough cells for the finest grid we will ever use
+	grid->cellStart = (int*)malloc(((GRID_MAX_CELLS * GRID_MAX_CELLS) + 1) * sizeof(int));
+	// Allocate room for every point
+	grid->entries = (int*)malloc(capacity * sizeof(int));
+	grid->addedSlots = (int*)malloc(capacity * sizeof(int));
+	grid->addedX = (float*)malloc(capacity * sizeof(float));
+	grid->addedY = (float*)malloc(capacity * sizeof(float));
+	grid->addedCells = (int*)malloc(capacity * sizeof(int));
+	grid->found = (int*)malloc(capacity * sizeof(int));
+	grid->mergePos = (int*)malloc(capacity * sizeof(int));
+	grid->mergeEnd = (int*)malloc(capacity * sizeof(int));
+	// The marks start (and are always left) clear
+	int words = (capacity + 63) / 64;
+	grid->marks = (unsigned long long*)calloc(words, sizeof(unsigned long long));
+	grid->markWords = (unsigned long long*)calloc((words + 63) / 64, sizeof(unsigned long long));
+	grid->capacity = capacity;
+	resetGrid(grid);
+	finishGrid(grid);
+	return grid;
+}
+
+/*
+	This function frees a grid.
+	@param grid A pointer to the grid to destroy.
+*/
+void destroyGrid(SpatialGrid* grid)
+{
+	free(grid->cellStart);
+	free(grid->entries);
+	free(grid->addedSlots);
+	free(grid->addedX);
+	free(grid->addedY);
+	free(grid->addedCells);
+	free(grid->found);
+	free(grid->mergePos);
+	free(grid->mergeEnd);
+	free(grid->marks);
+	free(grid->markWords);
+	free(grid);
+}
+
+/*
+	This function empties a grid so points can be added to it.
+	@param grid A pointer to the grid to reset.
+*/
+void resetGrid(SpatialGrid* grid)
+{
+	grid->numAdded = 0;
+}
+
+/*
+	This function adds a point to a grid. finishGrid must be called before the grid is queried.
+	@param grid A pointer to the grid to add to.
+	@param slot The slot of the object at this point, less than the capacity of the grid.
+	@param x The x co-ordinate of the point.
+	@param y The y co-ordinate of the point.
+*/
+void gridAddPoint(SpatialGrid* grid, int slot, float x, float y)
+{
+	// Remember the point, its cell gets worked out once we know how many points there are
+	int n = grid->numAdded++;
+	grid->addedSlots[n] = slot;
+	grid->addedX[n] = x;
+	grid->addedY[n] = y;
+}
+
+/*
+	This function sorts all the added points into their cells.
+	@param grid A pointer to the grid to finish.
+*/
+void finishGrid(SpatialGrid* grid)
+{
+	int n = grid->numAdded;
+
+	// Size the grid so cells hold a handful of points each
+	int cells = (int)sqrt((double)n / GRID_TARGET_PER_CELL);
+	if (cells < GRID_MIN_CELLS)
+		cells = GRID_MIN_CELLS;
+	else if (cells > GRID_MAX_CELLS)
+		cells = GRID_MAX_CELLS;
+	grid->cells = cells;
+	grid->cellW = (BOUND_X_UPPER - BOUND_X_LOWER) / cells;
+	grid->cellH = (BOUND_Y_UPPER - BOUND_Y_LOWER) / cells;
+	int numCells = cells * cells;
+
+	// Work out the cell of every point and count how many land in each cell
+	for (int c = 0; c <= numCells; c++)
+		grid->cellStart[c] = 0;
+	for (int i = 0; i < n; i++){
+		int cx = wrapCell((int)floor((grid->addedX[i] - BOUND_X_LOWER) / grid->cellW), cells);
+		int cy = wrapCell((int)floor((grid->addedY[i] - BOUND_Y_LOWER) / grid->cellH), cells);
+		grid->addedCells[i] = (cy * cells) + cx;
+		grid->cellStart[grid->addedCells[i]]++;
+	}
+
+	// Turn the counts into the end of each cell's run
+	for (int c = 1; c <= numCells; c++)
+		grid->cellStart[c] += grid->cellStart[c - 1];
+
+	// Walk backwards dropping each slot at the end of its run, which leaves every
+	// cellStart pointing at the start of its run and keeps slots in the order they were added
+	for (int i = n - 1; i >= 0; i--)
+		grid->entries[--grid->cellStart[grid->addedCells[i]]] = grid->addedSlots[i];
+}
+
+/*
+	This function rebuilds a grid from every live slot of a pool with a motion store.
+	@param grid A pointer to the grid to build.
+	@param pool A pointer to the pool to read positions from.
+*/
+void buildGridFromPool(SpatialGrid* grid, ObjectPool* pool)
+{
+	resetGrid(grid);
+	for (int i = 0; i < pool->highWater; i++){
+		if (pool->live[i])
+			gridAddPoint(grid, i, pool->motion->posX[i], pool->motion->posY[i]);
+	}
+	finishGrid(grid);
+}
+
+/*
+	This function finds every point that might lie within a box around a given position.
+	The box wraps around the edges of the window.
+	@param grid A pointer to the grid to look in.
+	@param x The x co-ordinate of the center of the box.
+	@param y The y co-ordinate of the center of the box.
+	@param reachX How far the box reaches left and right of the center.
+	@param reachY How far the box reaches above and below the center.
+	@return The number of slots found. They are stored in grid->found in increasing order.
+*/
+int queryGrid(SpatialGrid* grid, float x, float y, float reachX, float reachY)
+{
+	int cells = grid->cells;
+	// Work out the range of cells the box covers (not wrapped yet)
+	int cx0 = (int)floor((x - reachX - BOUND_X_LOWER) / grid->cellW);
+	int cx1 = (int)floor((x + reachX - BOUND_X_LOWER) / grid->cellW);
+	int cy0 = (int)floor((y - reachY - BOUND_Y_LOWER) / grid->cellH);
+	int cy1 = (int)floor((y + reachY - BOUND_Y_LOWER) / grid->cellH);
+	// Never visit a cell twice if the box is wider than the window
+	if ((cx1 - cx0) >= cells){
+		cx0 = 0;
+		cx1 = cells - 1;
+	}
+	if ((cy1 - cy0) >= cells){
+		cy0 = 0;
+		cy1 = cells - 1;
+	}
+
+	// Find the run of every covered cell that has anything in it (only the first cell on each
+	// side is wrapped with a divide, stepping past the last cell wraps back to the first)
+	int runs = 0;
+	int firstX = wrapCell(cx0, cells);
+	int wy = wrapCell(cy0, cells);
+	for (int cy = cy0; cy <= cy1; cy++){
+		const int* row = grid->cellStart + (wy * cells);
+		int wx = firstX;
+		for (int cx = cx0; cx <= cx1; cx++){
+			if (row[wx] < row[wx + 1]){
+				grid->mergePos[runs] = row[wx];
+				grid->mergeEnd[runs] = row[wx + 1];
+				runs++;
+			}
+			if (++wx == cells)
+				wx = 0;
+		}
+		if (++wy == cells)
+			wy = 0;
+	}
+
+	// Each run is already in slot order (points are added in slot order and sorted into cells
+	// stably), so a few runs are merged to give candidates in the order a full scan would
+	int* pos = grid->mergePos;
+	int* end = grid->mergeEnd;
+	int count = 0;
+	if (runs <= GRID_MERGE_RUNS){
+		while (runs > 0){
+			// Take the smallest next slot of any run, then drop its run once it is used up
+			int best = 0;
+			int bestSlot = grid->entries[pos[0]];
+			for (int r = 1; r < runs; r++){
+				if (grid->entries[pos[r]] < bestSlot){
+					bestSlot = grid->entries[pos[r]];
+					best = r;
+				}
+			}
+			grid->found[count++] = bestSlot;
+			if (++pos[best] == end[best]){
+				runs--;
+				pos[best] = pos[runs];
+				end[best] = end[runs];
+			}
+		}
+		return count;
+	}
+
+	// Too many runs to merge, so mark every slot and read the marks back in order
+	int lowest = grid->capacity;
+	int highest = 0;
+	for (int r = 0; r < runs; r++){
+		for (int e = pos[r]; e < end[r]; e++){
+			int slot = grid->entries[e];
+			grid->marks[slot >> 6] |= 1ULL << (slot & 63);
+			grid->markWords[slot >> 12] |= 1ULL << ((slot >> 6) & 63);
+			if (slot < lowest)
+				lowest = slot;
+			if (slot > highest)
+				highest = slot;
+		}
+	}
+	// Only look at the words that were marked, clearing them on the way for the next query
+	for (int group = lowest >> 12; group <= (highest >> 12); group++){
+		unsigned long long words = grid->markWords[group];
+		grid->markWords[group] = 0;
+		for (; words != 0; words &= words - 1){
+			int word = (group << 6) + lowestBit(words);
+			unsigned long long bits = grid->marks[word];
+			grid->marks[word] = 0;
+			for (; bits != 0; bits &= bits - 1)
+				grid->found[count++] = (word << 6) + lowestBit(bits);
+		}
+	}
+	return count;
+}
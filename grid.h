@@ -0,0 +1,108 @@
+#ifndef __GRID__
+#define __GRID__
+
+#include "datastructures.h"
+
+/*
+	@file grid.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines a uniform grid over the game window that buckets
+	objects by position, so collision checks only look at objects that are nearby.
+	The grid wraps around the window edges the same way everything in the game does.
+*/
+
+// The smallest number of cells along each side of the grid
+#define GRID_MIN_CELLS 12
+// The largest number of cells along each side of the grid
+#define GRID_MAX_CELLS 256
+// How many objects we aim to have in each cell when sizing the grid
+#define GRID_TARGET_PER_CELL 2
+// A query covering more non-empty cells than this sorts by marking slots instead of merging cells
+#define GRID_MERGE_RUNS 8
+
+// A struct describing a grid of points bucketed by cell
+typedef struct {
+	// The number of cells along each side this time it was built
+	int cells;
+	// The width and height of a single cell
+	float cellW;
+	float cellH;
+	// Where each cell's run of slots starts in the entries array (cells * cells + 1 of them)
+	int* cellStart;
+	// The slot of every point, sorted by cell
+	int* entries;
+	// The slot, position, and cell of every point in the order they were added
+	int* addedSlots;
+	float* addedX;
+	float* addedY;
+	int* addedCells;
+	// The number of points added since the grid was reset
+	int numAdded;
+	// The most points the grid can hold
+	int capacity;
+	// Scratch space for the results of a query
+	int* found;
+	// Scratch space for the runs of the cells a query covers, where each run is up to and where
+	// it ends (there is never a run for more cells than there are points)
+	int* mergePos;
+	int* mergeEnd;
+	// One bit per slot for wide queries, and one bit per word of those saying which are not empty.
+	// Both are all zero between queries.
+	unsigned long long* marks;
+	unsigned long long* markWords;
+} SpatialGrid;
+
+/*
+	This function creates a grid. All memory the grid will ever use is allocated here.
+	@param capacity The most points the grid will ever hold.
+	@return A pointer to the grid that was made.
+ */
+SpatialGrid* createGrid(int capacity);
+
+/*
+	This function frees a grid.
+	@param grid A pointer to the grid to destroy.
+ */
+void destroyGrid(SpatialGrid* grid);
+
+/*
+	This function empties a grid so points can be added to it.
+	@param grid A pointer to the grid to reset.
+ */
+void resetGrid(SpatialGrid* grid);
+
+/*
+	This function adds a point to a grid. finishGrid must be called before the grid is queried.
+	@param grid A pointer to the grid to add to.
+	@param slot The slot of the object at this point, less than the capacity of the grid.
+	@param x The x co-ordinate of the point.
+	@param y The y co-ordinate of the point.
+ */
+void gridAddPoint(SpatialGrid* grid, int slot, float x, float y);
+
+/*
+	This function sorts all the added points into their cells.
+	@param grid A pointer to the grid to finish.
+ */
+void finishGrid(SpatialGrid* grid);
+
+/*
+	This function rebuilds a grid from every live slot of a pool with a motion store.
+	@param grid A pointer to the grid to build.
+	@param pool A pointer to the pool to read positions from.
+ */
+void buildGridFromPool(SpatialGrid* grid, ObjectPool* pool);
+
+/*
+	This function finds every point that might lie within a box around a given position.
+	The box wraps around the edges of the window.
+	@param grid A pointer to the grid to look in.
+	@param x The x co-ordinate of the center of the box.
+	@param y The y co-ordinate of the center of the box.
+	@param reachX How far the box reaches left and right of the center.
+	@param reachY How far the box reaches above and below the center.
+	@return The number of slots found. They are stored in grid->found in increasing order.
+ */
+int queryGrid(SpatialGrid* grid, float x, float y, float reachX, float reachY);
+
+#endif
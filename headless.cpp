@@ -0,0 +1,308 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "world.h"
+#include "replay.h"
+#include "vecenv.h"
+#include "profiler.h"
+#include "trace.h"
+#include "scene.h"
+#include "commands.h"
+#include "raster.h"
+#include "capture.h"
+
+/*
+	@file headless.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This program runs the asteroids simulation with no window as fast as the CPU allows.
+	It is meant for render-less machines, batch runs, and benchmarks.
+	Given a replay it plays back the recorded game instead, at full speed.
+	Given a number of worlds it steps that many worlds at once on a pool of threads.
+	Given --profile it also times every phase of the last few hundred ticks.
+	Given --trace=FILE it streams every phase of every tick to a Chrome trace.
+	Given --render=WxH it also draws every tick in memory with the software rasterizer (on
+	--threads=N threads), given --snapshot=FILE it saves the last frame drawn as an image, and given
+	--capture=FILE it writes every frame drawn to a video (one frame a tick, none dropped).
+	Usage: headless --headless [--ticks=N] [--hz=N] [--seed=N] [--replay=FILE] [--profile] [--trace=FILE]
+		[--worlds=N] [--threads=N] [--render=WxH] [--snapshot=FILE] [--capture=FILE]
+ */
+
+// The number of ticks to run if none are asked for
+#define HEADLESS_DEFAULT_TICKS 10000
+// How to run this program
+#define HEADLESS_USAGE "Usage: %s --headless [--ticks=N] [--hz=N] [--seed=N] [--replay=FILE] [--profile] [--trace=FILE] [--worlds=N] [--threads=N] [--render=WxH] [--snapshot=FILE] [--capture=FILE]\n"
+// The size frames are drawn at if a snapshot is asked for without a size
+#define HEADLESS_DEFAULT_SIZE 800
+// How big the score line is drawn, the same as the game
+#define HEADLESS_TEXT_SCALE 2
+
+/*
+	This function finishes the trace, it is run when the program exits.
+ */
+static void finishTrace()
+{
+	uint64_t dropped = stopTrace();
+	if (dropped > 0)
+		fprintf(stderr, "The trace dropped %llu events\n", (unsigned long long)dropped);
+}
+
+/*
+	This function draws a world in memory the way the game draws it, score line and all.
+	@param raster The rasterizer to draw with.
+	@param world The world to draw.
+	@param scene Where to copy the world to.
+	@param commands Where to build the draw commands.
+ */
+static void drawFrame(Rasterizer* raster, const World* world, Scene* scene, CommandBuffer* commands)
+{
+	captureScene(world, NULL, scene);
+	buildCommands(commands, scene);
+	beginRaster(raster);
+	rasterCommands(raster, commands);
+	char hudText[64];
+	snprintf(hudText, sizeof(hudText), "SCORE: %d    DEATHS LEFT: %d", scene->score, scene->deathsLeft);
+	const unsigned char white[] = { 255, 255, 255, 255 };
+	addRasterText(raster, -5.0f, 5.0f, Z_LEVEL, hudText, HEADLESS_TEXT_SCALE, white);
+	finishRaster(raster);
+}
+
+/*
+	This function steps a batch of worlds together with no input and reports how long it took.
+	@param config The config for every world.
+	@param ticks The number of times to step the batch.
+	@param numWorlds The number of worlds in the batch.
+	@param numThreads The number of worker threads, or -1 for one per core.
+	@return EXIT_SUCCESS
+ */
+static int runBatch(const WorldConfig* config, long long ticks, int numWorlds, int numThreads)
+{
+	VecEnv* env = createVecEnv(numWorlds, config, numThreads);
+	// The caller owns every buffer the batch writes to
+	unsigned int* inputs = (unsigned int*)calloc(numWorlds, sizeof(unsigned int));
+	float* obs = (float*)malloc((size_t)numWorlds * OBS_SIZE * sizeof(float));
+	float* rewards = (float*)malloc(numWorlds * sizeof(float));
+	unsigned int* deaths = (unsigned int*)malloc(numWorlds * sizeof(unsigned int));
+
+	// Step the whole batch, adding up what happened
+	double totalReward = 0.0;
+	long long totalDeaths = 0;
+	resetVecEnv(env, obs);
+	auto start = std::chrono::steady_clock::now();
+	for (long long t = 0; t < ticks; t++){
+		stepVecEnv(env, inputs, obs, rewards, deaths);
+		for (int i = 0; i < numWorlds; i++){
+			totalReward += rewards[i];
+			totalDeaths += deaths[i];
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+	double worldTicks = (double)ticks * numWorlds;
+
+	// Report how it went
+	printf("worlds:      %d\n", numWorlds);
+	printf("threads:     %d\n", env->workers->numThreads + 1);
+	printf("ticks:       %lld\n", ticks);
+	printf("elapsed:     %.3f ms\n", ns / 1e6);
+	printf("ns/step:     %.1f\n", (ticks > 0) ? (ns / ticks) : 0.0);
+	printf("world-ticks/s: %.0f\n", (ns > 0) ? (worldTicks * 1e9 / ns) : 0.0);
+	printf("reward:      %.0f\n", totalReward);
+	printf("deaths:      %lld\n", totalDeaths);
+
+	free(inputs);
+	free(obs);
+	free(rewards);
+	free(deaths);
+	destroyVecEnv(env);
+	return EXIT_SUCCESS;
+}
+
+/*
+	This is the main function. It steps a world N times and reports how long it took.
+	@param argc The number of arguments given
+	@param argv The argument vector
+	@return EXIT_SUCCESS, or EXIT_FAILURE if the arguments were bad
+*/
+int main(int argc, char** argv)
+{
+	long long ticks = HEADLESS_DEFAULT_TICKS;
+	bool headless = false;
+	WorldConfig config;
+	defaultWorldConfig(&config);
+	const char* replayPath = NULL;
+	int numWorlds = 0;
+	int numThreads = -1;
+	bool profile = false;
+	const char* tracePath = NULL;
+	int renderWidth = 0;
+	int renderHeight = 0;
+	const char* snapshotPath = NULL;
+	const char* capturePath = NULL;
+
+	// Read the arguments
+	for (int i = 1; i < argc; i++){
+		if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strncmp(argv[i], "--ticks=", 8) == 0)
+			ticks = atoll(argv[i] + 8);
+		else if (strncmp(argv[i], "--hz=", 5) == 0)
+			config.tickRate = atoi(argv[i] + 5);
+		else if (strncmp(argv[i], "--seed=", 7) == 0)
+			config.seed = strtoull(argv[i] + 7, NULL, 10);
+		else if (strncmp(argv[i], "--replay=", 9) == 0)
+			replayPath = argv[i] + 9;
+		else if (strncmp(argv[i], "--worlds=", 9) == 0)
+			numWorlds = atoi(argv[i] + 9);
+		else if (strncmp(argv[i], "--threads=", 10) == 0)
+			numThreads = atoi(argv[i] + 10);
+		else if (strcmp(argv[i], "--profile") == 0)
+			profile = true;
+		else if (strncmp(argv[i], "--trace=", 8) == 0)
+			tracePath = argv[i] + 8;
+		else if ((strncmp(argv[i], "--render=", 9) == 0) && (sscanf(argv[i] + 9, "%dx%d", &renderWidth, &renderHeight) == 2))
+			continue;
+		else if (strncmp(argv[i], "--snapshot=", 11) == 0)
+			snapshotPath = argv[i] + 11;
+		else if (strncmp(argv[i], "--capture=", 10) == 0)
+			capturePath = argv[i] + 10;
+		else {
+			fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			fprintf(stderr, HEADLESS_USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	// This binary has no window to fall back on
+	if (!headless || (ticks < 0) || (numWorlds < 0) || ((numWorlds > 0) && (replayPath != NULL)) ||
+		(renderWidth < 0) || (renderHeight < 0) || ((numWorlds > 0) && ((renderWidth > 0) || (snapshotPath != NULL) || (capturePath != NULL)))){
+		fprintf(stderr, HEADLESS_USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Start tracing before anything runs
+	if (tracePath != NULL){
+		if (!startTrace(tracePath)){
+			fprintf(stderr, "Could not start a trace in %s\n", tracePath);
+			return EXIT_FAILURE;
+		}
+		traceNameThread("headless");
+		atexit(finishTrace);
+	}
+
+	// Run a batch of worlds if asked to
+	if (numWorlds > 0)
+		return runBatch(&config, ticks, numWorlds, numThreads);
+
+	// A replay brings its own seed, tick rate, and length
+	Replay* replay = NULL;
+	if (replayPath != NULL){
+		replay = loadReplay(replayPath);
+		if (replay == NULL){
+			fprintf(stderr, "Could not load the replay %s\n", replayPath);
+			return EXIT_FAILURE;
+		}
+		config.seed = replay->seed;
+		config.tickRate = replay->tickRate;
+		ticks = replay->numTicks;
+	}
+
+	World* world = createWorld(&config);
+	if (profile)
+		world->profiler = createProfiler();
+
+	// Draw every tick in memory if asked to (a snapshot or a capture needs frames)
+	Rasterizer* raster = NULL;
+	Scene* scene = NULL;
+	CommandBuffer* commands = NULL;
+	if ((renderWidth == 0) && ((snapshotPath != NULL) || (capturePath != NULL))){
+		renderWidth = HEADLESS_DEFAULT_SIZE;
+		renderHeight = HEADLESS_DEFAULT_SIZE;
+	}
+	if ((renderWidth > 0) && (renderHeight > 0)){
+		raster = createRasterizer(renderWidth, renderHeight, numThreads);
+		scene = createScene(world);
+		commands = createCommandBuffer(world);
+	}
+	// The video plays back at the speed the world ticks
+	FrameCapture* capture = NULL;
+	if (capturePath != NULL){
+		capture = startCapture(capturePath, raster->width, raster->height, world->tickRate);
+		if (capture == NULL){
+			fprintf(stderr, "Could not start a capture in %s\n", capturePath);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Run every tick with the recorded input (or none)
+	double drawNs = 0.0;
+	auto start = std::chrono::steady_clock::now();
+	for (long long t = 0; t < ticks; t++){
+		stepWorld(world, (replay != NULL) ? replay->inputs[t] : 0);
+		if (raster != NULL){
+			auto drawStart = std::chrono::steady_clock::now();
+			drawFrame(raster, world, scene, commands);
+			// Nothing is waiting on us, so wait for the writer instead of dropping frames
+			if (capture != NULL){
+				waitForCapture(capture);
+				captureFrame(capture, raster->color, raster->width, raster->height, raster->stride);
+			}
+			drawNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - drawStart).count();
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+	double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() - drawNs;
+
+	// Report how it went
+	printf("ticks:      %lld\n", ticks);
+	printf("tick rate:  %d Hz\n", world->tickRate);
+	printf("seed:       %llu\n", (unsigned long long)world->seed);
+	printf("elapsed:    %.3f ms\n", ns / 1e6);
+	printf("ns/tick:    %.1f\n", (ticks > 0) ? (ns / ticks) : 0.0);
+	printf("score:      %d\n", world->lifetimeScore);
+	printf("deaths:     %u\n", world->deaths);
+	printf("asteroids:  %d\n", world->asteroids->size);
+	if (raster != NULL){
+		printf("frames:     %lld at %dx%d on %d threads\n", ticks, raster->width, raster->height, raster->workers->numThreads + 1);
+		printf("ns/frame:   %.1f\n", (ticks > 0) ? (drawNs / ticks) : 0.0);
+	}
+	if (capture != NULL){
+		uint64_t written = 0;
+		uint64_t dropped = stopCapture(capture, &written);
+		printf("captured:   %llu frames (%llu dropped)\n", (unsigned long long)written, (unsigned long long)dropped);
+	}
+
+	// Break down the last ticks phase by phase
+	if (world->profiler != NULL){
+		static ProfileFrame frames[PROFILE_HISTORY];
+		ProfileStats stats[NUM_PHASES];
+		int count = profileHistory(world->profiler, frames);
+		profileSummarize(frames, count, stats);
+		printf("\nlast %d ticks      mean ns   p99 ns   max ns\n", count);
+		for (int phase = PHASE_TICK; phase < PHASE_FIRST_DRAW; phase++)
+			printf("%-17s %8.0f %8.0f %8.0f\n", phaseNames[phase], stats[phase].mean, stats[phase].p99, stats[phase].max);
+		for (int counter = 0; (counter < NUM_COUNTERS) && (count > 0); counter++)
+			printf("%-17s %8u\n", counterNames[counter], frames[count - 1].counters[counter]);
+		destroyProfiler(world->profiler);
+	}
+
+	// Save the last frame, drawing the world as it started if no ticks were run
+	int status = EXIT_SUCCESS;
+	if (snapshotPath != NULL){
+		if (ticks == 0)
+			drawFrame(raster, world, scene, commands);
+		if (!saveRasterImage(raster, snapshotPath)){
+			fprintf(stderr, "Could not save the snapshot to %s\n", snapshotPath);
+			status = EXIT_FAILURE;
+		}
+	}
+	if (raster != NULL){
+		destroyRasterizer(raster);
+		destroyScene(scene);
+		destroyCommandBuffer(commands);
+	}
+
+	destroyWorld(world);
+	if (replay != NULL)
+		destroyReplay(replay);
+	return status;
+}
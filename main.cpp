@@ -1,10 +1,27 @@
 #include "GL/glut.h"
+#include "GL/freeglut_ext.h"
 #include <iostream>
+#include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 #include <time.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <atomic>
 #include "objects.h"
 #include "datastructures.h"
-#include "smack.h"
+#include "world.h"
+#include "replay.h"
+#include "profiler.h"
+#include "trace.h"
+#include "glfuncs.h"
+#include "render.h"
+#include "text.h"
+#include "scene.h"
+#include "raster.h"
+#include "capture.h"
+#include "readback.h"
 
 /*
     @file assignment1.cpp
@@ -15,16 +32,20 @@
     As well as the demo program available on the course webpage.
  */
 
-// The max number of asteroids that cand spawn at the begining of a screen / level
-#define MAX_NUM_ASTEROIDS 6
-// The depth we draw everything at
-#define Z_LEVEL -14.0f
-// The time between aliens spawning
-#define ALIEN_SPAWN_TIME 700
-// The minimum lifetime score needed for a small alien ship to spawn
-#define ALIEN_SMALL_SPAWN_REQ 5000
-// The amount of score needed to get a new life
-#define NEW_LIFE_REQ 7000
+// The shortest (in ms) the frame timer is ever armed for
+#define LOOP_MIN_WAIT_MS 1
+// The most ticks we will run back to back to catch up before dropping the time
+#define MAX_CATCHUP_TICKS 8
+// How big the window starts out (and how big captured frames are)
+#define WINDOW_SIZE 800
+// How many frames a second are drawn unless --fps says otherwise
+#define DEFAULT_FRAME_RATE 60
+// How far apart the lines of the profiler overlay are
+#define OVERLAY_LINE_HEIGHT 0.22f
+// How much bigger than the font the score is drawn
+#define HUD_TEXT_SCALE 2
+// The most glyphs drawn in one frame (the overlay takes a few hundred)
+#define TEXT_MAX_GLYPHS 4096
 using namespace std;
 
 void handle_menu(int ID);
@@ -36,24 +57,67 @@ void initLighting();
 void initRendering();
 void handleResize(int w, int h);
 void drawScene();
-void update(int value);
-void initAsteroidList(ObjectList* asteroids);
-void restartGame();
-void drawText(float x, float y, float z, char* string);
-
-// The number of asteroid to spawn on a new screen
-int num_asteroids = 1;
-// The timer to count until a new alien spawns
-int alienTimer = ALIEN_SPAWN_TIME;
-bool firstSpawned = false;
-int lifetimeScore = 0;
-Asteroid* referenceRoid;
-ObjectList* asteroids;
-PlayerShip* p;
-ObjectList* playerShots;
-ObjectList* explosions;
-ObjectList* aliens;
-ObjectList* alienShots;
+void simulate();
+void stopSimulation();
+void checkForFrame(int value);
+void saveRecording();
+void finishTrace();
+void finishCapture();
+void drawOverlay();
+void queueText(float x, float y, const char* string, int scale, const unsigned char color[4]);
+void presentRaster();
+void* getGLFunction(const char* name);
+
+// The world the game is running in
+World* world;
+// The INPUT_ bits for keys that are currently held down (set by GLUT, read by the simulation)
+atomic<unsigned int> heldKeys(0);
+// INPUT_ bits for keys that were pressed since the last tick, taken by every tick
+atomic<unsigned int> pressedKeys(0);
+// How long a single tick lasts in seconds
+double tickSeconds;
+// Real time that has passed but has not been simulated yet
+double accumulator = 0.0;
+// When the loop last checked the clock
+chrono::steady_clock::time_point lastTime;
+// The thread running the world, and whether it should keep running
+thread simThread;
+atomic<bool> simRunning(false);
+// The scenes the simulation hands to drawScene after every tick
+SceneBuffer* scenes;
+// The scene drawScene draws, blended between the newest scene's last two ticks
+Scene* blended;
+// The draw commands built from the blended scene each frame
+CommandBuffer* commands;
+// How many frames a second are drawn, and when the last one was due
+int frameRate = DEFAULT_FRAME_RATE;
+int64_t lastFrame = 0;
+// The recording of this game, or NULL if we are not recording
+Replay* recording = NULL;
+// Where to save the recording when the game closes
+const char* recordingPath = NULL;
+// The capture every frame drawn is handed to, or NULL if we are not capturing
+FrameCapture* capture = NULL;
+// Reads frames back off the GPU for the capture (not needed when drawing in software)
+FrameReader* reader = NULL;
+// How big the window is right now
+int windowWidth = WINDOW_SIZE;
+int windowHeight = WINDOW_SIZE;
+// The profiler timing each tick and the one timing each frame drawn
+Profiler* tickProfiler;
+Profiler* drawProfiler;
+// Whether the profiler overlay is showing
+bool showOverlay = false;
+// The renderer drawing everything that lives on the GPU, or NULL when drawing in software
+Renderer* renderer = NULL;
+// The text renderer drawing the score and the overlay
+TextRenderer* textRenderer;
+// The software rasterizer drawing everything instead when --soft is given, or NULL
+Rasterizer* raster = NULL;
+// The score line, and the score and deaths left it was last written for
+char hudText[64];
+int hudScore = -1;
+int hudDeaths = -1;
 
 /**
     This is the main function. Its starts things and stuff.
@@ -63,11 +127,51 @@ ObjectList* alienShots;
 */
 int main(int argc, char** argv)
 {
-	// Initialize GLUT
+	// Initialize GLUT (this eats any GLUT arguments)
 	glutInit(&argc, argv);
+
+	// Read our own arguments
+	WorldConfig config;
+	defaultWorldConfig(&config);
+	config.seed = (uint64_t)time(NULL);
+	bool soft = false;
+	int rasterThreads = -1;
+	const char* capturePath = NULL;
+	for (int i = 1; i < argc; i++){
+		// Pick how many times a second the game is ticked
+		if (strncmp(argv[i], "--hz=", 5) == 0)
+			config.tickRate = atoi(argv[i] + 5);
+		// Pick the seed for the match, otherwise every launch is a different game
+		else if (strncmp(argv[i], "--seed=", 7) == 0)
+			config.seed = strtoull(argv[i] + 7, NULL, 10);
+		// Pick how many times a second the game is drawn
+		else if (strncmp(argv[i], "--fps=", 6) == 0)
+			frameRate = atoi(argv[i] + 6);
+		// Record every tick's input so the game can be played back later
+		else if (strncmp(argv[i], "--record=", 9) == 0)
+			recordingPath = argv[i] + 9;
+		// Stream a trace of every tick and frame to a file
+		else if (strncmp(argv[i], "--trace=", 8) == 0){
+			if (startTrace(argv[i] + 8)){
+				traceNameThread("game");
+				atexit(finishTrace);
+			}
+			else fprintf(stderr, "Could not start a trace in %s\n", argv[i] + 8);
+		}
+		// Draw on the CPU instead of the GPU, for machines without one
+		else if (strcmp(argv[i], "--soft") == 0)
+			soft = true;
+		// Pick how many worker threads the software rasterizer shades with
+		else if (strncmp(argv[i], "--threads=", 10) == 0)
+			rasterThreads = atoi(argv[i] + 10);
+		// Capture every frame drawn to a video
+		else if (strncmp(argv[i], "--capture=", 10) == 0)
+			capturePath = argv[i] + 10;
+	}
+
 	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
 	// Set the window size
-	glutInitWindowSize(800, 800);
+	glutInitWindowSize(WINDOW_SIZE, WINDOW_SIZE);
 
 	// Create a window
 	glutCreateWindow("Derek Batts - CSC 461 - Assignment 4");
@@ -89,27 +193,59 @@ int main(int argc, char** argv)
 	glutAddMenuEntry("Restart Game", 1);
 	glutAttachMenu(GLUT_RIGHT_BUTTON);
 
-	// Set the update function (main game loop)
-	glutTimerFunc(25, update, 0);
+	// Check for frames to draw
+	if (frameRate < 1)
+		frameRate = DEFAULT_FRAME_RATE;
+	glutTimerFunc(1000 / frameRate, checkForFrame, 0);
 
 	// Enable backface stuff
 	glEnable(GL_CULL_FACE);
 	glCullFace(GL_BACK);
 
-	p = initPlayer();
-	// Create lists of stuff
-	asteroids = createList();
-	explosions = createList();
-	initAsteroidList(asteroids);
-	playerShots = createList();
-	aliens = createList();
-	alienShots = createList();
-
-	// Setup player ship
-	p->positionVector[X_] = -3.0f;
-	p->positionVector[Y_] = 0.0f;
-	p->positionVector[Z_] = -14.0f;
-	p->orientation[Y_] = 1.0f;
+	// Create the world and start a new game in it
+	world = createWorld(&config);
+	// Unless told to draw in software, find the newer GL functions and set up the GPU side of drawing
+	if (!soft){
+		if (loadGLFunctions(getGLFunction))
+			renderer = createRenderer(world);
+		if (renderer != NULL)
+			textRenderer = createTextRenderer(TEXT_MAX_GLYPHS);
+		// Without them the game can still be drawn on the CPU
+		else {
+			fprintf(stderr, "Drawing in software instead (as with --soft)\n");
+			soft = true;
+		}
+	}
+	// Drawing in software only needs GL to put the finished frame in the window
+	if (soft)
+		raster = createRasterizer(WINDOW_SIZE, WINDOW_SIZE, rasterThreads);
+	// Start capturing, frames are only captured while the window is the size it started at
+	if (capturePath != NULL){
+		capture = startCapture(capturePath, WINDOW_SIZE, WINDOW_SIZE, frameRate);
+		if (capture != NULL){
+			if (raster == NULL)
+				reader = createFrameReader(WINDOW_SIZE, WINDOW_SIZE);
+			atexit(finishCapture);
+		}
+		else fprintf(stderr, "Could not start a capture in %s\n", capturePath);
+	}
+	// Time every tick and every frame, the overlay can be toggled on at any point
+	tickProfiler = createProfiler();
+	drawProfiler = createProfiler();
+	world->profiler = tickProfiler;
+	tickSeconds = 1.0 / world->tickRate;
+	// Start recording, the file gets written however the game ends
+	if (recordingPath != NULL){
+		recording = createReplay(world->seed, world->tickRate);
+		atexit(saveRecording);
+	}
+	// Start the simulation on its own thread, it is stopped before anything else at exit
+	scenes = createSceneBuffer(world);
+	blended = createScene(world);
+	commands = createCommandBuffer(world);
+	simRunning.store(true);
+	simThread = thread(simulate);
+	atexit(stopSimulation);
 
 	// Start the glut main loop. glutMainLoop does not return :(
 	glutMainLoop();
@@ -128,258 +264,79 @@ void initRendering()
 }
 
 /*
-	This function is called to update object in the game world and acts as our
-	main game loop.
-	@param value I have no idea.
+	This function runs the world on its own thread and acts as our main game loop. It runs
+	fixed length ticks for however much real time has passed, so the game runs at the same
+	speed no matter how long drawing takes, and hands a scene of each batch of ticks to drawScene
+	(with where everything was the tick before, so drawScene can blend between them).
  */
-void update(int value)
+void simulate()
 {
-	// Check if we can spawn a new alien
-	if ((alienTimer <= 0) && (asteroids->size < 10) && (aliens->size <= 4)){
-		// Get ready to spawn a new alien
-		Alien* newAlien = NULL;
-
-		// Spawn a larger alien if this is the first alien of the screen / level
-		if (!firstSpawned){
-			newAlien = initAlienShip(true);
-			firstSpawned = true;
-		}
-		// Check if the lifetime score will let us spawn a small alien
-		else if (lifetimeScore >= ALIEN_SMALL_SPAWN_REQ)
-			newAlien = initAlienShip(rand() % 2);
-		// Otherwise spawn a big alien
-		else newAlien = initAlienShip(true);
-
-		// Add the alien to the lists
-		addToList(newAlien, aliens);
-		alienTimer = ALIEN_SPAWN_TIME;
-	}
-	// Decrement the timer for alien spawn
-	else if (alienTimer > 0)
-		alienTimer--;
-
-	// Update all the aliens
-	for (ObjectNode* node = aliens->head; node != NULL;){
-		// Check if the alien as run its course as we update it
-		if (updateAlien((Alien*)node->value)){
-			// Remove the alien
-			Alien* a = (Alien*)node->value;
-			ObjectNode* temp = node;
-			node = node->next;
-			if (removeFromList(temp->value, aliens))
-				free(a);
-		}
-		// Otherwise try to make the alien shoot a missle
-		else {
-			alienShoot((Alien*)node->value, asteroids, p, alienShots);
-			node = node->next;
-		}
-	}
-
-	// Update each asteroid
-	for (ObjectNode* a = asteroids->head; a != NULL; a = a->next)
-		updateAsteroid((Asteroid*) a->value);
-
-	// Update explosions
-	for (ObjectNode* node = explosions->head; node != NULL;){
-		Explosion* e = (Explosion*) node->value;
-		// Check age
-		if (e->age >= EXPLOSION_MAX_AGE){
-			node = node->next;
-			// Remove if it has reached its limit
-			if (removeFromList(e, explosions))
-				free(e);
-		}
-		else {
-			updateExplosion(e);
-			node = node->next;
-		}
-	}
-
-	// Update the player ship
-	updatePlayer(p);
-
-	// Loop through all the current player missles
-	for (ObjectNode* node = playerShots->head; node != NULL;){
-		// Update each missle
-		Missle* m = (Missle*)node->value;
-		updateMissle(m);
-		// Increment the remove counter if we find an old missle
-		if (m->age >= MISSLE_AGE_MAX){
-			Missle* temp = m;
-			node = node->next;
-			removeFromList(temp, playerShots);
-		}
-		else node = node->next;
-	}
-
-	// Loop through all the current alien missles and update them
-	for (ObjectNode* node = alienShots->head; node != NULL;){
-		Missle* m = (Missle*)node->value;
-		updateMissle(m);
-		if (m->age >= MISSLE_AGE_MAX){
-			Missle* temp = m;
-			node = node->next;
-			removeFromList(temp, alienShots);
-		}
-		else node = node->next;
-	}
-
-	// Loop through all the alien missle again
-	for (ObjectNode* node = alienShots->head; node != NULL;){
-		// Check if a missle collides with the player
-		if (detectCollidePlayerShot(p, (Missle*)node->value)){
-			// Decrement the deaths left counter
-			p->deathsLeft--;
-			Missle* m = (Missle*)node->value;
-			node = node->next;
-			// Handle the collision
-			handleCollidePlayerShot(p, alienShots, m, explosions);
-			break;
-		}
-		else node = node->next;
-	}
-
-	// Loop through each asteroid in our list
-	for (ObjectNode* node = asteroids->head; node != NULL;){
-		bool changed = false;
-		Asteroid* a = (Asteroid*) node->value;
-		// Check if it collides with the player
-		if (detectCollideAsteroidShip(a, p)){
-			node = node->next;
-			changed = true;
-			handleCollideAsteroidShip(asteroids, a, p, explosions);
-			p->deathsLeft--;
+	if (traceEnabled())
+		traceNameThread("simulation");
+	// Start the clock
+	lastTime = chrono::steady_clock::now();
+	while (simRunning.load(memory_order_relaxed)){
+		// Bank however much real time has passed since we last looked
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		accumulator += chrono::duration<double>(now - lastTime).count();
+		lastTime = now;
+
+		// Run a tick for every full tick of time we have banked
+		int ran = 0;
+		while ((accumulator >= tickSeconds) && (ran < MAX_CATCHUP_TICKS)){
+			// Step the world with whatever keys are down (or were tapped) since the last tick
+			unsigned int input = heldKeys.load(memory_order_relaxed) | pressedKeys.exchange(0, memory_order_relaxed);
+			if (recording != NULL)
+				replayRecord(recording, input);
+			rememberTick(scenes, world);
+			stepWorld(world, input);
+			accumulator -= tickSeconds;
+			ran++;
 		}
-		else if (!changed){
-			// Check for collisions between aliens and asteroids
-			for (ObjectNode* alienNode = aliens->head; (alienNode != NULL) && !changed; alienNode = alienNode->next){
-				if (detectCollideAsteroidAlien(a, (Alien*)alienNode->value)){
-					changed = true;
-					node = node->next;
-					Alien* alien = (Alien*) alienNode->value;
-					handleCollideAsteroidAlien(asteroids, a, aliens, alien, explosions);
-					break;
-				}
-			}
-			// Loop through each missle in our list of player missles
-			for (ObjectNode* missleNode = playerShots->head; (missleNode != NULL) && (node != NULL) && !changed;){
-				a = (Asteroid*)node->value;
-				Missle* m = (Missle*)missleNode->value;
-				// Check if the missle collides with the asteroid
-				if (detectCollideAsteroidShot(a, m)){
-					Missle* temp = m;
-					missleNode = missleNode->next;
-					// Calculate score for the player
-					int score = 0;
-					if (a->age == 2)
-						score = 20;
-					else if (a->age == 1)
-						score = 50;
-					else if (a->age == 0)
-						score = 100;
-					p->score += score;
-					lifetimeScore += score;
-					node = node->next;
-					changed = true;
-					handleCollideAsteroidShot(asteroids, a, playerShots, temp, explosions);
-
-					break;
-				}
-				else missleNode = missleNode->next;
-			}
-			// Check all alien shots
-			for (ObjectNode* missleNode = alienShots->head; (missleNode != NULL) && (node != NULL) && !changed;){
-				a = (Asteroid*)node->value;
-				Missle* m = (Missle*)missleNode->value;
-				// Check if the missle collides with the asteroid
-				if (detectCollideAsteroidShot(a, m)){
-					Missle* temp = m;
-					missleNode = missleNode->next;
-					node = node->next;
-					changed = true;
-					handleCollideAsteroidShot(asteroids, a, alienShots, temp, explosions);
-
-					break;
-				}
-				else missleNode = missleNode->next;
-			}
-		}
-		// Check if a collision happened
-		if (!changed && (node != NULL))
-			node = node->next;
-	}
-
-	// Loop through all the aliens
-	for (ObjectNode* alienNode = aliens->head; alienNode != NULL;){
-		bool changed = false;
-		Alien* a = (Alien*)alienNode->value;
-		// Check if the player and alien collide
-		if (detectCollideAlienPlayer(a, p)){
-			changed = true;
-			alienNode = alienNode->next;
-			// Handle the collision and update the player's deaths left
-			handleCollideAlienPlayer(aliens, a, p, explosions);
-			p->deathsLeft--;
-		}
-		if (!changed){
-			// Check if player shots hit the aliens
-			for (ObjectNode* missleNode = playerShots->head; (missleNode != NULL) && !changed && (alienNode != NULL);){
-				if (detectCollideAlienShot(a, (Missle*)missleNode->value)){
-					changed = true;
-					Missle* m = (Missle*)missleNode->value;
-					missleNode = missleNode->next;
-					alienNode = alienNode->next;
-
-					// Calculate score
-					int score = 0;
-					if (a->isBig)
-						score = 200;
-					else score = 1000;
-					p->score += score;
-					lifetimeScore += score;
-					
-					// Handle the collision
-					handleCollideAlienShot(aliens, a, playerShots, m, explosions);
-
-					break;
-				}
-				else missleNode = missleNode->next;
-			}
-		}
-		// Check if anything happened
-		if (!changed && (alienNode != NULL))
-			alienNode = alienNode->next;
+		// If we are still behind we hitched (or were paused), so drop the time instead of spiraling
+		if (accumulator >= tickSeconds)
+			accumulator = 0.0;
+
+		// Hand over what the world looks like now (the newest tick was due however much banked time ago)
+		if (ran > 0)
+			publishScene(scenes, world, profileNow() - (int64_t)(accumulator * 1e9));
+		// Then sleep until the next tick is due (counting from when we looked, not from now)
+		chrono::duration<double> untilTick(tickSeconds - accumulator);
+		this_thread::sleep_until(now + chrono::duration_cast<chrono::steady_clock::duration>(untilTick));
 	}
+}
 
-	// See if the player has scored enough for a new life
-	if (p->score >= NEW_LIFE_REQ){
-		p->score -= NEW_LIFE_REQ;
-		p->deathsLeft++;
-	}
+/*
+	This function stops the simulation thread, it is run when the program exits
+	(before the recording is saved, so the recording is not written to while it is saved).
+ */
+void stopSimulation()
+{
+	simRunning.store(false);
+	if (simThread.joinable())
+		simThread.join();
+}
 
-	// Check for no asteroids
-	if (asteroids->size == 0){
-		// Reset game
-		if(num_asteroids < MAX_NUM_ASTEROIDS)
-			num_asteroids++;
-		initAsteroidList(asteroids);
-		p->positionVector[X_] = PLAYER_INIT_POSX;
-		p->positionVector[Y_] = PLAYER_INIT_POSY;
-		p->spin = 0.0f;
-		clearList(playerShots);
-		clearList(alienShots);
-		clearList(aliens);
-		alienTimer = ALIEN_SPAWN_TIME;
-		firstSpawned = false;
+/*
+	This function asks for a frame to be drawn whenever one is due, then sleeps until the next one
+	is. Frames are drawn at the frame rate no matter how fast the world ticks, since each one is
+	blended between the last two ticks.
+	@param value I have no idea.
+ */
+void checkForFrame(int value)
+{
+	int64_t now = profileNow();
+	int64_t frameTime = 1000000000LL / frameRate;
+	if ((now - lastFrame) >= frameTime){
+		// Keep to the frame rate's schedule, unless we fell a whole frame behind
+		lastFrame += frameTime;
+		if ((now - lastFrame) >= frameTime)
+			lastFrame = now;
+		glutPostRedisplay();
 	}
-	// See if the player is out of lives
-	if (p->deathsLeft <= -1)
-		restartGame();
-
-	// Redraw and wait again
-	glutPostRedisplay();
-	glutTimerFunc(25, update, 0);
+	// Wake up when the next frame is due (timers only count whole ms, so round up)
+	int64_t wait = (lastFrame + frameTime - now + 999999) / 1000000;
+	glutTimerFunc((wait > LOOP_MIN_WAIT_MS) ? (unsigned int)wait : LOOP_MIN_WAIT_MS, checkForFrame, 0);
 }
 
 /*
@@ -387,185 +344,212 @@ void update(int value)
 */
 void drawScene()
 {
+	// Time each pass of the frame
+	ProfileTimer timer;
+	profileBeginFrame(drawProfiler);
+	startProfileTimer(&timer, drawProfiler);
+	int64_t frameStart = timer.last;
+
 	glEnable(GL_LIGHTING);
-	// Clear information from the last draw
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	// Clear information from the last draw (the software rasterizer covers every pixel itself)
+	if (raster == NULL)
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	// Switch to the drawing perspective
 	glMatrixMode(GL_MODELVIEW);
 	// Reset the perspective
 	glLoadIdentity();
 
-	
-	// Loop through all the alien ships
-	for (ObjectNode* node = aliens->head; node != NULL; node = node->next){
-		// Save the matrix state
-		glPushMatrix();
-			// Get the next alien
-			Alien* a = (Alien*)node->value;
-			// Move and rotate to it
-			glTranslatef(a->positionVector[X_], a->positionVector[Y_], a->positionVector[Z_]);
-			glRotatef(90, 1.0f, 0.0f, 0.0f);
-			glRotatef(a->spin, a->orientation[X_], a->orientation[Y_], a->orientation[Z_]);
-			// Set its material
-			glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, a->mat);
-			// Draw the alien ship with a torus and a sphere, making a saturn-y looking thing
-			glutSolidSphere(a->sphereRadius, a->sphereSlices, a->sphereStacks);
-			glutSolidTorus(a->torusInnerRadius, a->torusOuterRadius, a->torusSides, a->torusRings);
-		// Reload matrix state
-		glPopMatrix();
+	// Grab the newest tick the simulation has handed over (it will not change while we draw it),
+	// and blend it by how far we are between that tick and the next one
+	const Scene* latest = latestScene(scenes);
+	interpolateScene(latest, sceneAlpha(latest, profileNow()), blended);
+	const Scene* scene = blended;
+	profileLap(&timer, PHASE_DRAW_BLEND);
+
+	// Turn everything in it into draw commands, sorted so each mesh set and point size is drawn once
+	buildCommands(commands, scene);
+	profileLap(&timer, PHASE_DRAW_BUILD);
+
+	// Draw them all, or set them up to be shaded on the CPU
+	if (raster != NULL){
+		beginRaster(raster);
+		rasterCommands(raster, commands);
 	}
-	
-
-	// Loop through all the asteroids
-	for (ObjectNode* node = asteroids->head; node != NULL; node = node->next){
-		// Save matrix state for each asteroid
-		glPushMatrix();
-		Asteroid* a = (Asteroid*) node->value;
-			// Move to the asteroids position
-			glTranslatef(a->positionVector[X_], a->positionVector[Y_], a->positionVector[Z_]);
-			// Rotate to the asteroids orientation
-			glRotatef(a->spin, a->orientation[X_], a->orientation[Y_], a->orientation[Z_]);
-			// Scale to the asteroid's size
-			glScalef(a->scale[X_], a->scale[Y_], a->scale[Z_]);
-			// Use the asteroids material
-			glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, a->mat);
-			// Draw all the triangles in the asteroid
-			glBegin(GL_TRIANGLES);
-			for (int j = 0; (j + 2) < a->numVerticies; j += 3){
-				// Draw each triangle and its normal
-				for (int k = 0; k < 3; k++){
-					glNormal3fv(a->normals[j / 3]);
-					glVertex3fv(a->verticies[j + k]);
-				}
-			}
-			glEnd();
-		glPopMatrix();
-	}
-
-	// Save the matrix before we draw the player ship
-	glPushMatrix();
-		// Move to the players position
-		glTranslatef(p->positionVector[X_], p->positionVector[Y_], p->positionVector[Z_]);
-		// Rotate the ship back on the X axis (make it look flat)
-		glRotatef(90.0f, 1.0f, 0.0f, 0.0f);
-		// Rotate on the Y axis (point it to the right)
-		glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-		// Rotate the ship to its orientation
-		glRotatef(p->spin, p->orientation[X_], p->orientation[Y_], p->orientation[Z_]);
-		// Scale the ship to be smaller
-		glScalef(p->scale[X_], p->scale[Y_], p->scale[Z_]);
-		// Draw all the triangles in the player ship
-		glBegin(GL_TRIANGLES);
-		// Set the material
-		glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, p->mat);
-		for (int i = 0; (i + 2) < p->numVerticies;  i += 3){
-			// Draw each triangle and its normal
-			for (int j = 0; j < 3; j++){
-				glNormal3fv(p->normals[i / 3]);
-				glVertex3fv(p->verticies[i + j]);
-			}
-		}
-		glEnd();
-	glPopMatrix();
+	else drawCommands(renderer, commands);
+	profileLap(&timer, PHASE_DRAW_SUBMIT);
 
-	// Disable lighting for drawing points and text
+	// Disable lighting for drawing text
 	glDisable(GL_LIGHTING);
-	// Setup for drawing missles
-	glPointSize(MISSLE_SIZE);
-
-	// Draw all the players missles
-	for (ObjectNode* node = playerShots->head; node != NULL; node = node->next){
-		// Save the matrix
-		glPushMatrix();
-			// Get the current missle
-			Missle* m = (Missle*) node->value;
-			// Set its color
-			glColor3f(0, 1, 1);
-			// Draw the point and its normal
-			glBegin(GL_POINTS);
-			glVertex3f(m->positionVector[X_], m->positionVector[Y_], m->positionVector[Z_]);
-			glEnd();
-		glPopMatrix();
+	// Only write the score line again when something on it has changed
+	if ((scene->score != hudScore) || (scene->deathsLeft != hudDeaths)){
+		snprintf(hudText, sizeof(hudText), "SCORE: %d    DEATHS LEFT: %d", scene->score, scene->deathsLeft);
+		hudScore = scene->score;
+		hudDeaths = scene->deathsLeft;
 	}
-
-	// Draw all the alien missles
-	for (ObjectNode* node = alienShots->head; node != NULL; node = node->next){
-		// Save the matrix
-		glPushMatrix();
-			// Get the current missle
-			Missle* m = (Missle*)node->value;
-			// Set its color
-			glColor3f(1, 0, 0);
-			// Draw the point and its normal
-			glBegin(GL_POINTS);
-			glVertex3f(m->positionVector[X_], m->positionVector[Y_], m->positionVector[Z_]);
-			glEnd();
-		glPopMatrix();
+	// Queue the score and the overlay, then draw all of it at once
+	const unsigned char white[] = { 255, 255, 255, 255 };
+	if (raster == NULL)
+		beginText(textRenderer);
+	queueText(-5.0f, 5.0f, hudText, HUD_TEXT_SCALE, white);
+	if (showOverlay)
+		drawOverlay();
+	if (raster == NULL)
+		endText(textRenderer);
+	profileLap(&timer, PHASE_DRAW_HUD);
+
+	// Shade the software frame and put it in the window
+	if (raster != NULL){
+		presentRaster();
+		profileLap(&timer, PHASE_DRAW_SHADE);
 	}
 
-	// Setup for drawing explody bits
-	glPointSize(EXPLOSION_PT_SIZE);
-
-	// Draw all the explosions
-	for (ObjectNode* e = explosions->head; e != NULL; e = e->next){
-		// Save the matrix
-		glPushMatrix();
-			// Get the explosion
-			Explosion* exp =  (Explosion*) e->value;
-			// Set color and move to the explosion
-			glColor3f(1, 1, 1);
-			glTranslatef(exp->positionVector[X_], exp->positionVector[Y_], exp->positionVector[Z_]);
-			// Draw all the points
-			glBegin(GL_POINTS);
-			for (int i = 0; i < EXPLOSION_NUM_PTS; i++)
-				glVertex3f(exp->points[i][X_], exp->points[i][Y_], exp->points[i][Z_]);
-			glEnd();
-
-		glPopMatrix();
+	// Hand the finished frame to the capture, straight from memory or read back off the GPU
+	if (capture != NULL){
+		if (raster != NULL)
+			captureFrame(capture, raster->color, raster->width, raster->height, raster->stride);
+		else readFrame(reader, capture, windowWidth, windowHeight);
+		profileLap(&timer, PHASE_DRAW_CAPTURE);
 	}
 
-	// Draw text
-	glPushMatrix();
-		glColor3f(1, 1, 1);
-		// Make buffers for drawing text
-		char numberBuffer[32];
-		char text[512] = {};
-		// Add the score label
-		strcat(text, "SCORE: ");
-		// Convert the player's score to text and add it onto the string
-		itoa(p->score, numberBuffer, 10);
-		strcat(text, numberBuffer);
-
-		// Add the deaths left label
-		strcat(text, "    DEATHS LEFT: ");
-		// Be good and clear the buffer
-		for (int i = 0; i < 32; i++)
-			numberBuffer[i] = '\0';
-		// Convert the player's deaths left to text and add it onto the string
-		itoa(p->deathsLeft, numberBuffer, 10);
-		strcat(text, numberBuffer);
-
-		// Draw the string
-		drawText(-5.0, 5.0, Z_LEVEL, text);
-	glPopMatrix();
-
 	glFlush();
 	//Send the 3D scene to the window
 	glutSwapBuffers();
+	profileLap(&timer, PHASE_DRAW_SWAP);
+
+	// Finish timing the frame
+	profileSpan(&timer, PHASE_DRAW, frameStart);
+	profileEndFrame(drawProfiler);
 }
 
 /*
-	This is a simple function for drawing text to the window.
-	@param x The x co-ordinate for where we should start drawing.
-	@param y The y co-ordinate for where we should start drawing.
-	@param z The z depth co-ordinate for where we should draw.
+	This function queues the profiler overlay, the mean, 99th percentile, and max time of every
+	phase of the last few hundred ticks and frames, plus how much was in the world last tick.
+	It is drawn along with the score.
+ */
+void drawOverlay()
+{
+	static ProfileFrame frames[PROFILE_HISTORY];
+	ProfileStats stats[NUM_PHASES];
+	char line[128];
+	float y = 4.6f;
+
+	// Draw in a dim yellow so it stands out from the score
+	const unsigned char yellow[] = { 255, 255, 102, 255 };
+	queueText(-5.0f, y, "PHASE               MEAN    P99    MAX (us)", 1, yellow);
+	y -= OVERLAY_LINE_HEIGHT;
+
+	// Summarize the ticks, then the frames
+	for (int pass = 0; pass < 2; pass++){
+		Profiler* profiler = (pass == 0) ? tickProfiler : drawProfiler;
+		int first = (pass == 0) ? PHASE_TICK : PHASE_FIRST_DRAW;
+		int last = (pass == 0) ? PHASE_FIRST_DRAW : NUM_PHASES;
+		int count = profileHistory(profiler, frames);
+		profileSummarize(frames, count, stats);
+		for (int phase = first; phase < last; phase++){
+			snprintf(line, sizeof(line), "%-17s %6.1f %6.1f %6.1f", phaseNames[phase],
+				stats[phase].mean / 1000.0f, stats[phase].p99 / 1000.0f, stats[phase].max / 1000.0f);
+			queueText(-5.0f, y, line, 1, yellow);
+			y -= OVERLAY_LINE_HEIGHT;
+		}
+
+		// After the ticks show what was in the world for the newest one
+		if ((pass == 0) && (count > 0)){
+			for (int counter = 0; counter < NUM_COUNTERS; counter++){
+				snprintf(line, sizeof(line), "%-17s %6u", counterNames[counter], frames[count - 1].counters[counter]);
+				queueText(-5.0f, y, line, 1, yellow);
+				y -= OVERLAY_LINE_HEIGHT;
+			}
+		}
+	}
+}
+
+/*
+	This function queues a string of HUD text with whichever renderer is drawing the frame.
+	@param x The x co-ordinate of where the string starts.
+	@param y The y co-ordinate of where the string starts.
 	@param string The string to draw.
+	@param scale How many pixels wide and tall each pixel of the font is drawn.
+	@param color The color to draw the string in.
+ */
+void queueText(float x, float y, const char* string, int scale, const unsigned char color[4])
+{
+	if (raster != NULL)
+		addRasterText(raster, x, y, Z_LEVEL, string, scale, color);
+	else addText(textRenderer, x, y, Z_LEVEL, string, scale, color);
+}
+
+/*
+	This function shades the software rasterizer's frame and copies it into the window in one go.
+ */
+void presentRaster()
+{
+	finishRaster(raster);
+
+	// Put the raster position at the bottom left corner of the window
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glPushAttrib(GL_ENABLE_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glRasterPos2f(-1.0f, -1.0f);
+
+	// The frame's rows are padded out to whole tiles
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, raster->stride);
+	glDrawPixels(raster->width, raster->height, GL_RGBA, GL_UNSIGNED_BYTE, raster->color);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+	// Put everything back the way it was
+	glPopAttrib();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+}
+
+/*
+	This function writes the recording to disk, it is run when the program exits.
  */
-void drawText(float x, float y, float z, char* string)
+void saveRecording()
 {
-	glRasterPos3f(x, y, z);
-	for (char* p = string; *p != '\0'; p++)
-		glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *p);
+	if (!saveReplay(recording, recordingPath))
+		fprintf(stderr, "Could not save the recording to %s\n", recordingPath);
+	destroyReplay(recording);
+	recording = NULL;
+}
+
+/*
+	This function finishes the trace, it is run when the program exits.
+ */
+void finishTrace()
+{
+	uint64_t dropped = stopTrace();
+	if (dropped > 0)
+		fprintf(stderr, "The trace dropped %llu events\n", (unsigned long long)dropped);
+}
+
+/*
+	This function writes out the rest of the capture and closes it, it is run when the program exits.
+ */
+void finishCapture()
+{
+	uint64_t dropped = stopCapture(capture, NULL);
+	capture = NULL;
+	if (dropped > 0)
+		fprintf(stderr, "The capture dropped %llu frames\n", (unsigned long long)dropped);
+}
+
+/*
+	This function finds a GL function by name through GLUT.
+	@param name The name of the function.
+	@return A pointer to the function, or NULL if the driver does not have it.
+ */
+void* getGLFunction(const char* name)
+{
+	return (void*)glutGetProcAddress(name);
 }
 
 /*
@@ -579,8 +563,8 @@ void handle_menu(int ID)
 		// Leave if the Quit entry is clicked
 		exit(0);
 	case 1:
-		// Restart the game
-		restartGame();
+		// Restart the game on the next tick
+		pressedKeys.fetch_or(INPUT_RESTART);
 		break;
 	}
 }
@@ -594,12 +578,17 @@ void handleResize(int w, int h)
 {
 	// Tell OpenGL how to convert from coordinates to pixel values
 	glViewport(0, 0, w, h);
+	windowWidth = w;
+	windowHeight = h;
 	// Switch to setting camera perspective
 	glMatrixMode(GL_PROJECTION);
 	// Set the camera perspective
 	glLoadIdentity();
 	// Pass in camera angle, width-to-height ratio, the near z clipping coordinate, and the far z clipping coordinate
-	gluPerspective(45.0, (double) w /(double) h, 1.0, 200.0);
+	gluPerspective(RASTER_FOV, (double) w /(double) h, RASTER_NEAR, RASTER_FAR);
+	// The software rasterizer draws a frame the size of the window with the same camera
+	if (raster != NULL)
+		resizeRasterizer(raster, w, h);
 
 }
 
@@ -611,29 +600,25 @@ void handleResize(int w, int h)
 */
 void handleKeypress(unsigned char key, int x, int y)
 {
-	Missle* newM = NULL;
 	switch (key)
 	{
 		// Exit on escape press
 	case 27:
 		exit(EXIT_SUCCESS);
-		// Set the X flag in the objects module
+		// Hold down thrust
 	case 'x':
-		setKeyX(true);
-		break;
 	case 'X':
-		setKeyX(true);
+		heldKeys.fetch_or(INPUT_THRUST);
 		break;
-		// Try to fire a shot and add it to the queue
+		// Try to fire a shot on the next update
 	case'z':
-		newM = fireShot(p);
-		if (newM != NULL)
-			addToList(newM, playerShots);
-		break;
 	case'Z':
-		newM = fireShot(p);
-		if (newM != NULL)
-			addToList(newM, playerShots);
+		pressedKeys.fetch_or(INPUT_FIRE);
+		break;
+		// Show or hide the profiler overlay
+	case 'p':
+	case 'P':
+		showOverlay = !showOverlay;
 		break;
 	}
 }
@@ -648,12 +633,10 @@ void handleKeyRelease(unsigned char key, int x, int y)
 {
 	switch (key)
 	{
-		// Unset the X flag in the objects module
+		// Let go of thrust
 	case 'x':
-		setKeyX(false);
-		break;
 	case 'X':
-		setKeyX(false);
+		heldKeys.fetch_and(~INPUT_THRUST);
 		break;
 	}
 }
@@ -668,13 +651,13 @@ void handleSpecialPress(int key, int x, int y)
 {
 	switch (key)
 	{
-		// Set the flag for a right keypress in the objects module
+		// Hold down turning left
 	case GLUT_KEY_LEFT:
-		setKeyLeft(true);
+		heldKeys.fetch_or(INPUT_LEFT);
 		break;
-		// Set the flag for a left keypress in the objects module
+		// Hold down turning right
 	case GLUT_KEY_RIGHT:
-		setKeyRight(true);
+		heldKeys.fetch_or(INPUT_RIGHT);
 		break;
 	}
 }
@@ -689,13 +672,13 @@ void handleSpecialRelease(int key, int x, int y)
 {
 	switch (key)
 	{
-		// Unset the flag for a left keypress in the objects module
+		// Let go of turning left
 	case GLUT_KEY_LEFT:
-		setKeyLeft(false);
+		heldKeys.fetch_and(~INPUT_LEFT);
 		break;
-		// Unset the flag for a right keypress in the objects module
+		// Let go of turning right
 	case GLUT_KEY_RIGHT:
-		setKeyRight(false);
+		heldKeys.fetch_and(~INPUT_RIGHT);
 		break;
 	}
 }
@@ -739,82 +722,3 @@ void initLighting()
 	glClearDepth(1.0);
 	glClearColor(0, 0, 0, 0);
 }
-
-/*
-	This function initializes a given array of asteroids randomly according to the specified rules.
-	@param a The reference to an array of Asteroid pointers.
-*/
-void initAsteroidList(ObjectList* list)
-{
-	// Loop through the whole array
-	for (int i = 0; i < num_asteroids; i++){
-		// Create an asteroid
-		Asteroid* a = initAsteroid();
-
-		// Randomly set its spin
-		a->spin = (float) (rand() % 90);
-		// Randomly set the spin factor
-		GLfloat spinFactor;
-		for (spinFactor = 100.0f; (spinFactor < -2.0) || (spinFactor > 2.0) || (spinFactor == -0.0f) || (spinFactor == 0.0f); spinFactor = (float)-1 * (rand() % 2) * ((float)3 / (rand() % 15)));
-			a->spinFactor = spinFactor;
-		
-		// Randomly generate and set scale
-		GLfloat scale;
-		for (scale = 0.0f; (scale < 0.4f) || (scale > 0.9f); scale = (float)1 / (rand() % 10));
-		for (int j = 0; j < 3; j++)
-			a->scale[j] = scale;
-
-		// Randomly pick an axis to spin about
-		a->orientation[rand() % 3] = 1.0f;
-
-		for (int j = 0; j < 2; j++){
-			// Randomly generate a velocity
-			GLfloat vel;
-			for (vel = 0.0f; (vel < -0.06f) || (vel > 0.06f) || (vel == 0.0f) || (vel == -0.0f); vel = (float)1 / (10 + (25 + rand() % 100)));
-			
-			// Alternal direction
-			if (i < (num_asteroids / 2))
-				a->vVector[j] = vel;
-			else
-				a->vVector[j] = -vel;
-
-			// Randomly generate a starting position
-			GLfloat pos;
-			for (pos = -10.f; (pos < -6.0f) || (pos > 6.0f) || (pos == -0.00); pos = (float)-1 * (rand() % 2) * (rand() % 7));
-			a->positionVector[j] = pos;
-		}
-		// Set the Z value
-		a->positionVector[Z_] = Z_LEVEL;
-
-		addToList(a, list);
-	}
-}
-
-/*
-	This function restarts the game as if it had just been launched.
- */
-void restartGame()
-{
-	// Clear all the lists
-	clearList(asteroids);
-	clearList(playerShots);
-	clearList(explosions);
-	clearList(aliens);
-	clearList(alienShots);
-
-	// Reset the asteroid count and remake the list of asteroids
-	num_asteroids = 1;
-	initAsteroidList(asteroids);
-	
-	// Reset the player
-	p->positionVector[X_] = PLAYER_INIT_POSX;
-	p->positionVector[Y_] = PLAYER_INIT_POSY;
-	p->spin = 0.0f;
-	p->score = 0;
-	lifetimeScore = 0;
-	p->deathsLeft = PLAYER_DEATHS_INIT;
-
-	// Reset stuff for spawning alienss
-	alienTimer = ALIEN_SPAWN_TIME;
-	firstSpawned = false;
-}
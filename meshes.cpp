@@ -0,0 +1,269 @@
+#include <stdlib.h>
+#include <math.h>
+#include "meshes.h"
+
+/*
+	@file meshes.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file builds every mesh the game draws. The asteroid shapes come from objects.cpp,
+	the alien ships are tessellated here the way glutSolidSphere and glutSolidTorus do it, and
+	the player's ship is the spaceShip triangles. Every triangle gets one flat normal.
+ */
+
+//Because there is no pi in zmath :(
+#define PI 3.14159265f
+// How many points or indices a mesh library starts with room for
+#define LIBRARY_START_SIZE 256
+
+/*
+	This function adds a point or normal to a mesh library.
+	@param library A pointer to the library.
+	@param x The x co-ordinate.
+	@param y The y co-ordinate.
+	@param z The z co-ordinate.
+	@param w 1 for a point, 0 for a normal.
+ */
+static void addTexel(MeshLibrary* library, float x, float y, float z, float w)
+{
+	// Make more room if we are out
+	if (library->numTexels == library->texelCapacity){
+		library->texelCapacity *= 2;
+		library->texels = (float(*)[4])realloc(library->texels, library->texelCapacity * sizeof(float[4]));
+	}
+	float* texel = library->texels[library->numTexels++];
+	texel[0] = x;
+	texel[1] = y;
+	texel[2] = z;
+	texel[3] = w;
+}
+
+/*
+	This function adds a triangle to a mesh library.
+	@param library A pointer to the library.
+	@param v0 The first point of the triangle.
+	@param v1 The second point of the triangle.
+	@param v2 The third point of the triangle.
+ */
+static void addTriangle(MeshLibrary* library, int v0, int v1, int v2)
+{
+	// Make more room if we are out
+	if ((library->numIndices + 3) > library->indexCapacity){
+		library->indexCapacity *= 2;
+		library->indices = (unsigned short*)realloc(library->indices, library->indexCapacity * sizeof(unsigned short));
+	}
+	library->indices[library->numIndices++] = (unsigned short)v0;
+	library->indices[library->numIndices++] = (unsigned short)v1;
+	library->indices[library->numIndices++] = (unsigned short)v2;
+}
+
+/*
+	This function adds the normal of every triangle of a mesh to a library, the way calculateNormal finds them.
+	@param library A pointer to the library.
+	@param pointBase Where the mesh's points start.
+	@param indexBase Where the mesh's triangles start.
+ */
+static void addTriangleNormals(MeshLibrary* library, int pointBase, int indexBase)
+{
+	for (int i = indexBase; (i + 2) < library->numIndices; i += 3){
+		float v[3][3];
+		for (int k = 0; k < 3; k++){
+			for (int j = 0; j < 3; j++)
+				v[k][j] = library->texels[pointBase + library->indices[i + k]][j];
+		}
+		float normal[3];
+		calculateNormal(v[0], v[1], v[2], normal);
+		addTexel(library, normal[X_], normal[Y_], normal[Z_], 0.0f);
+	}
+}
+
+/*
+	This function builds every asteroid shape and adds them to a library.
+	@param library A pointer to the library.
+	@param set Where to describe the shapes.
+ */
+static void addAsteroidMeshes(MeshLibrary* library, MeshSet* set)
+{
+	AsteroidMesh* variants = (AsteroidMesh*)malloc(NUM_ASTEROID_VARIANTS * sizeof(AsteroidMesh));
+	buildAsteroidVariants(variants, ASTEROID_VARIANT_SEED);
+
+	// Every shape's points, then every shape's normals, all drawn with the sphere's triangles
+	set->pointBase = library->numTexels;
+	set->meshPoints = NUM_UNIQUE_SPH_PTS;
+	for (int v = 0; v < NUM_ASTEROID_VARIANTS; v++){
+		for (int i = 0; i < NUM_UNIQUE_SPH_PTS; i++)
+			addTexel(library, variants[v].verticies[i][X_], variants[v].verticies[i][Y_], variants[v].verticies[i][Z_], 1.0f);
+	}
+	set->normalBase = library->numTexels;
+	set->meshNormals = NUM_SPHERE_NORMS;
+	for (int v = 0; v < NUM_ASTEROID_VARIANTS; v++){
+		for (int i = 0; i < NUM_SPHERE_NORMS; i++)
+			addTexel(library, variants[v].normals[i][X_], variants[v].normals[i][Y_], variants[v].normals[i][Z_], 0.0f);
+	}
+	set->indexBase = library->numIndices;
+	for (int i = 0; i < NUM_SPHERE_VERTS; i += 3)
+		addTriangle(library, sphereIndices[i], sphereIndices[i + 1], sphereIndices[i + 2]);
+	set->numIndices = NUM_SPHERE_VERTS;
+	free(variants);
+}
+
+/*
+	This function adds a sphere to a library, tessellated the way glutSolidSphere does it (poles on the z axis).
+	@param library A pointer to the library.
+	@param first The first point of the mesh the sphere is part of.
+	@param radius The radius of the sphere.
+	@param slices How many times the sphere is cut around the z axis.
+	@param stacks How many times the sphere is cut along the z axis.
+ */
+static void addSphere(MeshLibrary* library, int first, float radius, int slices, int stacks)
+{
+	// The poles, with a ring of points for every cut between them
+	int top = library->numTexels - first;
+	addTexel(library, 0.0f, 0.0f, radius, 1.0f);
+	int rings = top + 1;
+	for (int i = 1; i < stacks; i++){
+		float phi = (PI * i) / stacks;
+		for (int j = 0; j < slices; j++){
+			float theta = (2.0f * PI * j) / slices;
+			addTexel(library, radius * sin(phi) * cos(theta), radius * sin(phi) * sin(theta), radius * cos(phi), 1.0f);
+		}
+	}
+	int bottom = library->numTexels - first;
+	addTexel(library, 0.0f, 0.0f, -radius, 1.0f);
+
+	// Fans at each pole and a band of quads between every two rings, all wound to face out
+	for (int j = 0; j < slices; j++){
+		int next = (j + 1) % slices;
+		addTriangle(library, top, rings + j, rings + next);
+		for (int i = 0; i < (stacks - 2); i++){
+			int a = rings + (i * slices) + j;
+			int b = rings + ((i + 1) * slices) + j;
+			int c = rings + ((i + 1) * slices) + next;
+			int d = rings + (i * slices) + next;
+			addTriangle(library, a, b, c);
+			addTriangle(library, a, c, d);
+		}
+		int last = rings + ((stacks - 2) * slices);
+		addTriangle(library, last + j, bottom, last + next);
+	}
+}
+
+/*
+	This function adds a torus to a library, tessellated the way glutSolidTorus does it (lying in the xy plane).
+	@param library A pointer to the library.
+	@param first The first point of the mesh the torus is part of.
+	@param innerRadius The radius of the tube.
+	@param outerRadius The distance from the center to the middle of the tube.
+	@param sides How many sides the tube has.
+	@param rings How many sections the tube is made of.
+ */
+static void addTorus(MeshLibrary* library, int first, float innerRadius, float outerRadius, int sides, int rings)
+{
+	// A ring of points around the tube at each section
+	int start = library->numTexels - first;
+	for (int j = 0; j < rings; j++){
+		float phi = (2.0f * PI * j) / rings;
+		for (int i = 0; i < sides; i++){
+			float theta = (2.0f * PI * i) / sides;
+			float distance = outerRadius + (innerRadius * cos(theta));
+			addTexel(library, distance * cos(phi), distance * sin(phi), innerRadius * sin(theta), 1.0f);
+		}
+	}
+
+	// A quad between each side of every two sections, wound to face out
+	for (int j = 0; j < rings; j++){
+		int nextRing = (j + 1) % rings;
+		for (int i = 0; i < sides; i++){
+			int nextSide = (i + 1) % sides;
+			int a = start + (j * sides) + i;
+			int b = start + (nextRing * sides) + i;
+			int c = start + (nextRing * sides) + nextSide;
+			int d = start + (j * sides) + nextSide;
+			addTriangle(library, a, b, c);
+			addTriangle(library, a, c, d);
+		}
+	}
+}
+
+/*
+	This function builds an alien ship (a sphere with a torus around it) and adds it to a library.
+	@param library A pointer to the library.
+	@param set Where to describe the ship.
+	@param sphereRadius The radius of the sphere.
+	@param slices How many times the sphere is cut around its axis.
+	@param stacks How many times the sphere is cut along its axis.
+	@param innerRadius The radius of the torus's tube.
+	@param outerRadius The distance from the center to the middle of the torus's tube.
+	@param sides How many sides the torus's tube has.
+	@param rings How many sections the torus is made of.
+ */
+static void addAlienMesh(MeshLibrary* library, MeshSet* set, float sphereRadius, int slices, int stacks,
+	float innerRadius, float outerRadius, int sides, int rings)
+{
+	set->pointBase = library->numTexels;
+	set->indexBase = library->numIndices;
+	addSphere(library, set->pointBase, sphereRadius, slices, stacks);
+	addTorus(library, set->pointBase, innerRadius, outerRadius, sides, rings);
+	set->meshPoints = library->numTexels - set->pointBase;
+	set->numIndices = library->numIndices - set->indexBase;
+	// Light each triangle flat, like every other mesh in the game
+	set->normalBase = library->numTexels;
+	addTriangleNormals(library, set->pointBase, set->indexBase);
+	set->meshNormals = set->numIndices / 3;
+}
+
+/*
+	This function builds the player's ship and adds it to a library.
+	@param library A pointer to the library.
+	@param set Where to describe the ship.
+ */
+static void addPlayerMesh(MeshLibrary* library, MeshSet* set)
+{
+	set->pointBase = library->numTexels;
+	set->indexBase = library->numIndices;
+	// Every triangle has its own three points
+	for (int i = 0; i < NUM_SHIP_VERTS; i++)
+		addTexel(library, spaceShip[i][X_], spaceShip[i][Y_], spaceShip[i][Z_], 1.0f);
+	for (int i = 0; i < NUM_SHIP_VERTS; i += 3)
+		addTriangle(library, i, i + 1, i + 2);
+	set->meshPoints = NUM_SHIP_VERTS;
+	set->numIndices = NUM_SHIP_VERTS;
+	// The normals the old drawing code gave each triangle
+	set->normalBase = library->numTexels;
+	addTriangleNormals(library, set->pointBase, set->indexBase);
+	set->meshNormals = NUM_SHIP_NORMS;
+}
+
+/*
+	This function builds every mesh the game draws.
+	@return A pointer to the library holding them.
+*/
+MeshLibrary* buildMeshLibrary()
+{
+	MeshLibrary* library = (MeshLibrary*)calloc(1, sizeof(MeshLibrary));
+	library->texelCapacity = LIBRARY_START_SIZE;
+	library->texels = (float(*)[4])malloc(library->texelCapacity * sizeof(float[4]));
+	library->indexCapacity = LIBRARY_START_SIZE;
+	library->indices = (unsigned short*)malloc(library->indexCapacity * sizeof(unsigned short));
+
+	// The asteroid shapes, an alien ship for each size class, and the player's ship
+	addAsteroidMeshes(library, &library->sets[MESH_ASTEROID]);
+	addAlienMesh(library, &library->sets[MESH_ALIEN_LARGE], ALIEN_LARGE_SPH_R, ALIEN_LARGE_SPH_SL, ALIEN_LARGE_SPH_ST,
+		ALIEN_LARGE_TOR_IN_R, ALIEN_LARGE_TOR_OUT_R, ALIEN_LARGE_TOR_SIDE, ALIEN_LARGE_TOR_RINGS);
+	addAlienMesh(library, &library->sets[MESH_ALIEN_SMALL], ALIEN_SMALL_SPH_R, ALIEN_SMALL_SPH_SL, ALIEN_SMALL_SPH_ST,
+		ALIEN_SMALL_TOR_IN_R, ALIEN_SMALL_TOR_OUT_R, ALIEN_SMALL_TOR_SIDE, ALIEN_SMALL_TOR_RINGS);
+	addPlayerMesh(library, &library->sets[MESH_PLAYER]);
+	return library;
+}
+
+/*
+	This function frees a mesh library.
+	@param library A pointer to the library to destroy.
+*/
+void destroyMeshLibrary(MeshLibrary* library)
+{
+	if (library == NULL)
+		return;
+	free(library->texels);
+	free(library->indices);
+	free(library);
+}
@@ -0,0 +1,61 @@
+#ifndef __MESHES__
+#define __MESHES__
+
+#include "objects.h"
+
+/*
+	@file meshes.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the mesh library, every mesh the game draws built once into one
+	array of points and normals and one array of triangles. Meshes that are drawn the same way
+	are grouped into sets that share their triangles, so a set can be drawn all at once.
+	Nothing in here knows about GLUT or OpenGL, any renderer can draw from it.
+*/
+
+// The sets of meshes
+#define MESH_ASTEROID 0
+#define MESH_ALIEN_LARGE 1
+#define MESH_ALIEN_SMALL 2
+#define MESH_PLAYER 3
+#define NUM_MESH_SETS 4
+
+// A struct describing a set of meshes in the library that are all drawn with the same triangles
+typedef struct {
+	// Where the first mesh's points start, each mesh has meshPoints of them
+	int pointBase;
+	int meshPoints;
+	// Where the first mesh's triangle normals start, each mesh has meshNormals of them
+	int normalBase;
+	int meshNormals;
+	// Where the triangles start in the index array, and how many indices there are
+	int indexBase;
+	int numIndices;
+} MeshSet;
+
+// A struct holding every mesh the game draws
+typedef struct {
+	// Points and normals, one texel each (w is 1 for a point and 0 for a normal)
+	float (*texels)[4];
+	int numTexels;
+	int texelCapacity;
+	// The triangles, three indices each (counted from the first point of the mesh)
+	unsigned short* indices;
+	int numIndices;
+	int indexCapacity;
+	// Each set of meshes (the MESH_ values)
+	MeshSet sets[NUM_MESH_SETS];
+} MeshLibrary;
+
+/*
+	This function builds every mesh the game draws.
+	@return A pointer to the library holding them.
+ */
+MeshLibrary* buildMeshLibrary();
+
+/*
+	This function frees a mesh library.
+	@param library A pointer to the library to destroy.
+ */
+void destroyMeshLibrary(MeshLibrary* library);
+
+#endif
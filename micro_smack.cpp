@@ -0,0 +1,773 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profiler.h"
+#include "rng.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Pull smack.cpp in whole so its static helpers can be timed too (do not also link smack.o)
+#include "smack.cpp"
+
+/*
+	@file micro_smack.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This program microbenchmarks every narrowphase predicate in smack.cpp (the detectCollide
+	functions and the static helpers they are built from). Each one is timed over random inputs,
+	which hit some of the time, and adversarial inputs built to take the slowest path through it
+	(near misses, points on edges, degenerate segments and triangles). It reports ns and cycles per
+	test, millions of tests a second, and how often the test hit, which changes if the math does.
+	The batch tests are timed too, once on every vector unit the CPU has. They check each block of
+	BATCH_MAX inputs' targets against the first input's probe, so their hit rates are lower.
+	Usage: micro_smack [--inputs=N] [--passes=N] [--seed=N] [--csv=FILE]
+ */
+
+// The number of inputs each predicate is run over if none is asked for
+#define MICRO_DEFAULT_INPUTS 4096
+// The number of times the inputs are run through per timing if none is asked for
+#define MICRO_DEFAULT_PASSES 64
+// The number of timings taken, the fastest one is kept
+#define MICRO_REPEATS 7
+// How far off an edge an adversarial input sits
+#define MICRO_EPSILON 1e-5f
+// How to run this program
+#define MICRO_USAGE "Usage: %s [--inputs=N] [--passes=N] [--seed=N] [--csv=FILE]\n"
+
+// A struct holding the inputs for every predicate, input i uses entry i of each
+typedef struct {
+	// The number of inputs
+	int count;
+	// Asteroid i lives in slot i
+	ObjectPool* asteroids;
+	// Missle i lives in slot i
+	ObjectPool* shots;
+	Alien* aliens;
+	PlayerShip* ships;
+	// The raw arguments for the static helpers
+	float (*args)[8];
+	// The slot of every input in order, and a block to pack them into for the batch tests
+	int* slots;
+	TargetBlock* block;
+} MicroFixture;
+
+// A struct describing one predicate to time
+typedef struct {
+	// The name of the predicate
+	const char* name;
+	// Fills the fixture with random (or adversarial) inputs for it
+	void (*fill)(MicroFixture* fixture, bool adversarial, Rng* rng);
+	// Runs it over every input and returns how many hit
+	int (*run)(const MicroFixture* fixture);
+	// The vector unit a batch test runs on, or -1 for everything else
+	int level;
+} MicroCase;
+
+/*
+	This function reads the CPU's cycle counter.
+	@return The number of cycles since some fixed point, or 0 if the CPU has no counter we know of.
+ */
+static inline uint64_t readCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+/*
+	This function picks a random float in a range.
+	@param rng The stream to draw from.
+	@param lower The bottom of the range.
+	@param upper The top of the range.
+	@return The float.
+ */
+static float randomRange(Rng* rng, float lower, float upper)
+{
+	return lower + ((upper - lower) * (rngNext(rng) >> 8) / (float)(1 << 24));
+}
+
+/*
+	This function reads one of the player's hull points from its collider.
+	@param ship The player ship.
+	@param k Which point of the hull (0 to 2).
+	@param x Where to put the x co-ordinate.
+	@param y Where to put the y co-ordinate.
+ */
+static void shipPoint(const PlayerShip* ship, int k, float* x, float* y)
+{
+	*x = ship->hull[k][X_];
+	*y = ship->hull[k][Y_];
+}
+
+/*
+	This function puts asteroid i somewhere with a random size.
+	@param fixture The fixture.
+	@param i The input.
+	@param x The x co-ordinate of the asteroid.
+	@param y The y co-ordinate of the asteroid.
+	@param radius The radius of the asteroid.
+ */
+static void placeAsteroid(MicroFixture* fixture, int i, float x, float y, float radius)
+{
+	Asteroid* a = (Asteroid*)poolSlot(fixture->asteroids, i);
+	for (int k = 0; k < 3; k++)
+		a->scale[k] = radius;
+	fixture->asteroids->motion->posX[i] = x;
+	fixture->asteroids->motion->posY[i] = y;
+	updateAsteroidCollider(fixture->asteroids, i);
+}
+
+/*
+	This function sets up alien i as a big or small alien at a position.
+	@param fixture The fixture.
+	@param i The input.
+	@param big True for a big alien.
+	@param x The x co-ordinate of the alien.
+	@param y The y co-ordinate of the alien.
+ */
+static void placeAlien(MicroFixture* fixture, int i, bool big, float x, float y)
+{
+	Alien* a = &fixture->aliens[i];
+	a->isBig = big;
+	a->sphereRadius = big ? ALIEN_LARGE_SPH_R : ALIEN_SMALL_SPH_R;
+	a->torusOuterRadius = big ? ALIEN_LARGE_TOR_OUT_R : ALIEN_SMALL_TOR_OUT_R;
+	a->torusInnerRadius = big ? ALIEN_LARGE_TOR_IN_R : ALIEN_SMALL_TOR_IN_R;
+	a->positionVector[X_] = x;
+	a->positionVector[Y_] = y;
+	a->positionVector[Z_] = Z_LEVEL;
+	updateAlienCollider(a);
+}
+
+/*
+	This function puts missle i at a position.
+	@param fixture The fixture.
+	@param i The input.
+	@param x The x co-ordinate of the missle.
+	@param y The y co-ordinate of the missle.
+ */
+static void placeShot(MicroFixture* fixture, int i, float x, float y)
+{
+	fixture->shots->motion->posX[i] = x;
+	fixture->shots->motion->posY[i] = y;
+}
+
+
+/* Filling in inputs */
+
+
+/*
+	Each of these fills a fixture with inputs for one predicate.
+	@param fixture The fixture to fill.
+	@param adversarial True for inputs that take the slowest path, false for random ones.
+	@param rng The stream to draw from.
+ */
+
+/*
+	Asteroid vs missle: random missles around the asteroid, or missles right on its edge.
+ */
+static void fillAsteroidShot(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		float radius = randomRange(rng, 0.1f, 0.9f);
+		placeAsteroid(fixture, i, randomRange(rng, -6.0f, 6.0f), randomRange(rng, -6.0f, 6.0f), radius);
+		float ax = fixture->asteroids->motion->posX[i];
+		float ay = fixture->asteroids->motion->posY[i];
+		if (adversarial){
+			float angle = randomRange(rng, 0.0f, 6.2831853f);
+			float d = radius * (1.0f + randomRange(rng, -MICRO_EPSILON, MICRO_EPSILON));
+			placeShot(fixture, i, ax + (d * cosf(angle)), ay + (d * sinf(angle)));
+		}
+		else placeShot(fixture, i, ax + randomRange(rng, -1.0f, 1.0f), ay + randomRange(rng, -1.0f, 1.0f));
+	}
+}
+
+/*
+	Asteroid vs player: random asteroids around the ship, or asteroids sitting on the line through
+	an edge of the hull just past a corner, so every point misses and every edge is checked.
+ */
+static void fillAsteroidShip(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		PlayerShip* ship = &fixture->ships[i];
+		ship->positionVector[X_] = randomRange(rng, -6.0f, 6.0f);
+		ship->positionVector[Y_] = randomRange(rng, -6.0f, 6.0f);
+		updateShipCollider(ship);
+		float radius = randomRange(rng, 0.1f, 0.9f);
+		if (adversarial){
+			// Walk off the end of a random edge by a little more than the radius
+			int k = rngInt(rng, 3);
+			float x1, y1, x2, y2;
+			shipPoint(ship, k, &x1, &y1);
+			shipPoint(ship, (k + 1) % 3, &x2, &y2);
+			float dx = x2 - x1;
+			float dy = y2 - y1;
+			float length = sqrtf((dx * dx) + (dy * dy));
+			float past = radius * (1.0f + randomRange(rng, MICRO_EPSILON, 0.2f));
+			placeAsteroid(fixture, i, x2 + (dx / length * past), y2 + (dy / length * past), radius);
+		}
+		else placeAsteroid(fixture, i, ship->positionVector[X_] + randomRange(rng, -1.5f, 1.5f),
+			ship->positionVector[Y_] + randomRange(rng, -1.5f, 1.5f), radius);
+	}
+}
+
+/*
+	Asteroid vs alien: random asteroids around the alien, or boxes that just touch or just miss.
+ */
+static void fillAsteroidAlien(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		placeAlien(fixture, i, rngInt(rng, 2), randomRange(rng, -6.0f, 6.0f), randomRange(rng, -6.0f, 6.0f));
+		Alien* a = &fixture->aliens[i];
+		float radius = randomRange(rng, 0.1f, 0.9f);
+		if (adversarial){
+			// Line the boxes up on x and leave them a hair apart (or a hair overlapping) on y
+			float alienH = 1.6f * a->sphereRadius;
+			float reachY = (alienH + (1.9f * radius)) / 2;
+			placeAsteroid(fixture, i, a->positionVector[X_], a->positionVector[Y_] + (reachY * (1.0f + randomRange(rng, -MICRO_EPSILON, MICRO_EPSILON))), radius);
+		}
+		else placeAsteroid(fixture, i, a->positionVector[X_] + randomRange(rng, -1.5f, 1.5f),
+			a->positionVector[Y_] + randomRange(rng, -1.5f, 1.5f), radius);
+	}
+}
+
+/*
+	Alien vs missle: random missles around the alien, or missles lined up on x and just off its box on y.
+ */
+static void fillAlienShot(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		placeAlien(fixture, i, rngInt(rng, 2), randomRange(rng, -6.0f, 6.0f), randomRange(rng, -6.0f, 6.0f));
+		Alien* a = &fixture->aliens[i];
+		if (adversarial){
+			float halfH = (1.5f * a->sphereRadius) / 2;
+			placeShot(fixture, i, a->positionVector[X_], a->positionVector[Y_] + (halfH * (1.0f + randomRange(rng, -MICRO_EPSILON, MICRO_EPSILON))));
+		}
+		else placeShot(fixture, i, a->positionVector[X_] + randomRange(rng, -0.8f, 0.8f),
+			a->positionVector[Y_] + randomRange(rng, -0.8f, 0.8f));
+	}
+}
+
+/*
+	Alien vs player: random aliens around the ship, or an alien that every hull point is inside
+	of on x and just outside of on y, so all three points are checked in full.
+ */
+static void fillAlienPlayer(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		PlayerShip* ship = &fixture->ships[i];
+		ship->positionVector[X_] = randomRange(rng, -6.0f, 6.0f);
+		ship->positionVector[Y_] = randomRange(rng, -6.0f, 6.0f);
+		updateShipCollider(ship);
+		bool big = rngInt(rng, 2);
+		if (adversarial){
+			float halfH = ((1.6f * (big ? ALIEN_LARGE_SPH_R : ALIEN_SMALL_SPH_R)) / 2);
+			float hullY = ship->scale[X_] * 1.0f;
+			placeAlien(fixture, i, big, ship->positionVector[X_] + (ship->scale[Z_] * 0.35f),
+				ship->positionVector[Y_] + hullY + halfH + MICRO_EPSILON);
+		}
+		else placeAlien(fixture, i, big, ship->positionVector[X_] + randomRange(rng, -1.5f, 1.5f),
+			ship->positionVector[Y_] + randomRange(rng, -1.5f, 1.5f));
+	}
+}
+
+/*
+	Player vs missle: random missles around the ship, or missles sitting right on an edge of the hull.
+ */
+static void fillPlayerShot(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		PlayerShip* ship = &fixture->ships[i];
+		ship->positionVector[X_] = randomRange(rng, -6.0f, 6.0f);
+		ship->positionVector[Y_] = randomRange(rng, -6.0f, 6.0f);
+		updateShipCollider(ship);
+		if (adversarial){
+			int k = rngInt(rng, 3);
+			float x1, y1, x2, y2;
+			shipPoint(ship, k, &x1, &y1);
+			shipPoint(ship, (k + 1) % 3, &x2, &y2);
+			float t = randomRange(rng, 0.0f, 1.0f);
+			placeShot(fixture, i, x1 + ((x2 - x1) * t) + randomRange(rng, -MICRO_EPSILON, MICRO_EPSILON),
+				y1 + ((y2 - y1) * t) + randomRange(rng, -MICRO_EPSILON, MICRO_EPSILON));
+		}
+		else placeShot(fixture, i, ship->positionVector[X_] + randomRange(rng, -0.5f, 0.5f),
+			ship->positionVector[Y_] + randomRange(rng, -0.5f, 0.5f));
+	}
+}
+
+/*
+	checkPointInCircle: random points near a circle, or points right on its edge.
+ */
+static void fillPointInCircle(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		float* a = fixture->args[i];
+		a[0] = randomRange(rng, 0.1f, 0.9f);
+		a[1] = randomRange(rng, -6.0f, 6.0f);
+		a[2] = randomRange(rng, -6.0f, 6.0f);
+		float angle = randomRange(rng, 0.0f, 6.2831853f);
+		float d = adversarial ? (a[0] * (1.0f + randomRange(rng, -MICRO_EPSILON, MICRO_EPSILON))) : randomRange(rng, 0.0f, 1.5f);
+		a[3] = a[1] + (d * cosf(angle));
+		a[4] = a[2] + (d * sinf(angle));
+	}
+}
+
+/*
+	checkLineInCircle: random segments near a circle, or segments whose line crosses the circle but
+	which stop short of it (so the square roots are always taken), and some with no length at all.
+ */
+static void fillLineInCircle(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		float* a = fixture->args[i];
+		a[0] = randomRange(rng, 0.1f, 0.9f);
+		a[1] = randomRange(rng, -6.0f, 6.0f);
+		a[2] = randomRange(rng, -6.0f, 6.0f);
+		float angle = randomRange(rng, 0.0f, 6.2831853f);
+		if (adversarial){
+			// A segment on a line through the circle, starting just past its edge and heading away
+			float start = a[0] * (1.0f + randomRange(rng, MICRO_EPSILON, 0.2f));
+			float length = (rngInt(rng, 8) == 0) ? 0.0f : randomRange(rng, 0.1f, 0.5f);
+			a[3] = a[1] + (start * cosf(angle));
+			a[4] = a[2] + (start * sinf(angle));
+			a[5] = a[1] + ((start + length) * cosf(angle));
+			a[6] = a[2] + ((start + length) * sinf(angle));
+		}
+		else {
+			a[3] = a[1] + randomRange(rng, -1.5f, 1.5f);
+			a[4] = a[2] + randomRange(rng, -1.5f, 1.5f);
+			a[5] = a[1] + randomRange(rng, -1.5f, 1.5f);
+			a[6] = a[2] + randomRange(rng, -1.5f, 1.5f);
+		}
+	}
+}
+
+/*
+	checkPointInLine: random points around a segment, or points sitting on its ends.
+ */
+static void fillPointInLine(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		float* a = fixture->args[i];
+		a[2] = randomRange(rng, -6.0f, 6.0f);
+		a[3] = randomRange(rng, -6.0f, 6.0f);
+		a[4] = a[2] + randomRange(rng, -1.0f, 1.0f);
+		a[5] = a[3] + randomRange(rng, -1.0f, 1.0f);
+		if (adversarial){
+			bool first = rngInt(rng, 2);
+			a[0] = first ? a[2] : a[4];
+			a[1] = first ? a[3] : a[5];
+		}
+		else {
+			a[0] = a[2] + randomRange(rng, -1.0f, 1.0f);
+			a[1] = a[3] + randomRange(rng, -1.0f, 1.0f);
+		}
+	}
+}
+
+/*
+	sign and checkPointInTriangle: random points around a random triangle, or points on the edges
+	of triangles that are squashed flat (or nearly), with some values small enough to be denormal.
+ */
+static void fillTriangle(MicroFixture* fixture, bool adversarial, Rng* rng)
+{
+	for (int i = 0; i < fixture->count; i++){
+		float* a = fixture->args[i];
+		float cx = randomRange(rng, -6.0f, 6.0f);
+		float cy = randomRange(rng, -6.0f, 6.0f);
+		for (int k = 0; k < 3; k++){
+			a[2 + (k * 2)] = cx + randomRange(rng, -0.5f, 0.5f);
+			a[3 + (k * 2)] = cy + randomRange(rng, -0.5f, 0.5f);
+		}
+		if (adversarial){
+			// Flatten the triangle onto the line through its first two corners
+			float t = randomRange(rng, -1.0f, 2.0f);
+			a[6] = a[2] + ((a[4] - a[2]) * t);
+			a[7] = a[3] + ((a[5] - a[3]) * t) + ((rngInt(rng, 4) == 0) ? 1e-39f : 0.0f);
+			// Put the point on that line too
+			t = randomRange(rng, 0.0f, 1.0f);
+			a[0] = a[2] + ((a[4] - a[2]) * t);
+			a[1] = a[3] + ((a[5] - a[3]) * t);
+		}
+		else {
+			a[0] = cx + randomRange(rng, -0.5f, 0.5f);
+			a[1] = cy + randomRange(rng, -0.5f, 0.5f);
+		}
+	}
+}
+
+
+/* Running them */
+
+
+// Every predicate is called through a pointer the compiler cannot see through, so each test pays
+// for a real call the way world.cpp does and none of them can be folded away into the loop
+static bool (*volatile asteroidShotFn)(ObjectPool*, int, ObjectPool*, int) = detectCollideAsteroidShot;
+static bool (*volatile asteroidShipFn)(ObjectPool*, int, PlayerShip*) = detectCollideAsteroidShip;
+static bool (*volatile asteroidAlienFn)(ObjectPool*, int, Alien*) = detectCollideAsteroidAlien;
+static bool (*volatile alienShotFn)(Alien*, ObjectPool*, int) = detectCollideAlienShot;
+static bool (*volatile alienPlayerFn)(Alien*, PlayerShip*) = detectCollideAlienPlayer;
+static bool (*volatile playerShotFn)(PlayerShip*, ObjectPool*, int) = detectCollidePlayerShot;
+static bool (*volatile pointInCircleFn)(float, float, float, float, float) = checkPointInCircle;
+static bool (*volatile lineInCircleFn)(float, float, float, float, float, float, float) = checkLineInCircle;
+static bool (*volatile pointInLineFn)(float, float, float, float, float, float) = checkPointInLine;
+static float (*volatile signFn)(float, float, float, float, float, float) = sign;
+static bool (*volatile pointInTriangleFn)(float, float, float, float, float, float, float, float) = checkPointInTriangle;
+
+/*
+	Each of these runs one predicate over every input in a fixture.
+	@param f The fixture holding the inputs.
+	@return How many of the tests hit.
+ */
+
+
+static int runAsteroidShot(const MicroFixture* f)
+{
+	bool (*test)(ObjectPool*, int, ObjectPool*, int) = asteroidShotFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++)
+		hits += test(f->asteroids, i, f->shots, i);
+	return hits;
+}
+
+static int runAsteroidShip(const MicroFixture* f)
+{
+	bool (*test)(ObjectPool*, int, PlayerShip*) = asteroidShipFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++)
+		hits += test(f->asteroids, i, &f->ships[i]);
+	return hits;
+}
+
+static int runAsteroidAlien(const MicroFixture* f)
+{
+	bool (*test)(ObjectPool*, int, Alien*) = asteroidAlienFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++)
+		hits += test(f->asteroids, i, &f->aliens[i]);
+	return hits;
+}
+
+static int runAlienShot(const MicroFixture* f)
+{
+	bool (*test)(Alien*, ObjectPool*, int) = alienShotFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++)
+		hits += test(&f->aliens[i], f->shots, i);
+	return hits;
+}
+
+static int runAlienPlayer(const MicroFixture* f)
+{
+	bool (*test)(Alien*, PlayerShip*) = alienPlayerFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++)
+		hits += test(&f->aliens[i], &f->ships[i]);
+	return hits;
+}
+
+static int runPlayerShot(const MicroFixture* f)
+{
+	bool (*test)(PlayerShip*, ObjectPool*, int) = playerShotFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++)
+		hits += test(&f->ships[i], f->shots, i);
+	return hits;
+}
+
+static int runPointInCircle(const MicroFixture* f)
+{
+	bool (*test)(float, float, float, float, float) = pointInCircleFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++){
+		const float* a = f->args[i];
+		hits += test(a[0], a[1], a[2], a[3], a[4]);
+	}
+	return hits;
+}
+
+static int runLineInCircle(const MicroFixture* f)
+{
+	bool (*test)(float, float, float, float, float, float, float) = lineInCircleFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++){
+		const float* a = f->args[i];
+		hits += test(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+	}
+	return hits;
+}
+
+static int runPointInLine(const MicroFixture* f)
+{
+	bool (*test)(float, float, float, float, float, float) = pointInLineFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++){
+		const float* a = f->args[i];
+		hits += test(a[0], a[1], a[2], a[3], a[4], a[5]);
+	}
+	return hits;
+}
+
+static int runSign(const MicroFixture* f)
+{
+	float (*test)(float, float, float, float, float, float) = signFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++){
+		const float* a = f->args[i];
+		hits += test(a[0], a[1], a[2], a[3], a[4], a[5]) < 0.0f;
+	}
+	return hits;
+}
+
+static int runPointInTriangle(const MicroFixture* f)
+{
+	bool (*test)(float, float, float, float, float, float, float, float) = pointInTriangleFn;
+	int hits = 0;
+	for (int i = 0; i < f->count; i++){
+		const float* a = f->args[i];
+		hits += test(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+	}
+	return hits;
+}
+
+/*
+	This function counts the hits in a mask from a batch test.
+	@param mask The mask.
+	@return The number of bits set.
+ */
+static int countHits(uint32_t mask)
+{
+	int hits = 0;
+	for (; mask != 0; mask &= mask - 1)
+		hits++;
+	return hits;
+}
+
+/*
+	This function packs a run of aliens into the fixture's block the way gatherAliens does.
+	@param f The fixture.
+	@param first The first alien to pack.
+	@param count The number of aliens to pack.
+ */
+static void packAliens(const MicroFixture* f, int first, int count)
+{
+	TargetBlock* block = f->block;
+	for (int k = 0; k < count; k++){
+		const Alien* a = &f->aliens[first + k];
+		block->x[k] = a->collider.center[X_];
+		block->y[k] = a->collider.center[Y_];
+		block->w[k] = a->asteroidBox[X_];
+		block->h[k] = a->asteroidBox[Y_];
+		block->slot[k] = first + k;
+	}
+	block->count = count;
+}
+
+/*
+	Each of these runs one batch test over every input in a fixture, a block at a time, packing
+	the block the way world.cpp does (the tests already go through a pointer picked at start up).
+	@param f The fixture holding the inputs.
+	@return How many of the tests hit.
+ */
+
+
+static int runAsteroidShots(const MicroFixture* f)
+{
+	int hits = 0;
+	for (int i = 0; i < f->count; i += BATCH_MAX){
+		int n = ((f->count - i) < BATCH_MAX) ? (f->count - i) : BATCH_MAX;
+		gatherShots(f->block, f->shots, f->slots + i, n, 0);
+		hits += countHits(detectCollideAsteroidShots(f->asteroids, i, f->block));
+	}
+	return hits;
+}
+
+static int runAsteroidAliens(const MicroFixture* f)
+{
+	int hits = 0;
+	for (int i = 0; i < f->count; i += BATCH_MAX){
+		int n = ((f->count - i) < BATCH_MAX) ? (f->count - i) : BATCH_MAX;
+		packAliens(f, i, n);
+		hits += countHits(detectCollideAsteroidAliens(f->asteroids, i, f->block));
+	}
+	return hits;
+}
+
+static int runAlienShots(const MicroFixture* f)
+{
+	int hits = 0;
+	for (int i = 0; i < f->count; i += BATCH_MAX){
+		int n = ((f->count - i) < BATCH_MAX) ? (f->count - i) : BATCH_MAX;
+		gatherShots(f->block, f->shots, f->slots + i, n, 0);
+		hits += countHits(detectCollideAlienShots(&f->aliens[i], f->block));
+	}
+	return hits;
+}
+
+static int runPlayerShots(const MicroFixture* f)
+{
+	int hits = 0;
+	for (int i = 0; i < f->count; i += BATCH_MAX){
+		int n = ((f->count - i) < BATCH_MAX) ? (f->count - i) : BATCH_MAX;
+		gatherShots(f->block, f->shots, f->slots + i, n, 0);
+		hits += countHits(detectCollidePlayerShots(&f->ships[i], f->block));
+	}
+	return hits;
+}
+
+// The number of batch tests on each vector unit
+#define MICRO_BATCH_CASES 4
+// The four batch tests on one vector unit
+#define BATCH_CASES(suffix, level) \
+	{ "detectCollideAsteroidShots/" suffix, fillAsteroidShot, runAsteroidShots, level }, \
+	{ "detectCollideAsteroidAliens/" suffix, fillAsteroidAlien, runAsteroidAliens, level }, \
+	{ "detectCollideAlienShots/" suffix, fillAlienShot, runAlienShots, level }, \
+	{ "detectCollidePlayerShots/" suffix, fillPlayerShot, runPlayerShots, level }
+
+// Every predicate that gets timed
+static const MicroCase cases[] = {
+	{ "detectCollideAsteroidShot", fillAsteroidShot, runAsteroidShot, -1 },
+	{ "detectCollideAsteroidShip", fillAsteroidShip, runAsteroidShip, -1 },
+	{ "detectCollideAsteroidAlien", fillAsteroidAlien, runAsteroidAlien, -1 },
+	{ "detectCollideAlienShot", fillAlienShot, runAlienShot, -1 },
+	{ "detectCollideAlienPlayer", fillAlienPlayer, runAlienPlayer, -1 },
+	{ "detectCollidePlayerShot", fillPlayerShot, runPlayerShot, -1 },
+	{ "checkPointInCircle", fillPointInCircle, runPointInCircle, -1 },
+	{ "checkLineInCircle", fillLineInCircle, runLineInCircle, -1 },
+	{ "checkPointInLine", fillPointInLine, runPointInLine, -1 },
+	{ "sign", fillTriangle, runSign, -1 },
+	{ "checkPointInTriangle", fillTriangle, runPointInTriangle, -1 },
+	BATCH_CASES("scalar", BATCH_SCALAR),
+	BATCH_CASES("sse", BATCH_SSE),
+	BATCH_CASES("avx2", BATCH_AVX2),
+	BATCH_CASES("avx512", BATCH_AVX512)
+};
+
+/*
+	This is the main function. It times every predicate on both kinds of input and prints a table (or CSV).
+	@param argc The number of arguments given
+	@param argv The argument vector
+	@return EXIT_SUCCESS, or EXIT_FAILURE if the arguments were bad
+*/
+int main(int argc, char** argv)
+{
+	int inputs = MICRO_DEFAULT_INPUTS;
+	int passes = MICRO_DEFAULT_PASSES;
+	uint64_t seed = 1;
+	const char* csvPath = NULL;
+
+	// Read the arguments
+	for (int i = 1; i < argc; i++){
+		if (strncmp(argv[i], "--inputs=", 9) == 0)
+			inputs = atoi(argv[i] + 9);
+		else if (strncmp(argv[i], "--passes=", 9) == 0)
+			passes = atoi(argv[i] + 9);
+		else if (strncmp(argv[i], "--seed=", 7) == 0)
+			seed = strtoull(argv[i] + 7, NULL, 10);
+		else if (strncmp(argv[i], "--csv=", 6) == 0)
+			csvPath = argv[i] + 6;
+		else {
+			fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			fprintf(stderr, MICRO_USAGE, argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if ((inputs <= 0) || (passes <= 0)){
+		fprintf(stderr, MICRO_USAGE, argv[0]);
+		return EXIT_FAILURE;
+	}
+	FILE* csv = NULL;
+	if (csvPath != NULL){
+		csv = fopen(csvPath, "w");
+		if (csv == NULL){
+			fprintf(stderr, "Could not open %s\n", csvPath);
+			return EXIT_FAILURE;
+		}
+		fprintf(csv, "predicate,inputs,tests,ns_per_test,cycles_per_test,mtests_per_sec,hit_rate\n");
+	}
+
+	// Make room for every input, the pools hand out slots 0 to inputs - 1 in order
+	MicroFixture fixture;
+	fixture.count = inputs;
+	fixture.asteroids = createPool(sizeof(Asteroid), inputs, true);
+	fixture.shots = createPool(sizeof(Missle), inputs, true);
+	for (int i = 0; i < inputs; i++){
+		poolAdd(fixture.asteroids);
+		poolAdd(fixture.shots);
+	}
+	fixture.aliens = (Alien*)calloc(inputs, sizeof(Alien));
+	fixture.ships = (PlayerShip*)malloc(inputs * sizeof(PlayerShip));
+	PlayerShip* player = initPlayer();
+	for (int i = 0; i < inputs; i++)
+		fixture.ships[i] = *player;
+	free(player);
+	fixture.args = (float(*)[8])calloc(inputs, sizeof(float[8]));
+	fixture.slots = (int*)malloc(inputs * sizeof(int));
+	for (int i = 0; i < inputs; i++)
+		fixture.slots[i] = i;
+	fixture.block = createTargetBlock();
+	int bestLevel = batchBestLevel();
+
+	printf("%-34s %-11s %9s %9s %9s %7s\n", "predicate", "inputs", "ns/test", "cyc/test", "Mtest/s", "hit %");
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++){
+		// Skip vector units this CPU does not have
+		if (cases[c].level > bestLevel)
+			continue;
+		if (cases[c].level >= 0)
+			setBatchLevel(cases[c].level);
+		for (int adversarial = 0; adversarial < 2; adversarial++){
+			// Every predicate gets the same inputs no matter which ones ran before it, and a batch test
+			// gets the same ones on every vector unit so their hit rates must match
+			size_t stream = c;
+			if (cases[c].level > 0)
+				stream -= cases[c].level * MICRO_BATCH_CASES;
+			Rng rng;
+			seedRng(&rng, seed, (stream * 2) + adversarial);
+			cases[c].fill(&fixture, adversarial, &rng);
+
+			// Warm up, then keep the fastest of a few timings
+			volatile int sink = cases[c].run(&fixture);
+			int64_t bestNs = INT64_MAX;
+			uint64_t bestCycles = UINT64_MAX;
+			long long hits = 0;
+			for (int r = 0; r < MICRO_REPEATS; r++){
+				hits = 0;
+				int64_t start = profileNow();
+				uint64_t startCycles = readCycles();
+				for (int p = 0; p < passes; p++)
+					hits += cases[c].run(&fixture);
+				uint64_t cycles = readCycles() - startCycles;
+				int64_t ns = profileNow() - start;
+				if (ns < bestNs)
+					bestNs = ns;
+				if (cycles < bestCycles)
+					bestCycles = cycles;
+			}
+			sink += (int)hits;
+
+			// Report it
+			double tests = (double)inputs * passes;
+			double nsPerTest = bestNs / tests;
+			double cyclesPerTest = bestCycles / tests;
+			double hitRate = 100.0 * hits / tests;
+			const char* kind = adversarial ? "adversarial" : "random";
+			printf("%-34s %-11s %9.2f %9.2f %9.1f %7.2f\n", cases[c].name, kind, nsPerTest, cyclesPerTest,
+				(nsPerTest > 0) ? (1e3 / nsPerTest) : 0.0, hitRate);
+			if (csv != NULL)
+				fprintf(csv, "%s,%s,%.0f,%.3f,%.3f,%.2f,%.4f\n", cases[c].name, kind, tests, nsPerTest,
+					cyclesPerTest, (nsPerTest > 0) ? (1e3 / nsPerTest) : 0.0, hitRate);
+		}
+	}
+
+	if (csv != NULL)
+		fclose(csv);
+	destroyPool(fixture.asteroids);
+	destroyPool(fixture.shots);
+	free(fixture.aliens);
+	free(fixture.ships);
+	free(fixture.args);
+	free(fixture.slots);
+	destroyTargetBlock(fixture.block);
+	return EXIT_SUCCESS;
+}
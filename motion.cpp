@@ -0,0 +1,305 @@
+#include <stdlib.h>
+#include <string.h>
+#include "objects.h"
+#include "motion.h"
+
+/*
+	@file motion.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file contains the structure of arrays for per-tick object state and
+	the kernels that integrate and wrap a whole column of objects in one pass.
+	AVX2 or SSE2 is picked at compile time, with a plain loop for everything else.
+ */
+
+// Pick the widest vector unit the compiler is allowed to use
+#if defined(__AVX2__)
+#define MOTION_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MOTION_SSE2
+#include <emmintrin.h>
+#endif
+
+// Columns are aligned for the widest vector loads we do
+#if defined(MOTION_AVX2) || defined(MOTION_SSE2)
+#define allocColumn(size) _mm_malloc((size), 32)
+#define freeColumn(ptr) _mm_free(ptr)
+#else
+#define allocColumn(size) malloc(size)
+#define freeColumn(ptr) free(ptr)
+#endif
+
+// The range spins are kept in
+#define SPIN_LOWER 0.0f
+#define SPIN_UPPER 360.0f
+
+/*
+	This function allocates a zeroed column.
+	@param capacity The number of slots in the column.
+	@param size The size of a single slot.
+	@return A pointer to the column.
+ */
+static void* makeColumn(int capacity, size_t size)
+{
+	void* column = allocColumn(capacity * size);
+	memset(column, 0, capacity * size);
+	return column;
+}
+
+/*
+	This function creates a motion store with zeroed, aligned columns.
+	@param capacity The number of slots needed.
+	@return A pointer to the store that was made.
+*/
+MotionStore* createMotionStore(int capacity)
+{
+	MotionStore* motion = (MotionStore*)malloc(sizeof(MotionStore));
+	// Round up so the kernels can always work in full vectors
+	capacity = ((capacity + MOTION_LANES - 1) / MOTION_LANES) * MOTION_LANES;
+	motion->capacity = capacity;
+	// Make every column
+	motion->posX = (float*)makeColumn(capacity, sizeof(float));
+	motion->posY = (float*)makeColumn(capacity, sizeof(float));
+	motion->velX = (float*)makeColumn(capacity, sizeof(float));
+	motion->velY = (float*)makeColumn(capacity, sizeof(float));
+	motion->spin = (float*)makeColumn(capacity, sizeof(float));
+	motion->spinFactor = (float*)makeColumn(capacity, sizeof(float));
+	motion->age = (float*)makeColumn(capacity, sizeof(float));
+	return motion;
+}
+
+/*
+	This function frees a motion store and all of its columns.
+	@param motion A pointer to the store to destroy.
+*/
+void destroyMotionStore(MotionStore* motion)
+{
+	freeColumn(motion->posX);
+	freeColumn(motion->posY);
+	freeColumn(motion->velX);
+	freeColumn(motion->velY);
+	freeColumn(motion->spin);
+	freeColumn(motion->spinFactor);
+	freeColumn(motion->age);
+	free(motion);
+}
+
+/*
+	This function zeroes every column for a single slot.
+	@param motion A pointer to the store to clear a slot in.
+	@param index The slot to clear.
+*/
+void clearMotionSlot(MotionStore* motion, int index)
+{
+	motion->posX[index] = 0.0f;
+	motion->posY[index] = 0.0f;
+	motion->velX[index] = 0.0f;
+	motion->velY[index] = 0.0f;
+	motion->spin[index] = 0.0f;
+	motion->spinFactor[index] = 0.0f;
+	motion->age[index] = 0.0f;
+}
+
+/*
+	This function copies every column of one slot into another.
+	@param motion A pointer to the store to copy in.
+	@param dest The slot to copy to.
+	@param src The slot to copy from.
+*/
+void copyMotionSlot(MotionStore* motion, int dest, int src)
+{
+	motion->posX[dest] = motion->posX[src];
+	motion->posY[dest] = motion->posY[src];
+	motion->velX[dest] = motion->velX[src];
+	motion->velY[dest] = motion->velY[src];
+	motion->spin[dest] = motion->spin[src];
+	motion->spinFactor[dest] = motion->spinFactor[src];
+	motion->age[dest] = motion->age[src];
+}
+
+/*
+	This function wraps a single value back into [lower, upper] the same way
+	the rest of the game does, by a full span at most once.
+	@param v The value to wrap.
+	@param lower The lower bound.
+	@param upper The upper bound.
+	@return The wrapped value.
+ */
+static inline float wrapScalar(float v, float lower, float upper)
+{
+	if (v > upper)
+		v -= (upper - lower);
+	else if (v < lower)
+		v += (upper - lower);
+	return v;
+}
+
+#if defined(MOTION_AVX2)
+
+/*
+	This function wraps eight values at once, see wrapScalar.
+ */
+static inline __m256 wrapVector(__m256 v, __m256 lower, __m256 upper, __m256 span)
+{
+	__m256 over = _mm256_and_ps(_mm256_cmp_ps(v, upper, _CMP_GT_OQ), span);
+	__m256 under = _mm256_and_ps(_mm256_cmp_ps(v, lower, _CMP_LT_OQ), span);
+	return _mm256_add_ps(_mm256_sub_ps(v, over), under);
+}
+
+/*
+	This function integrates eight slots per step with AVX2.
+ */
+static void integrateVector(MotionStore* motion, int count, float dt, float ageDelta)
+{
+	// Splat the step and all the bounds once
+	const __m256 step = _mm256_set1_ps(dt);
+	const __m256 lowerX = _mm256_set1_ps(BOUND_X_LOWER);
+	const __m256 upperX = _mm256_set1_ps(BOUND_X_UPPER);
+	const __m256 spanX = _mm256_set1_ps(BOUND_X_UPPER - BOUND_X_LOWER);
+	const __m256 lowerY = _mm256_set1_ps(BOUND_Y_LOWER);
+	const __m256 upperY = _mm256_set1_ps(BOUND_Y_UPPER);
+	const __m256 spanY = _mm256_set1_ps(BOUND_Y_UPPER - BOUND_Y_LOWER);
+	const __m256 lowerS = _mm256_set1_ps(SPIN_LOWER);
+	const __m256 upperS = _mm256_set1_ps(SPIN_UPPER);
+	const __m256 spanS = _mm256_set1_ps(SPIN_UPPER - SPIN_LOWER);
+	const __m256 ageStep = _mm256_set1_ps(ageDelta);
+
+	for (int i = 0; i < count; i += 8){
+		// Move and wrap
+		__m256 x = _mm256_add_ps(_mm256_load_ps(motion->posX + i), _mm256_mul_ps(_mm256_load_ps(motion->velX + i), step));
+		__m256 y = _mm256_add_ps(_mm256_load_ps(motion->posY + i), _mm256_mul_ps(_mm256_load_ps(motion->velY + i), step));
+		_mm256_store_ps(motion->posX + i, wrapVector(x, lowerX, upperX, spanX));
+		_mm256_store_ps(motion->posY + i, wrapVector(y, lowerY, upperY, spanY));
+		// Spin and wrap
+		__m256 s = _mm256_add_ps(_mm256_load_ps(motion->spin + i), _mm256_mul_ps(_mm256_load_ps(motion->spinFactor + i), step));
+		_mm256_store_ps(motion->spin + i, wrapVector(s, lowerS, upperS, spanS));
+		// Age
+		_mm256_store_ps(motion->age + i, _mm256_add_ps(_mm256_load_ps(motion->age + i), ageStep));
+	}
+}
+
+#elif defined(MOTION_SSE2)
+
+/*
+	This function wraps four values at once, see wrapScalar.
+ */
+static inline __m128 wrapVector(__m128 v, __m128 lower, __m128 upper, __m128 span)
+{
+	__m128 over = _mm_and_ps(_mm_cmpgt_ps(v, upper), span);
+	__m128 under = _mm_and_ps(_mm_cmplt_ps(v, lower), span);
+	return _mm_add_ps(_mm_sub_ps(v, over), under);
+}
+
+/*
+	This function integrates four slots per step with SSE2.
+ */
+static void integrateVector(MotionStore* motion, int count, float dt, float ageDelta)
+{
+	// Splat the step and all the bounds once
+	const __m128 step = _mm_set1_ps(dt);
+	const __m128 lowerX = _mm_set1_ps(BOUND_X_LOWER);
+	const __m128 upperX = _mm_set1_ps(BOUND_X_UPPER);
+	const __m128 spanX = _mm_set1_ps(BOUND_X_UPPER - BOUND_X_LOWER);
+	const __m128 lowerY = _mm_set1_ps(BOUND_Y_LOWER);
+	const __m128 upperY = _mm_set1_ps(BOUND_Y_UPPER);
+	const __m128 spanY = _mm_set1_ps(BOUND_Y_UPPER - BOUND_Y_LOWER);
+	const __m128 lowerS = _mm_set1_ps(SPIN_LOWER);
+	const __m128 upperS = _mm_set1_ps(SPIN_UPPER);
+	const __m128 spanS = _mm_set1_ps(SPIN_UPPER - SPIN_LOWER);
+	const __m128 ageStep = _mm_set1_ps(ageDelta);
+
+	for (int i = 0; i < count; i += 4){
+		// Move and wrap
+		__m128 x = _mm_add_ps(_mm_load_ps(motion->posX + i), _mm_mul_ps(_mm_load_ps(motion->velX + i), step));
+		__m128 y = _mm_add_ps(_mm_load_ps(motion->posY + i), _mm_mul_ps(_mm_load_ps(motion->velY + i), step));
+		_mm_store_ps(motion->posX + i, wrapVector(x, lowerX, upperX, spanX));
+		_mm_store_ps(motion->posY + i, wrapVector(y, lowerY, upperY, spanY));
+		// Spin and wrap
+		__m128 s = _mm_add_ps(_mm_load_ps(motion->spin + i), _mm_mul_ps(_mm_load_ps(motion->spinFactor + i), step));
+		_mm_store_ps(motion->spin + i, wrapVector(s, lowerS, upperS, spanS));
+		// Age
+		_mm_store_ps(motion->age + i, _mm_add_ps(_mm_load_ps(motion->age + i), ageStep));
+	}
+}
+
+#else
+
+/*
+	This function integrates one slot at a time when there are no vector units to use.
+ */
+static void integrateVector(MotionStore* motion, int count, float dt, float ageDelta)
+{
+	for (int i = 0; i < count; i++){
+		motion->posX[i] = wrapScalar(motion->posX[i] + (motion->velX[i] * dt), BOUND_X_LOWER, BOUND_X_UPPER);
+		motion->posY[i] = wrapScalar(motion->posY[i] + (motion->velY[i] * dt), BOUND_Y_LOWER, BOUND_Y_UPPER);
+		motion->spin[i] = wrapScalar(motion->spin[i] + (motion->spinFactor[i] * dt), SPIN_LOWER, SPIN_UPPER);
+		motion->age[i] += ageDelta;
+	}
+}
+
+#endif
+
+/*
+	This function moves the first count slots by their velocity and spin, ages them,
+	and wraps them around the window. It uses the widest vector unit that was compiled in.
+	@param motion A pointer to the store to update.
+	@param count The number of slots to update (usually the pool's high water mark).
+	@param dt How many base ticks this tick lasts, velocities and spins are scaled by it.
+	@param ageDelta How much to age every slot by.
+*/
+void integrateMotion(MotionStore* motion, int count, float dt, float ageDelta)
+{
+	// Round up to whole vectors, the columns are padded so this is always in bounds
+	count = ((count + MOTION_LANES - 1) / MOTION_LANES) * MOTION_LANES;
+	integrateVector(motion, count, dt, ageDelta);
+}
+
+/*
+	This function works out how many bytes saveMotion writes.
+	@param count The number of slots that will be saved.
+	@return The number of bytes.
+*/
+size_t motionSnapshotSize(int count)
+{
+	return (size_t)count * MOTION_COLUMNS * sizeof(float);
+}
+
+/*
+	This function copies the first count slots of every column into a flat buffer.
+	@param motion A pointer to the store to save.
+	@param count The number of slots to save.
+	@param out Where to write, there must be motionSnapshotSize(count) bytes of room.
+	@return A pointer just past what was written.
+*/
+char* saveMotion(const MotionStore* motion, int count, char* out)
+{
+	const float* columns[MOTION_COLUMNS] = { motion->posX, motion->posY, motion->velX, motion->velY,
+		motion->spin, motion->spinFactor, motion->age };
+	// One straight copy per column
+	size_t bytes = (size_t)count * sizeof(float);
+	for (int c = 0; c < MOTION_COLUMNS; c++){
+		memcpy(out, columns[c], bytes);
+		out += bytes;
+	}
+	return out;
+}
+
+/*
+	This function copies slots written by saveMotion back into a store.
+	@param motion A pointer to the store to load into.
+	@param count The number of slots that were saved.
+	@param in Where to read from.
+	@return A pointer just past what was read.
+*/
+const char* loadMotion(MotionStore* motion, int count, const char* in)
+{
+	float* columns[MOTION_COLUMNS] = { motion->posX, motion->posY, motion->velX, motion->velY,
+		motion->spin, motion->spinFactor, motion->age };
+	// One straight copy per column
+	size_t bytes = (size_t)count * sizeof(float);
+	for (int c = 0; c < MOTION_COLUMNS; c++){
+		memcpy(columns[c], in, bytes);
+		in += bytes;
+	}
+	return in;
+}
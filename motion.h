@@ -0,0 +1,99 @@
+#ifndef __MOTION__
+#define __MOTION__
+
+#include <stddef.h>
+
+/*
+	@file motion.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the structure of arrays that holds everything about
+	an object that changes every tick, and the kernels that move it all at once.
+*/
+
+// How many slots the motion columns are padded to so the kernels never need a tail loop
+#define MOTION_LANES 8
+// The number of columns in a motion store
+#define MOTION_COLUMNS 7
+
+// A struct holding the hot per-tick state of a pool as one array per field
+typedef struct {
+	// Where each object is in 2D
+	float* posX;
+	float* posY;
+	// How far each object moves every base tick
+	float* velX;
+	float* velY;
+	// The angle each object is rotated at
+	float* spin;
+	// How much to increment / decrement the spin by every base tick
+	float* spinFactor;
+	// How long each object has been around
+	float* age;
+	// The number of slots in every column (a multiple of MOTION_LANES)
+	int capacity;
+} MotionStore;
+
+/*
+	This function creates a motion store with zeroed, aligned columns.
+	@param capacity The number of slots needed.
+	@return A pointer to the store that was made.
+ */
+MotionStore* createMotionStore(int capacity);
+
+/*
+	This function frees a motion store and all of its columns.
+	@param motion A pointer to the store to destroy.
+ */
+void destroyMotionStore(MotionStore* motion);
+
+/*
+	This function zeroes every column for a single slot.
+	@param motion A pointer to the store to clear a slot in.
+	@param index The slot to clear.
+ */
+void clearMotionSlot(MotionStore* motion, int index);
+
+/*
+	This function copies every column of one slot into another.
+	@param motion A pointer to the store to copy in.
+	@param dest The slot to copy to.
+	@param src The slot to copy from.
+ */
+void copyMotionSlot(MotionStore* motion, int dest, int src);
+
+/*
+	This function moves the first count slots by their velocity and spin, ages them,
+	and wraps them around the window. It uses the widest vector unit that was compiled in.
+	@param motion A pointer to the store to update.
+	@param count The number of slots to update (usually the pool's high water mark).
+	@param dt How many base ticks this tick lasts, velocities and spins are scaled by it.
+	@param ageDelta How much to age every slot by.
+ */
+void integrateMotion(MotionStore* motion, int count, float dt, float ageDelta);
+
+/*
+	This function works out how many bytes saveMotion writes.
+	@param count The number of slots that will be saved.
+	@return The number of bytes.
+ */
+size_t motionSnapshotSize(int count);
+
+/*
+	This function copies the first count slots of every column into a flat buffer.
+	@param motion A pointer to the store to save.
+	@param count The number of slots to save.
+	@param out Where to write, there must be motionSnapshotSize(count) bytes of room.
+	@return A pointer just past what was written.
+ */
+char* saveMotion(const MotionStore* motion, int count, char* out);
+
+/*
+	This function copies slots written by saveMotion back into a store.
+	@param motion A pointer to the store to load into.
+	@param count The number of slots that were saved.
+	@param in Where to read from.
+	@return A pointer just past what was read.
+ */
+const char* loadMotion(MotionStore* motion, int count, const char* in);
+
+#endif
@@ -1,6 +1,5 @@
-#include "GL/glut.h"
-#include <iostream>
 #include <stdlib.h>
+#include <string.h>
 #include <cmath>
 #include <time.h>
 #include "objects.h"
@@ -18,29 +17,23 @@
 #define SHOOT_ASTEROID 1
 #define SHOOT_PLAYER 2
 
-//A flag for when the left key is pressed
-static bool leftKeyPressed = false;
-//A flag for when the right key is pressed
-static bool rightKeyPressed = false;
-//A flag for when the X button is pressed
-static bool xKeyPressed = false;
 //THe material for all missles
 float missleMat[] = { 1.0f, 1.0f, 1.0f, 0.0f };
 
 /*
 	This function handles an alien shooting at various objects in the game world.
 	@param alien The alien doing the shooting.
-	@param asteroids The list of asteroid in the game.
+	@param asteroids The pool of asteroids in the game.
 	@param p The player in the game.
-	@param alienShots The list of alien shots.
+	@param alienShots The pool of alien shots.
  */
-void alienShoot(Alien* alien, ObjectList* asteroids, PlayerShip* p, ObjectList* alienShots)
+void alienShoot(Alien* alien, ObjectPool* asteroids, PlayerShip* p, ObjectPool* alienShots)
 {
 	// Check if we can shoot
 	if (alien->missleCoolDown > 0)
 		return;
 	// Randomly picka number between 1 and 10 and create a flag
-	int result = (rand() % 10) + 1;
+	int result = rngInt(&alien->rng, 10) + 1;
 	int whatDoFlag = -1;
 	// Check the size of the alien
 	if (alien->isBig){
@@ -59,30 +52,34 @@ void alienShoot(Alien* alien, ObjectList* asteroids, PlayerShip* p, ObjectList*
 		else whatDoFlag = SHOOT_ASTEROID;
 	}
 
-	// Make a new missle object
-	Missle* m = (Missle*)malloc(sizeof(Missle));
+	// Make a new missle object in the alien shots pool
+	Missle* m = (Missle*)poolAdd(alienShots);
+	// Hold our fire if the pool is full
+	if (m == NULL)
+		return;
 	// Set up its fields
-	m->age = 0;
-	for (int i = 0; i < 3; i++){
-		m->positionVector[i] = alien->positionVector[i];
+	for (int i = 0; i < 4; i++)
 		m->mat[i] = missleMat[i];
-	}
-	m->mat[3] = missleMat[3];
 	m->vMag = MISSLE_V;
+	// Start it at the alien (the pool already zeroed its age)
+	int slot = poolIndexOf(m, alienShots);
+	MotionStore* motion = alienShots->motion;
+	motion->posX[slot] = alien->positionVector[X_];
+	motion->posY[slot] = alien->positionVector[Y_];
 
 	// Check if we are shooting randomly
 	if (whatDoFlag == SHOOT_RANDOM){
 		// Randomly create a vector
-		float x = (float)1 * (rand() % 15);
-		float y = (float)1 * (rand() % 15);
+		float x = (float)1 * rngInt(&alien->rng, 15);
+		float y = (float)1 * rngInt(&alien->rng, 15);
 		float mag = sqrt((x * x) + (y * y));
 		// Make it a unit vector
 		x = x / mag;
 		y = y / mag;
 		// Randomly choose to make its components negative
-		if (rand() % 2)
+		if (rngInt(&alien->rng, 2))
 			x = -x;
-		if (rand() % 2)
+		if (rngInt(&alien->rng, 2))
 			y = -y;
 		// Set the missle's direction vector
 		m->directionVector[X_] = x;
@@ -92,21 +89,25 @@ void alienShoot(Alien* alien, ObjectList* asteroids, PlayerShip* p, ObjectList*
 	else if (whatDoFlag == SHOOT_ASTEROID){
 		// Look for the closest asteroid
 		float closestDist = 100;
-		Asteroid* closest = NULL;
-		for (ObjectNode* node = asteroids->head; node != NULL; node = node->next){
-			// Get the asteroid and determine the distance
-			Asteroid* a = (Asteroid*)node->value;
-			float dx = abs(a->positionVector[X_] - alien->positionVector[X_]);
-			float dy = abs(a->positionVector[Y_] - alien->positionVector[Y_]);
+		int closest = -1;
+		MotionStore* roids = asteroids->motion;
+		for (int i = 0; i < asteroids->highWater; i++){
+			// Skip dead slots and determine the distance
+			if (!asteroids->live[i])
+				continue;
+			float dx = abs(roids->posX[i] - alien->positionVector[X_]);
+			float dy = abs(roids->posY[i] - alien->positionVector[Y_]);
 			float dist = sqrt((dx * dx) + (dy * dy));
 			// Remember it if its the closest one yet
 			if (dist < closestDist)
-				closest = a;
+				closest = i;
 		}
 
-		// Determine the vector pointing from the alien to the asteroid
-		float nx = (alien->positionVector[X_] - closest->positionVector[X_]);
-		float ny = (alien->positionVector[Y_] - closest->positionVector[Y_]);
+		// Determine the vector pointing from the alien to the asteroid (or the player if there are none)
+		float targetX = (closest < 0) ? p->positionVector[X_] : roids->posX[closest];
+		float targetY = (closest < 0) ? p->positionVector[Y_] : roids->posY[closest];
+		float nx = (alien->positionVector[X_] - targetX);
+		float ny = (alien->positionVector[Y_] - targetY);
 		float mag = sqrt((nx * nx) + (ny * ny));
 		// Set the direction of the missle with the unit vector of the vector we calculated
 		m->directionVector[X_] = -nx / mag;
@@ -123,8 +124,10 @@ void alienShoot(Alien* alien, ObjectList* asteroids, PlayerShip* p, ObjectList*
 		m->directionVector[Y_] = -ny / mag;
 	}
 
-	// Add the shot to the alien's list of shots
-	addToList(m, alienShots);
+	// The missle moves by the same amount every tick
+	motion->velX[slot] = m->vMag * m->directionVector[X_];
+	motion->velY[slot] = m->vMag * m->directionVector[Y_];
+
 	// Reset its cooldown
 	alien->missleCoolDown = ALIEN_COOLDOWN;
 
@@ -134,24 +137,25 @@ void alienShoot(Alien* alien, ObjectList* asteroids, PlayerShip* p, ObjectList*
 	This function updates a given alien according to its fields.
 	It also check if the alien has crossed a horizontal wall and will signal this on return.
 	@param a The alien to update.
+	@param dt How many base ticks this tick lasts.
 	@return True if this alien should still exist, false if it needs to be removed
  */
-bool updateAlien(Alien* a)
+bool updateAlien(Alien* a, float dt)
 {
 	// Update the position vector by the velocity vector
 	for (int i = 0; i < 2; i++)
-		a->positionVector[i] += a->vVector[i];
+		a->positionVector[i] += a->vVector[i] * dt;
 	// Update the spin by the speed
-	a->spin += a->spinSpeed;
+	a->spin += a->spinSpeed * dt;
 	// Decrement the cooldown if it can be
-	if (a->missleCoolDown != 0)
-		a->missleCoolDown -= PLAYER_CD_DELTA;
+	if (a->missleCoolDown > 0)
+		a->missleCoolDown -= PLAYER_CD_DELTA * dt;
 
 	// Check if we should change direction in Y
-	if ((a->directionTimer <= 0) && !(rand() % 9)){
+	if ((a->directionTimer <= 0) && !rngInt(&a->rng, 9)){
 		// Change y velocity
-		GLfloat vel;
-		for (vel = 0.0f; (vel < -0.06f) || (vel > 0.06f) || (vel == 0.0f) || (vel == -0.0f); vel = (float)1 / (10 + (25 + rand() % 100)));
+		float vel;
+		for (vel = 0.0f; (vel < -0.06f) || (vel > 0.06f) || (vel == 0.0f) || (vel == -0.0f); vel = (float)1 / (10 + (25 + rngInt(&a->rng, 100))));
 		// Check if the new velocity is in the same direction as the current
 		if ((vel > 0) && (a->vVector[Y_] > 0))
 			// Change it if so
@@ -164,7 +168,7 @@ bool updateAlien(Alien* a)
 	}
 	// Decrement the direction change timer
 	else if(a->directionTimer > 0)
-		a->directionTimer--;
+		a->directionTimer -= dt;
 
 	// Wrap the spin
 	if (a->spin >= 360)
@@ -198,20 +202,25 @@ bool updateAlien(Alien* a)
 	This function initializes an Alien ship with size determined by
 	the given parameter.
 	@param makeBig True if we are making a big alien ship, false if we are making a small one.
-	@return A pointer to the alien we made.
+	@param aliens The pool to make the alien in.
+	@param stream A freshly seeded stream, the alien takes it over as its own.
+	@return A pointer to the alien we made, or NULL if the pool is full.
  */
-Alien* initAlienShip(bool makeBig)
+Alien* initAlienShip(bool makeBig, ObjectPool* aliens, const Rng* stream)
 {
-	// Allocate space for the new alien
-	Alien* a = (Alien*)malloc(sizeof(Alien));
+	// Grab a slot for the new alien
+	Alien* a = (Alien*)poolAdd(aliens);
+	if (a == NULL)
+		return NULL;
 	// Set fields
 	a->missleCoolDown = ALIEN_COOLDOWN;
 	a->directionTimer = ALIEN_DIR_TIMER;
+	a->rng = *stream;
 
 	//Randomly pick position
-	if (rand() % 2){
+	if (rngInt(&a->rng, 2)){
 		a->positionVector[X_] = BOUND_X_LOWER + 0.5f;
-		a->positionVector[Y_] = (float)-1 * (rand() % 4);
+		a->positionVector[Y_] = (float)-1 * rngInt(&a->rng, 4);
 		//Set X velocity
 		if (makeBig)
 			a->vVector[X_] = ALIEN_LARGE_V_X;
@@ -220,7 +229,7 @@ Alien* initAlienShip(bool makeBig)
 	}
 	else {
 		a->positionVector[X_] = BOUND_X_UPPER - 0.5f;
-		a->positionVector[Y_] = (float)1 * (rand() % 4);
+		a->positionVector[Y_] = (float)1 * rngInt(&a->rng, 4);
 		//Set X velocity
 		if (makeBig)
 			a->vVector[X_] = -ALIEN_LARGE_V_X;
@@ -245,9 +254,9 @@ Alien* initAlienShip(bool makeBig)
 	a->mat[3] = 0.0f;
 
 	//Randomly set Y velocity
-	GLfloat vel;
-	for (vel = 0.0f; (vel < -0.06f) || (vel > 0.06f) || (vel == 0.0f) || (vel == -0.0f); vel = (float)1 / (10 + (25 + rand() % 100)));
-	if (rand() % 2)
+	float vel;
+	for (vel = 0.0f; (vel < -0.06f) || (vel > 0.06f) || (vel == 0.0f) || (vel == -0.0f); vel = (float)1 / (10 + (25 + rngInt(&a->rng, 100))));
+	if (rngInt(&a->rng, 2))
 		vel = -vel;
 	a->vVector[Y_] = vel;
 	
@@ -282,12 +291,15 @@ Alien* initAlienShip(bool makeBig)
 	@param x The x co-ordinate for where to create explosion.
 	@param y The y co-ordinate for where to create explosion.
 	@param z The z co-ordinate for where to create explosion.
-	@return A pointer to the explosion we made.
+	@param eList The pool to make the explosion in.
+	@return A pointer to the explosion we made, or NULL if the pool is full.
  */
-Explosion* makeExplosion(GLfloat x, GLfloat y, GLfloat z)
+Explosion* makeExplosion(float x, float y, float z, ObjectPool* eList)
 {
-	// Allocate space for the explosion object
-	Explosion* e = (Explosion*)malloc(sizeof(Explosion));
+	// Grab a slot for the explosion object
+	Explosion* e = (Explosion*)poolAdd(eList);
+	if (e == NULL)
+		return NULL;
 	// Set some fields
 	e->vMag = EXPLOSION_V;
 	e->age = 0;
@@ -335,16 +347,17 @@ Explosion* makeExplosion(GLfloat x, GLfloat y, GLfloat z)
 /*
 	This function updates an explosion.
 	@param e The explosion to update.
+	@param dt How many base ticks this tick lasts.
  */
-void updateExplosion(Explosion* e)
+void updateExplosion(Explosion* e, float dt)
 {
 	// Increment the age
-	e->age++;
+	e->age += dt;
 
 	// Update each point by its vMag and direction vector.
 	for (int i = 0; i < EXPLOSION_NUM_PTS; i++){
-		e->points[i][X_] += e->vMag * e->directions[i][X_];
-		e->points[i][Y_] += e->vMag * e->directions[i][Y_];
+		e->points[i][X_] += e->vMag * e->directions[i][X_] * dt;
+		e->points[i][Y_] += e->vMag * e->directions[i][Y_] * dt;
 	}
 }
 
@@ -352,65 +365,56 @@ void updateExplosion(Explosion* e)
 	This functions handles generating a missle for
 	a given player
 	@param p The pointer to the player ship to generate missles for
+	@param shots The pool to make the missle in
 	@return The missle fired, or NULL if one cannot be fired
 */
-Missle* fireShot(PlayerShip* p)
+Missle* fireShot(PlayerShip* p, ObjectPool* shots)
 {
 	// Check the player's cooldown
 	if (p->missleCoolDown > 0)
 		return NULL;
 
-	// Allocate space for a new missle
-	Missle* ret = (Missle*)malloc(sizeof(Missle));
+	// Grab a slot for a new missle
+	Missle* ret = (Missle*)poolAdd(shots);
+	if (ret == NULL)
+		return NULL;
 
-	// Set its age to zero
-	ret->age = 0;
-	for (int i = 0; i < 2; i++){
-		// Set its position to the player's ship
-		ret->positionVector[i] = p->positionVector[i];
+	for (int i = 0; i < 2; i++)
 		// Set the direction to the player's ship's
 		ret->directionVector[i] = p->directionUnitVector[i];
-		// Set the material
-		ret->mat[i] = missleMat[i];
-	}
-
-	// Set the z position
-	ret->positionVector[Z_] = p->positionVector[Z_];
 	// Set the material
-	ret->mat[3] = missleMat[3];
-	ret->mat[4] = missleMat[4];
+	for (int i = 0; i < 4; i++)
+		ret->mat[i] = missleMat[i];
 	// Set the missle's velocity to the velocity constant plus the player's
 	ret->vMag = MISSLE_V + p->vMag;
+
+	// Start it at the player's ship moving along its direction (the pool already zeroed its age)
+	int slot = poolIndexOf(ret, shots);
+	shots->motion->posX[slot] = p->positionVector[X_];
+	shots->motion->posY[slot] = p->positionVector[Y_];
+	shots->motion->velX[slot] = ret->vMag * ret->directionVector[X_];
+	shots->motion->velY[slot] = ret->vMag * ret->directionVector[Y_];
 	// Initialize the player's cooldown
 	p->missleCoolDown = PLAYER_COOLDOWN;
 	return ret;
 }
 
 /**
-	This function handles updating a given missle's parameters
-	@param m A pointer to the missle to update
+	This function moves and ages every missle in a pool in one pass,
+	then removes the missles that are too old
+	@param shots The pool of missles to update
+	@param dt How many base ticks this tick lasts
 */
-void updateMissle(Missle* m)
+void updateMissles(ObjectPool* shots, float dt)
 {
-	// Check the age, only update if it is young enough
-	if (m->age >= MISSLE_AGE_MAX)
-		return;
+	// Move, wrap, and age every slot at once
+	integrateMotion(shots->motion, shots->highWater, dt, MISSLE_AGE_DELTA * dt);
 
-	// Increment the age
-	m->age += MISSLE_AGE_DELTA;
-	// Update the position based on direction and velocity
-	m->positionVector[X_] += m->vMag * m->directionVector[X_];
-	m->positionVector[Y_] += m->vMag * m->directionVector[Y_];
-
-	// Wrap around the screen
-	if (m->positionVector[X_] > BOUND_X_UPPER)
-		m->positionVector[X_] -= 2 * BOUND_X_UPPER;
-	else if (m->positionVector[X_] < BOUND_X_LOWER)
-		m->positionVector[X_] -= 2 * BOUND_X_LOWER;
-	if (m->positionVector[Y_] > BOUND_Y_UPPER)
-		m->positionVector[Y_] -= 2 * BOUND_Y_UPPER;
-	else if (m->positionVector[Y_] < BOUND_Y_LOWER)
-		m->positionVector[Y_] -= 2 * BOUND_Y_LOWER;
+	// Remove any missle that has lived too long
+	for (int i = 0; i < shots->highWater; i++){
+		if (shots->live[i] && (shots->motion->age[i] >= MISSLE_AGE_MAX))
+			poolRemove(poolSlot(shots, i), shots);
+	}
 }
 
 /**
@@ -420,11 +424,11 @@ void updateMissle(Missle* m)
 	@param v2 The third vertex drawn in the triangle
 	@param normDest The reference to where to store the normal
 */
-void calculateNormal(GLfloat(&v0)[3], GLfloat(&v1)[3], GLfloat(&v2)[3], GLfloat(&normDest)[3])
+void calculateNormal(float(&v0)[3], float(&v1)[3], float(&v2)[3], float(&normDest)[3])
 {
 	// Calculate normal and store in normDest
-	GLfloat d0[] = { v1[X_] - v0[X_], v1[Y_] - v0[Y_], v1[Z_] - v0[Z_] };
-	GLfloat d1[] = { v2[X_] - v1[X_], v2[Y_] - v1[Y_], v2[Z_] - v1[Z_] };
+	float d0[] = { v1[X_] - v0[X_], v1[Y_] - v0[Y_], v1[Z_] - v0[Z_] };
+	float d1[] = { v2[X_] - v1[X_], v2[Y_] - v1[Y_], v2[Z_] - v1[Z_] };
 	normDest[X_] = (d0[Y_] * d1[Z_]) - (d0[Z_] * d1[Y_]);
 	normDest[Y_] = (d0[Z_] * d1[X_]) - (d0[X_] * d1[Z_]);
 	normDest[Z_] = (d0[X_] * d1[Y_]) - (d0[Y_] * d1[X_]);
@@ -433,22 +437,24 @@ void calculateNormal(GLfloat(&v0)[3], GLfloat(&v1)[3], GLfloat(&v2)[3], GLfloat(
 /**
 	This function updates a player ship's position and stuff
 	@param p The player ship to update
+	@param input The INPUT_ bits held down this tick
+	@param dt How many base ticks this tick lasts
 */
-void updatePlayer(PlayerShip* p)
+void updatePlayer(PlayerShip* p, unsigned int input, float dt)
 {
 	// Decrement the cooldown if needed
 	if (p->missleCoolDown > 0)
-		p->missleCoolDown -= PLAYER_CD_DELTA;
+		p->missleCoolDown -= PLAYER_CD_DELTA * dt;
 
 	// If we are not at max velocity and the acceleration key is down, we accelerate
-	if ((p->vMag < MAX_PLAYER_V) && (xKeyPressed))
-		p->vMag += PLAYER_A;
+	if ((p->vMag < MAX_PLAYER_V) && (input & INPUT_THRUST))
+		p->vMag += PLAYER_A * dt;
 
 	// If the left key is down spin counter-clockwise
-	if (leftKeyPressed)
+	if (input & INPUT_LEFT)
 		p->spinFactor = PLAYER_SPIN;
 	// If the right key is down spin clockwise
-	else if (rightKeyPressed)
+	else if (input & INPUT_RIGHT)
 		p->spinFactor = -PLAYER_SPIN;
 	// Otherwise, ensure we do not spin
 	else
@@ -456,7 +462,7 @@ void updatePlayer(PlayerShip* p)
 
 	// If there is a spin factor, update the spin angle (and wrap)
 	if (p->spinFactor != 0)
-		p->spin += p->spinFactor;
+		p->spin += p->spinFactor * dt;
 	if (p->spin > 360)
 		p->spin -= 360;
 	else if (p->spin < 0)
@@ -468,10 +474,10 @@ void updatePlayer(PlayerShip* p)
 
 	// If our velocity is non-zero move along the direction vector
 	if (p->vMag > 0.0f){
-		p->positionVector[X_] += p->vMag * p->directionUnitVector[X_];
-		p->positionVector[Y_] += p->vMag * p->directionUnitVector[Y_];
+		p->positionVector[X_] += p->vMag * p->directionUnitVector[X_] * dt;
+		p->positionVector[Y_] += p->vMag * p->directionUnitVector[Y_] * dt;
 		// Slow down according to the friction constant
-		p->vMag -= PLAYER_FRICTION;
+		p->vMag -= PLAYER_FRICTION * dt;
 		if (p->vMag < 0)
 			p->vMag = 0;
 	}
@@ -496,7 +502,7 @@ PlayerShip* initPlayer()
 	// Allocate space for a player ship
 	PlayerShip* ret = (PlayerShip*)malloc(sizeof(PlayerShip));
 	// Copy the ship verticies into the new ship object
-	memcpy(ret->verticies, spaceShip, NUM_SHIP_VERTS * 3 * sizeof(GLfloat));
+	memcpy(ret->verticies, spaceShip, NUM_SHIP_VERTS * 3 * sizeof(float));
 	// Set the number of verticies
 	ret->numVerticies = NUM_SHIP_VERTS;
 
@@ -538,329 +544,83 @@ PlayerShip* initPlayer()
 }
 
 /**
-	This function updates a given asteroid based on its properties
-	@param a A pointer to the asteroid to update
+	This function moves and spins every asteroid in a pool in one pass
+	@param asteroids The pool of asteroids to update
+	@param dt How many base ticks this tick lasts
 */
-void updateAsteroid(Asteroid* a)
+void updateAsteroids(ObjectPool* asteroids, float dt)
 {
-	// Move the asteroid by it's velocity
-	a->positionVector[X_] += a->vVector[X_];
-	a->positionVector[Y_] += a->vVector[Y_];
-
-	// Spin the asteroid by its spin factor (velocity)
-	a->spin += a->spinFactor;
-	// Wrap the angle
-	if (a->spin > 360.0f)
-		a->spin -= 360.0f;
-	else if (a->spin < 0.0f)
-		a->spin += 360.0f;
-
-	// Wrap the asteroid around the window
-	if (a->positionVector[X_] > BOUND_X_UPPER)
-		a->positionVector[X_] -= 2 * BOUND_X_UPPER;
-	else if (a->positionVector[X_] < BOUND_X_LOWER)
-		a->positionVector[X_] -= 2 * BOUND_X_LOWER;
-	if (a->positionVector[Y_] > BOUND_Y_UPPER)
-		a->positionVector[Y_] -= 2 * BOUND_Y_UPPER;
-	else if (a->positionVector[Y_] < BOUND_Y_LOWER)
-		a->positionVector[Y_] -= 2 * BOUND_Y_LOWER;
+	// Asteroids do not age as they move, they age when they split
+	integrateMotion(asteroids->motion, asteroids->highWater, dt, 0.0f);
 }
 
 
 /**
 	This function creates and returns an asteroid
-	@return The created asteroid
+	@param pool The pool to make the asteroid in
+	@param rng The stream to draw the asteroid's shape from
+	@return The created asteroid, or NULL if the pool is full
 */
-Asteroid* initAsteroid()
+Asteroid* initAsteroid(ObjectPool* pool, Rng* rng)
 {
-	// Allocate space for the asteroid
-	Asteroid* ret = (Asteroid*)malloc(sizeof(Asteroid));
-	// Create a 2D array for all the verticies in the asteroid
-	GLfloat vertsCpy[NUM_UNIQUE_SPH_PTS][3];
-	// Copy and roughed all the verticies in the unit sphere into vertsCpy
-	roughenSphere(vertsCpy, verts);
-	// Order all the verticies so we can draw the asteroid with triangles
-	updateRoughSphere(vertsCpy, ret->verticies);
-	// Set the number of verticies
-	ret->numVerticies = NUM_SPHERE_VERTS;
+	// Grab a slot for the asteroid
+	Asteroid* ret = (Asteroid*)poolAdd(pool);
+	if (ret == NULL)
+		return NULL;
+	// Pick one of the shared shapes for the asteroid
+	ret->variant = rngInt(rng, NUM_ASTEROID_VARIANTS);
 
-	// Calculate normals for all the triangles
-	for (int i = 0; i < NUM_SPHERE_VERTS ; i += 3)
-		calculateNormal(ret->verticies[i], ret->verticies[i + 1], ret->verticies[i + 2], ret->normals[i/3]);
-	// Set the number of normals
-	ret->numNorms = NUM_SPHERE_NORMS;
-	
 	// Set the material
 	ret->mat[0] = 0.9f;
 	ret->mat[1] = 0.0f;
 	ret->mat[2] = 0.9f;
 	ret->mat[3] = 0.0f;
 
-	// Initialize orientation, position, and velocity
+	// Initialize orientation and scale (position, velocity, and spin start zeroed in the pool)
 	for (int i = 0; i < 3; i++){
 		ret->orientation[i] = 0.0f;
-		ret->positionVector[i] = 0.0f;
 		ret->scale[i] = 1.0f;
-		if (i < 2)
-			ret->vVector[i] = 0.0f;
 	}
 
-	// Initialize spin, spin factor, and age
-	ret->spin = 0.0f;
-	ret->spinFactor = 0.0f;
+	// Initialize age
 	ret->age = 2;
 
 	// Return the asteroid
 	return ret;
 }
 
-/**
-	This function set the global for left key pressed
-	@param The boolean value to set it to
-*/
-void setKeyLeft(bool isDown)
-{
-	leftKeyPressed = isDown;
-}
-
-/**
-	This function set the global for right key pressed
-	@param The boolean value to set it to
-*/
-void setKeyRight(bool isDown)
-{
-	rightKeyPressed = isDown;
-}
-
-/**
-	This function set the global for X key pressed
-	@param The boolean value to set it to
-*/
-void setKeyX(bool isDown)
-{
-	xKeyPressed = isDown;
-}
-
 /**
 	This function randomly disturbs verticies on the sphere
 */
-void roughenSphere(GLfloat(&verts)[NUM_UNIQUE_SPH_PTS][3], const GLfloat(&srcVerts)[NUM_UNIQUE_SPH_PTS][3])
+void roughenSphere(float(&verts)[NUM_UNIQUE_SPH_PTS][3], const float(&srcVerts)[NUM_UNIQUE_SPH_PTS][3], Rng* rng)
 {
 	// For through all the unique verticie
 	for (int i = 0; i < NUM_UNIQUE_SPH_PTS; i++){
 		for (int j = 0; j < 3; j++){
 			// For each vertex coordinate, generate a random delta and move the coordinate that much
-			float d = (float)(rand() % 10) / (float) 24.0;
+			float d = (float)rngInt(rng, 10) / (float) 24.0;
 			verts[i][j] = srcVerts[i][j] + d;
 		}
 	}
 }
 
 /**
-	This function updates the sphere with the disturbed verticies
+	This function builds the shared library of asteroid shapes. It is only needed to draw them,
+	an asteroid just remembers which shape it uses.
+	@param variants Where to put the shapes, room for NUM_ASTEROID_VARIANTS of them
+	@param seed The seed to roughen the shapes with
 */
-void updateRoughSphere(GLfloat(&verts)[NUM_UNIQUE_SPH_PTS][3], GLfloat(&dest)[NUM_SPHERE_VERTS][3])
+void buildAsteroidVariants(AsteroidMesh* variants, uint64_t seed)
 {
-	// All the unique verticies are in the 2D verts array
-	// We build a sphere using though verticies
-	// If they have been disturbed then the sphere will look disturbed
-	GLfloat roughSphereTemplate[NUM_SPHERE_VERTS][3] = {
-		// Triangles for top quater
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[1][0], verts[1][1], verts[1][2] },
-		{ verts[2][0], verts[2][1], verts[2][2] },
-
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[2][0], verts[2][1], verts[2][2] },
-		{ verts[3][0], verts[3][1], verts[3][2] },
-
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[3][0], verts[3][1], verts[3][2] },
-		{ verts[4][0], verts[4][1], verts[4][2] },
-
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[4][0], verts[4][1], verts[4][2] },
-		{ verts[5][0], verts[5][1], verts[5][2] },
-
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[5][0], verts[5][1], verts[5][2] },
-		{ verts[6][0], verts[6][1], verts[6][2] },
-
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[6][0], verts[6][1], verts[6][2] },
-		{ verts[7][0], verts[7][1], verts[7][2] },
-
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[7][0], verts[7][1], verts[7][2] },
-		{ verts[8][0], verts[8][1], verts[8][2] },
-
-		{ verts[0][0], verts[0][1], verts[0][2] },
-		{ verts[8][0], verts[8][1], verts[8][2] },
-		{ verts[1][0], verts[1][1], verts[1][2] },
-
-		// Triangles for upper middle quater
-		{ verts[1][0], verts[1][1], verts[1][2] },
-		{ verts[9][0], verts[9][1], verts[9][2] },
-		{ verts[2][0], verts[2][1], verts[2][2] },
-
-		{ verts[2][0], verts[2][1], verts[2][2] },
-		{ verts[9][0], verts[9][1], verts[9][2] },
-		{ verts[10][0], verts[10][1], verts[10][2] },
-
-		{ verts[2][0], verts[2][1], verts[2][2] },
-		{ verts[10][0], verts[10][1], verts[10][2] },
-		{ verts[3][0], verts[3][1], verts[3][2] },
-
-		{ verts[3][0], verts[3][1], verts[3][2] },
-		{ verts[10][0], verts[10][1], verts[10][2] },
-		{ verts[11][0], verts[11][1], verts[11][2] },
-
-		{ verts[3][0], verts[3][1], verts[3][2] },
-		{ verts[11][0], verts[11][1], verts[11][2] },
-		{ verts[4][0], verts[4][1], verts[4][2] },
-
-		{ verts[4][0], verts[4][1], verts[4][2] },
-		{ verts[11][0], verts[11][1], verts[11][2] },
-		{ verts[12][0], verts[12][1], verts[12][2] },
-
-		{ verts[4][0], verts[4][1], verts[4][2] },
-		{ verts[12][0], verts[12][1], verts[12][2] },
-		{ verts[5][0], verts[5][1], verts[5][2] },
-
-		{ verts[5][0], verts[5][1], verts[5][2] },
-		{ verts[12][0], verts[12][1], verts[12][2] },
-		{ verts[13][0], verts[13][1], verts[13][2] },
-
-		{ verts[5][0], verts[5][1], verts[5][2] },
-		{ verts[13][0], verts[13][1], verts[13][2] },
-		{ verts[6][0], verts[6][1], verts[6][2] },
-
-		{ verts[6][0], verts[6][1], verts[6][2] },
-		{ verts[13][0], verts[13][1], verts[13][2] },
-		{ verts[14][0], verts[14][1], verts[14][2] },
-
-		{ verts[6][0], verts[6][1], verts[6][2] },
-		{ verts[14][0], verts[14][1], verts[14][2] },
-		{ verts[7][0], verts[7][1], verts[7][2] },
-
-		{ verts[7][0], verts[7][1], verts[7][2] },
-		{ verts[14][0], verts[14][1], verts[14][2] },
-		{ verts[15][0], verts[15][1], verts[15][2] },
-
-		{ verts[7][0], verts[7][1], verts[7][2] },
-		{ verts[15][0], verts[15][1], verts[15][2] },
-		{ verts[8][0], verts[8][1], verts[8][2] },
-
-		{ verts[8][0], verts[8][1], verts[8][2] },
-		{ verts[15][0], verts[15][1], verts[15][2] },
-		{ verts[16][0], verts[16][1], verts[16][2] },
-
-		{ verts[8][0], verts[8][1], verts[8][2] },
-		{ verts[16][0], verts[16][1], verts[16][2] },
-		{ verts[1][0], verts[1][1], verts[1][2] },
-
-		{ verts[1][0], verts[1][1], verts[1][2] },
-		{ verts[16][0], verts[16][1], verts[16][2] },
-		{ verts[9][0], verts[9][1], verts[9][2] },
-
-		// Triangles for lower middle quater
-		{ verts[9][0], verts[9][1], verts[9][2] },
-		{ verts[16][0], verts[16][1], verts[16][2] },
-		{ verts[17][0], verts[17][1], verts[17][2] },
-
-		{ verts[17][0], verts[17][1], verts[17][2] },
-		{ verts[16][0], verts[16][1], verts[16][2] },
-		{ verts[18][0], verts[18][1], verts[18][2] },
-
-		{ verts[16][0], verts[16][1], verts[16][2] },
-		{ verts[15][0], verts[15][1], verts[15][2] },
-		{ verts[18][0], verts[18][1], verts[18][2] },
-
-		{ verts[18][0], verts[18][1], verts[18][2] },
-		{ verts[15][0], verts[15][1], verts[15][2] },
-		{ verts[19][0], verts[19][1], verts[19][2] },
-
-		{ verts[15][0], verts[15][1], verts[15][2] },
-		{ verts[14][0], verts[14][1], verts[14][2] },
-		{ verts[19][0], verts[19][1], verts[19][2] },
-
-		{ verts[19][0], verts[19][1], verts[19][2] },
-		{ verts[14][0], verts[14][1], verts[14][2] },
-		{ verts[20][0], verts[20][1], verts[20][2] },
-
-		{ verts[14][0], verts[14][1], verts[14][2] },
-		{ verts[13][0], verts[13][1], verts[13][2] },
-		{ verts[20][0], verts[20][1], verts[20][2] },
-
-		{ verts[20][0], verts[20][1], verts[20][2] },
-		{ verts[13][0], verts[13][1], verts[13][2] },
-		{ verts[21][0], verts[21][1], verts[21][2] },
-
-		{ verts[13][0], verts[13][1], verts[13][2] },
-		{ verts[12][0], verts[12][1], verts[12][2] },
-		{ verts[21][0], verts[21][1], verts[21][2] },
-
-		{ verts[21][0], verts[21][1], verts[21][2] },
-		{ verts[12][0], verts[12][1], verts[12][2] },
-		{ verts[22][0], verts[22][1], verts[22][2] },
-
-		{ verts[12][0], verts[12][1], verts[12][2] },
-		{ verts[11][0], verts[11][1], verts[11][2] },
-		{ verts[22][0], verts[22][1], verts[22][2] },
-
-		{ verts[22][0], verts[22][1], verts[22][2] },
-		{ verts[11][0], verts[11][1], verts[11][2] },
-		{ verts[23][0], verts[23][1], verts[23][2] },
-
-		{ verts[11][0], verts[11][1], verts[11][2] },
-		{ verts[10][0], verts[10][1], verts[10][2] },
-		{ verts[23][0], verts[23][1], verts[23][2] },
-
-		{ verts[23][0], verts[23][1], verts[23][2] },
-		{ verts[10][0], verts[10][1], verts[10][2] },
-		{ verts[24][0], verts[24][1], verts[24][2] },
-
-		{ verts[10][0], verts[10][1], verts[10][2] },
-		{ verts[9][0], verts[9][1], verts[9][2] },
-		{ verts[24][0], verts[24][1], verts[24][2] },
-
-		{ verts[24][0], verts[24][1], verts[24][2] },
-		{ verts[9][0], verts[9][1], verts[9][2] },
-		{ verts[17][0], verts[17][1], verts[17][2] },
-
-		// Triangles for lower quarter
-		{ verts[17][0], verts[17][1], verts[17][2] },
-		{ verts[18][0], verts[18][1], verts[18][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] },
-
-		{ verts[18][0], verts[18][1], verts[18][2] },
-		{ verts[19][0], verts[19][1], verts[19][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] },
-
-		{ verts[19][0], verts[19][1], verts[19][2] },
-		{ verts[20][0], verts[20][1], verts[20][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] },
-
-		{ verts[20][0], verts[20][1], verts[20][2] },
-		{ verts[21][0], verts[21][1], verts[21][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] },
-
-		{ verts[21][0], verts[21][1], verts[21][2] },
-		{ verts[22][0], verts[22][1], verts[22][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] },
-
-		{ verts[22][0], verts[22][1], verts[22][2] },
-		{ verts[23][0], verts[23][1], verts[23][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] },
-
-		{ verts[23][0], verts[23][1], verts[23][2] },
-		{ verts[24][0], verts[24][1], verts[24][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] },
-
-		{ verts[24][0], verts[24][1], verts[24][2] },
-		{ verts[17][0], verts[17][1], verts[17][2] },
-		{ verts[25][0], verts[25][1], verts[25][2] }
-	};
-	// Copy the local array to the global one for the sphere
-	memcpy(dest, roughSphereTemplate, sizeof(roughSphereTemplate));
+	// The shapes get their own stream so building them never touches a world's
+	Rng rng;
+	seedRng(&rng, seed, 0);
+	for (int v = 0; v < NUM_ASTEROID_VARIANTS; v++){
+		AsteroidMesh* mesh = &variants[v];
+		// Copy and roughen all the verticies in the unit sphere
+		roughenSphere(mesh->verticies, verts, &rng);
+		// Calculate normals for all the triangles
+		for (int i = 0; i < NUM_SPHERE_VERTS; i += 3)
+			calculateNormal(mesh->verticies[sphereIndices[i]], mesh->verticies[sphereIndices[i + 1]], mesh->verticies[sphereIndices[i + 2]], mesh->normals[i / 3]);
+	}
 }
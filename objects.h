@@ -1,5 +1,3 @@
-#include "GL/glut.h"
-#include <iostream>
 #include <stdlib.h>
 
 
@@ -7,6 +5,7 @@
 #define __ASTOBJS__
 
 #include "datastructures.h"
+#include "rng.h"
 
 /**
     @file models.h
@@ -41,6 +40,10 @@
 #define NUM_SHIP_NORMS 4
 // The number of unique points in a sphere
 #define NUM_UNIQUE_SPH_PTS 26
+// The number of differently roughened asteroid shapes, every asteroid is drawn with one of them
+#define NUM_ASTEROID_VARIANTS 16
+// The seed the asteroid shapes are roughened with, so they are the same every run
+#define ASTEROID_VARIANT_SEED 0x5EEDA57E401DULL
 
 
 // Constants for the player
@@ -64,6 +67,17 @@
 #define PLAYER_CD_DELTA 25
 // The initial number of lives / deaths a player starts with
 #define PLAYER_DEATHS_INIT 5
+// Bits in a tick's input for each control the player can use
+#define INPUT_LEFT 0x01
+#define INPUT_RIGHT 0x02
+#define INPUT_THRUST 0x04
+#define INPUT_FIRE 0x08
+
+
+// Time parameters
+
+// The tick rate every per-tick constant in this file was tuned for
+#define SIM_BASE_HZ 40
 
 
 // Window parameters
@@ -71,6 +85,8 @@
 #define BOUND_X_LOWER -6.0f
 #define BOUND_Y_UPPER 6.0f
 #define BOUND_Y_LOWER -6.0f
+// The depth everything in the game lives at
+#define Z_LEVEL -14.0f
 
 
 // Constants for missles
@@ -125,13 +141,25 @@
 #define ALIEN_LARGE_TOR_RINGS 8
 
 
+// Pool sizes, the most of each kind of object that can exist at once
+
+// The most asteroids that can be alive at once
+#define MAX_ASTEROIDS 256
+// The most missles that can be in flight at once (per shooter)
+#define MAX_MISSLES 256
+// The most aliens that can be alive at once
+#define MAX_ALIENS 32
+// The most explosions that can be going at once
+#define MAX_EXPLOSIONS 256
+
+
 // Constants for x, y, and z since they're everywhere
 #define X_ 0
 #define Y_ 1
 #define Z_ 2
 
 // All the vertices needed to draw a sphere
-const GLfloat verts[26][3] = {
+const float verts[26][3] = {
 		{ 0.0f, 1.0f, 0.0f },
 		{ 0.0f, ROOT2OV2, ROOT2OV2 },
 		{ ROOTROOT2OV2, ROOTROOT2OV2, ROOTROOT2OV2 },
@@ -160,8 +188,64 @@ const GLfloat verts[26][3] = {
 		{ 0.0f, -1.0f, 0.0f }
 };
 
+// Which of the sphere's unique vertices make up each of its triangles, three to a triangle
+const unsigned char sphereIndices[NUM_SPHERE_VERTS] = {
+		// Triangles for top quater
+		0, 1, 2,
+		0, 2, 3,
+		0, 3, 4,
+		0, 4, 5,
+		0, 5, 6,
+		0, 6, 7,
+		0, 7, 8,
+		0, 8, 1,
+		// Triangles for upper middle quater
+		1, 9, 2,
+		2, 9, 10,
+		2, 10, 3,
+		3, 10, 11,
+		3, 11, 4,
+		4, 11, 12,
+		4, 12, 5,
+		5, 12, 13,
+		5, 13, 6,
+		6, 13, 14,
+		6, 14, 7,
+		7, 14, 15,
+		7, 15, 8,
+		8, 15, 16,
+		8, 16, 1,
+		1, 16, 9,
+		// Triangles for lower middle quater
+		9, 16, 17,
+		17, 16, 18,
+		16, 15, 18,
+		18, 15, 19,
+		15, 14, 19,
+		19, 14, 20,
+		14, 13, 20,
+		20, 13, 21,
+		13, 12, 21,
+		21, 12, 22,
+		12, 11, 22,
+		22, 11, 23,
+		11, 10, 23,
+		23, 10, 24,
+		10, 9, 24,
+		24, 9, 17,
+		// Triangles for lower quarter
+		17, 18, 25,
+		18, 19, 25,
+		19, 20, 25,
+		20, 21, 25,
+		21, 22, 25,
+		22, 23, 25,
+		23, 24, 25,
+		24, 17, 25
+};
+
 // All the vertices needed to draw our player's spaceship
-const GLfloat spaceShip[12][3] = {
+const float spaceShip[12][3] = {
 		//Base
 		{ 0.0f, 0.0f, 1.35f },
 		{ -1.0f, 0.0f, -0.65f },
@@ -181,14 +265,26 @@ const GLfloat spaceShip[12][3] = {
 		{ 1.0f, 0.0f, -0.65f }
 };
 
+// A struct holding where an object can be hit, in world space
+// It is rebuilt once a tick after everything moves (see updateColliders in smack.h)
+typedef struct {
+	// The center of the object
+	float center[2];
+	// The radius of a circle around all of the object
+	float radius;
+	// The corners of a box around all of the object
+	float min[2];
+	float max[2];
+} Collider;
+
 // A struct to model an alien ship
 typedef struct {
 	// The position in 3D space
-	GLfloat positionVector[3];
+	float positionVector[3];
 	// The axes deterimining rotational orientation in 3D
-	GLfloat orientation[3];
+	float orientation[3];
 	// The velocity vector in 2D
-	GLfloat vVector[2];
+	float vVector[2];
 	// The material to draw with
 	float mat[4];
 	// What angle the ship is rotated by
@@ -198,9 +294,11 @@ typedef struct {
 	// Whether or not this is a large alien
 	bool isBig;
 	// The cooldown for the alien's missles
-	unsigned int missleCoolDown;
+	float missleCoolDown;
 	// A timer for when we can try to change direction
-	unsigned int directionTimer;
+	float directionTimer;
+	// This alien's own stream of random numbers for steering and aiming
+	Rng rng;
 	// Sphere parameters for drawing
 	float sphereRadius;
 	int sphereSlices;
@@ -210,12 +308,20 @@ typedef struct {
 	float torusOuterRadius;
 	int torusSides;
 	int torusRings;
+	// Where the alien can be hit this tick
+	Collider collider;
+	// The full width and height of the alien's box against asteroids
+	float asteroidBox[2];
+	// Half the width and height of the alien's box against missles
+	float shotBox[2];
+	// Half the width and height of the alien's box against the player
+	float playerBox[2];
 } Alien;
 
 // A struct for modeling a player's ship
 typedef struct {
 	// The vertices used to draw the ship
-	GLfloat verticies[NUM_SHIP_VERTS][3];
+	float verticies[NUM_SHIP_VERTS][3];
 	// This player's score
 	int score;
 	// How many lives / deaths the player has
@@ -223,85 +329,85 @@ typedef struct {
 	// The number of vertices (also a constant)
 	int numVerticies;
 	// All the normals for this player's model
-	GLfloat normals[NUM_SHIP_NORMS][3];
+	float normals[NUM_SHIP_NORMS][3];
 	// The number of normals
 	int numNorms;
 	// The material to draw with
 	float mat[4];
 	// The cooldown for the player's missles
-	unsigned int missleCoolDown;
+	float missleCoolDown;
 	// Where the player is in 3D space
-	GLfloat positionVector[3];
+	float positionVector[3];
 	// The axis to rotate by in 3D
-	GLfloat orientation[3];
+	float orientation[3];
 	// The size of the model
-	GLfloat scale[3];
+	float scale[3];
 	// The direction the player is headed in 2D
-	GLfloat directionUnitVector[2];
+	float directionUnitVector[2];
 	// The magnitude of the player's acceleration
-	GLfloat aMag;
+	float aMag;
 	// The magnitude of the player's velocity
-	GLfloat vMag;
+	float vMag;
 	// The angle the player is pointed
-	GLfloat spin;
+	float spin;
 	// How much to turn the player by on an update
-	GLfloat spinFactor;
+	float spinFactor;
+	// Where the ship can be hit this tick
+	Collider collider;
+	// The three points of the ship's hull in world space this tick
+	float hull[3][2];
 } PlayerShip;
 
+// A struct holding one roughened asteroid shape, drawn with the triangles in sphereIndices
+typedef struct {
+	// The unique points of the shape
+	float verticies[NUM_UNIQUE_SPH_PTS][3];
+	// The normal of each triangle
+	float normals[NUM_SPHERE_NORMS][3];
+} AsteroidMesh;
+
 // A struct modeling an asteroid
+// Its position, velocity, and spin live in the motion store of the asteroid pool
 typedef struct {
-	// All the vertices used to draw the asteroid
-	GLfloat verticies[NUM_SPHERE_VERTS][3];
-	// The number of vertices (also a constant)
-	int numVerticies;
-	// All the normals for this asteroid
-	GLfloat normals[NUM_SPHERE_NORMS][3];
-	// The number of normals for this asteroid (also a constant)
-	int numNorms;
+	// Which of the shared asteroid shapes to draw this asteroid with
+	int variant;
 	// How many times has this asteroid been split
 	int age;
 	// The material to draw this asteroid with
 	float mat[4];
-	// Where this asteroid is in 3D space
-	GLfloat positionVector[3];
 	// What axis to rotate this asteroid by
-	GLfloat orientation[3];
+	float orientation[3];
 	// The size of the asteroid
-	GLfloat scale[3];
-	// The velocity vector the asteroid is moving in
-	GLfloat vVector[2];
-	// The angle the asteroid is rotated at
-	GLfloat spin;
-	// How much to increment / decrement the spin by
-	GLfloat spinFactor;
+	float scale[3];
+	// Where the asteroid can be hit this tick
+	Collider collider;
+	// The full width and height of the asteroid's box against aliens
+	float alienBox[2];
 } Asteroid;
 
 // A struct modeling a missle
+// Its position, velocity, and age live in the motion store of its pool
 typedef struct {
-	// Where the missle in in 3D space
-	GLfloat positionVector[3];
 	// What direction the missle is headed in
-	GLfloat directionVector[2];
+	float directionVector[2];
 	// The magnitude of the missle's velocity
-	GLfloat vMag;
+	float vMag;
 	// The material of the missle (no longer used)
-	GLfloat mat[4];
-	// How long this missle has been traveling
-	unsigned int age;
+	float mat[4];
 } Missle;
 
 // A struct modeling an explosion
 typedef struct {
 	// The magnitude of the velocity for each bit of the explosion
-	GLfloat vMag;
+	float vMag;
 	// The position of the explosion in 3D space
-	GLfloat positionVector[3];
+	float positionVector[3];
 	// All the points in the explosion as 3D points
-	GLfloat points[EXPLOSION_NUM_PTS][3];
+	float points[EXPLOSION_NUM_PTS][3];
 	// The unit vectors for each point
-	GLfloat directions[EXPLOSION_NUM_PTS][2];
+	float directions[EXPLOSION_NUM_PTS][2];
 	// How long the explosion has been around
-	int age;
+	float age;
 	// The material to draw the explosion with (no longer needed)
 	float mat[4];
 
@@ -310,8 +416,10 @@ typedef struct {
 /**
 	This function updates a player ship's position and stuff
 	@param p The player ship to update
+	@param input The INPUT_ bits held down this tick
+	@param dt How many base ticks this tick lasts
 */
-void updatePlayer(PlayerShip* p);
+void updatePlayer(PlayerShip* p, unsigned int input, float dt);
 
 /**
 	This function initialized a player ship
@@ -320,26 +428,32 @@ void updatePlayer(PlayerShip* p);
 PlayerShip* initPlayer();
 
 /**
-	This function updates a given asteroid based on its properties
-	@param a A pointer to the asteroid to update
+	This function moves and spins every asteroid in a pool in one pass
+	@param asteroids The pool of asteroids to update
+	@param dt How many base ticks this tick lasts
 */
-void updateAsteroid(Asteroid* a);
+void updateAsteroids(ObjectPool* asteroids, float dt);
 
 /**
 	This function creates and returns an asteroid
-	@return The created asteroid
+	@param pool The pool to make the asteroid in
+	@param rng The stream to draw the asteroid's shape from
+	@return The created asteroid, or NULL if the pool is full
 */
-Asteroid* initAsteroid();
+Asteroid* initAsteroid(ObjectPool* pool, Rng* rng);
 
 /**
-	This function updates the sphere with the disturbed verticies
+	This function builds the shared library of asteroid shapes. It is only needed to draw them,
+	an asteroid just remembers which shape it uses.
+	@param variants Where to put the shapes, room for NUM_ASTEROID_VARIANTS of them
+	@param seed The seed to roughen the shapes with
 */
-void updateRoughSphere(GLfloat(&verts)[NUM_UNIQUE_SPH_PTS][3], GLfloat(&dest)[NUM_SPHERE_VERTS][3]);
+void buildAsteroidVariants(AsteroidMesh* variants, uint64_t seed);
 
 /**
 	This function randomly disturbs verticies on the sphere
 */
-void roughenSphere(GLfloat(&verts)[NUM_UNIQUE_SPH_PTS][3], const GLfloat(&srcVerts)[NUM_UNIQUE_SPH_PTS][3]);
+void roughenSphere(float(&verts)[NUM_UNIQUE_SPH_PTS][3], const float(&srcVerts)[NUM_UNIQUE_SPH_PTS][3], Rng* rng);
 
 /**
 	This function calculates a normal vector for a triangle with 3 given vectors
@@ -348,78 +462,68 @@ void roughenSphere(GLfloat(&verts)[NUM_UNIQUE_SPH_PTS][3], const GLfloat(&srcVer
 	@param v2 The third vertex drawn in the triangle
 	@param normDest The reference to where to store the normal
 */
-void calculateNormal(GLfloat(&v0)[3], GLfloat(&v1)[3], GLfloat(&v3)[3], GLfloat(&normDest)[3]);
+void calculateNormal(float(&v0)[3], float(&v1)[3], float(&v3)[3], float(&normDest)[3]);
 
 /**
 	This functions handles generating a missle for
 	a given player
 	@param p The pointer to the player ship to generate missles for
+	@param shots The pool to make the missle in
 	@return The missle fired, or NULL if one cannot be fired
 */
-Missle* fireShot(PlayerShip* p);
-
-/**
-	This function handles updating a given missle's parameters
-	@param m A pointer to the missle to update
-*/
-void updateMissle(Missle* m);
-
-/**
-	This function set the global for left key pressed
-	@param The boolean value to set it to
-*/
-void setKeyLeft(bool isDown);
-
-/**
-	This function set the global for right key pressed
-	@param The boolean value to set it to
-*/
-void setKeyRight(bool isDown);
+Missle* fireShot(PlayerShip* p, ObjectPool* shots);
 
 /**
-	This function set the global for X key pressed
-	@param The boolean value to set it to
+	This function moves and ages every missle in a pool in one pass,
+	then removes the missles that are too old
+	@param shots The pool of missles to update
+	@param dt How many base ticks this tick lasts
 */
-void setKeyX(bool isDown);
+void updateMissles(ObjectPool* shots, float dt);
 
 /*
 	This function creates an explosion object at the given location.
 	@param x The x co-ordinate for where to create explosion.
 	@param y The y co-ordinate for where to create explosion.
 	@param z The z co-ordinate for where to create explosion.
-	@return A pointer to the explosion we made.
+	@param eList The pool to make the explosion in.
+	@return A pointer to the explosion we made, or NULL if the pool is full.
 */
-Explosion* makeExplosion(GLfloat x, GLfloat y, GLfloat z);
+Explosion* makeExplosion(float x, float y, float z, ObjectPool* eList);
 
 /*
 	This function updates an explosion.
 	@param e The explosion to update.
+	@param dt How many base ticks this tick lasts.
 */
-void updateExplosion(Explosion* e);
+void updateExplosion(Explosion* e, float dt);
 
 /*
 	This function initializes an Alien ship with size determined by
 	the given parameter.
 	@param makeBig True if we are making a big alien ship, false if we are making a small one.
-	@return A pointer to the alien we made.
+	@param aliens The pool to make the alien in.
+	@param stream A freshly seeded stream, the alien takes it over as its own.
+	@return A pointer to the alien we made, or NULL if the pool is full.
 */
-Alien* initAlienShip(bool makeBig);
+Alien* initAlienShip(bool makeBig, ObjectPool* aliens, const Rng* stream);
 
 /*
 	This function updates a given alien according to its fields.
 	It also check if the alien has crossed a horizontal wall and will signal this on return.
 	@param a The alien to update.
+	@param dt How many base ticks this tick lasts.
 	@return True if this alien should still exist, false if it needs to be removed
 */
-bool updateAlien(Alien* a);
+bool updateAlien(Alien* a, float dt);
 
 /*
 	This function handles an alien shooting at various objects in the game world.
 	@param alien The alien doing the shooting.
-	@param asteroids The list of asteroid in the game.
+	@param asteroids The pool of asteroids in the game.
 	@param p The player in the game.
-	@param alienShots The list of alien shots.
+	@param alienShots The pool of alien shots.
 */
-void alienShoot(Alien* alien, ObjectList* asteroids, PlayerShip* p, ObjectList* alienShots);
+void alienShoot(Alien* alien, ObjectPool* asteroids, PlayerShip* p, ObjectPool* alienShots);
 
 #endif
@@ -0,0 +1,239 @@
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "profiler.h"
+#include "trace.h"
+
+/*
+	@file profiler.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the phase profiler. Each frame in the history is guarded by its own
+	sequence number (a seqlock), so the recording thread never waits and readers simply skip
+	any frame that changed under them.
+ */
+
+// The names of the phases, in the same order as the enum
+const char* phaseNames[NUM_PHASES] = {
+	"tick",
+	"alien spawn",
+	"alien update",
+	"asteroid update",
+	"explosion update",
+	"player update",
+	"missle update",
+	"collider update",
+	"grid build",
+	"collide player",
+	"collide asteroids",
+	"collide aliens",
+	"level",
+	"draw",
+	"draw blend",
+	"draw build",
+	"draw submit",
+	"draw hud",
+	"draw shade",
+	"draw capture",
+	"draw swap"
+};
+
+// The names of the counters, in the same order as the enum
+const char* counterNames[NUM_COUNTERS] = {
+	"asteroids",
+	"missles",
+	"aliens",
+	"explosions",
+	"collision tests"
+};
+
+/*
+	This function creates a profiler with an empty history.
+	@return A pointer to the profiler that was made.
+*/
+Profiler* createProfiler()
+{
+	// The atomics need real constructors
+	Profiler* profiler = new Profiler();
+	memset(&profiler->current, 0, sizeof(profiler->current));
+	memset(profiler->frames, 0, sizeof(profiler->frames));
+	for (int i = 0; i < PROFILE_HISTORY; i++)
+		profiler->sequences[i].store(0);
+	profiler->head.store(0);
+	return profiler;
+}
+
+/*
+	This function frees a profiler.
+	@param profiler A pointer to the profiler to destroy.
+*/
+void destroyProfiler(Profiler* profiler)
+{
+	delete profiler;
+}
+
+/*
+	This function reads the clock the profiler uses.
+	@return The time in nanoseconds since some fixed point.
+*/
+int64_t profileNow()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+	This function starts recording a new tick / frame.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+*/
+void profileBeginFrame(Profiler* profiler)
+{
+	if (profiler == NULL)
+		return;
+	memset(&profiler->current, 0, sizeof(profiler->current));
+}
+
+/*
+	This function finishes the tick / frame being recorded and adds it to the history.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+*/
+void profileEndFrame(Profiler* profiler)
+{
+	if (profiler == NULL)
+		return;
+	uint64_t head = profiler->head.load(std::memory_order_relaxed);
+	int slot = (int)(head & (PROFILE_HISTORY - 1));
+
+	// Mark the slot as being written, copy the frame in, then mark it done
+	uint32_t sequence = profiler->sequences[slot].load(std::memory_order_relaxed);
+	profiler->sequences[slot].store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	profiler->frames[slot] = profiler->current;
+	profiler->sequences[slot].store(sequence + 2, std::memory_order_release);
+
+	// Publish it
+	profiler->head.store(head + 1, std::memory_order_release);
+}
+
+/*
+	This function adds time to a phase of the tick / frame being recorded.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+	@param phase The phase to add to.
+	@param ns The time in nanoseconds.
+*/
+void profileAdd(Profiler* profiler, int phase, int64_t ns)
+{
+	if (profiler == NULL)
+		return;
+	profiler->current.phaseNs[phase] += (uint32_t)ns;
+}
+
+/*
+	This function sets a counter for the tick / frame being recorded.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+	@param counter The counter to set.
+	@param value The value to set it to.
+*/
+void profileCount(Profiler* profiler, int counter, uint32_t value)
+{
+	if (profiler == NULL)
+		return;
+	profiler->current.counters[counter] = value;
+}
+
+/*
+	This function starts a lap timer. Laps are recorded into the profiler and, if a trace
+	is running, into the trace as well.
+	@param timer A pointer to the timer to start.
+	@param profiler A pointer to the profiler to record into, or NULL for only the trace.
+*/
+void startProfileTimer(ProfileTimer* timer, Profiler* profiler)
+{
+	timer->profiler = profiler;
+	timer->tracing = traceEnabled();
+	timer->last = ((profiler != NULL) || timer->tracing) ? profileNow() : 0;
+}
+
+/*
+	This function ends the current lap, charging the time since the last lap to a phase.
+	@param timer A pointer to the timer.
+	@param phase The phase the lap that just ended belongs to.
+*/
+void profileLap(ProfileTimer* timer, int phase)
+{
+	// Skip reading the clock entirely when profiling and tracing are off
+	if ((timer->profiler == NULL) && !timer->tracing)
+		return;
+	int64_t now = profileNow();
+	profileAdd(timer->profiler, phase, now - timer->last);
+	if (timer->tracing)
+		traceEvent(phaseNames[phase], timer->last, now);
+	timer->last = now;
+}
+
+/*
+	This function charges everything from some earlier point up to the end of the last lap to a phase.
+	@param timer A pointer to the timer.
+	@param phase The phase to charge.
+	@param start When the phase started, the last value of timer->last before its first lap.
+*/
+void profileSpan(ProfileTimer* timer, int phase, int64_t start)
+{
+	profileAdd(timer->profiler, phase, timer->last - start);
+	if (timer->tracing)
+		traceEvent(phaseNames[phase], start, timer->last);
+}
+
+/*
+	This function copies the finished frames out of a profiler's history, oldest first.
+	It never blocks the thread recording, frames being overwritten while we copy are skipped.
+	@param profiler A pointer to the profiler to read.
+	@param out Where to copy the frames, there must be room for PROFILE_HISTORY of them.
+	@return The number of frames copied.
+*/
+int profileHistory(Profiler* profiler, ProfileFrame* out)
+{
+	uint64_t head = profiler->head.load(std::memory_order_acquire);
+	uint64_t first = (head > PROFILE_HISTORY) ? (head - PROFILE_HISTORY) : 0;
+	int count = 0;
+	for (uint64_t f = first; f < head; f++){
+		int slot = (int)(f & (PROFILE_HISTORY - 1));
+		// Copy the frame and keep it only if nobody wrote to it while we did
+		uint32_t before = profiler->sequences[slot].load(std::memory_order_acquire);
+		if (before & 1)
+			continue;
+		out[count] = profiler->frames[slot];
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (profiler->sequences[slot].load(std::memory_order_relaxed) == before)
+			count++;
+	}
+	return count;
+}
+
+/*
+	This function works out the mean, 99th percentile, and max of every phase over some frames.
+	@param frames The frames to look at.
+	@param count The number of frames.
+	@param stats Where to put the stats for each phase (NUM_PHASES of them).
+*/
+void profileSummarize(const ProfileFrame* frames, int count, ProfileStats* stats)
+{
+	uint32_t values[PROFILE_HISTORY];
+	for (int phase = 0; phase < NUM_PHASES; phase++){
+		ProfileStats* s = &stats[phase];
+		s->mean = s->p99 = s->max = 0.0f;
+		if (count == 0)
+			continue;
+
+		// Gather this phase's times and add them up
+		double total = 0.0;
+		for (int i = 0; i < count; i++){
+			values[i] = frames[i].phaseNs[phase];
+			total += values[i];
+		}
+		s->mean = (float)(total / count);
+		s->max = (float)*std::max_element(values, values + count);
+		// Partially sort just far enough to find the 99th percentile
+		int rank = (count * 99) / 100;
+		std::nth_element(values, values + rank, values + count);
+		s->p99 = (float)values[rank];
+	}
+}
@@ -0,0 +1,198 @@
+#ifndef __PROFILER__
+#define __PROFILER__
+
+#include <stdint.h>
+#include <atomic>
+
+/*
+	@file profiler.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines a profiler that times each phase of a tick (or a frame) and keeps
+	the last PROFILE_HISTORY of them in a ring buffer. One thread records into a profiler and any
+	thread can read its history without ever blocking the one recording.
+*/
+
+// The number of ticks / frames of history kept (must be a power of 2)
+#define PROFILE_HISTORY 256
+
+// Every phase that gets timed, the simulation phases come first
+enum {
+	PHASE_TICK,
+	PHASE_ALIEN_SPAWN,
+	PHASE_ALIEN_UPDATE,
+	PHASE_ASTEROID_UPDATE,
+	PHASE_EXPLOSION_UPDATE,
+	PHASE_PLAYER_UPDATE,
+	PHASE_MISSLE_UPDATE,
+	PHASE_COLLIDER_UPDATE,
+	PHASE_GRID_BUILD,
+	PHASE_COLLIDE_PLAYER,
+	PHASE_COLLIDE_ASTEROIDS,
+	PHASE_COLLIDE_ALIENS,
+	PHASE_LEVEL,
+	PHASE_DRAW,
+	PHASE_DRAW_BLEND,
+	PHASE_DRAW_BUILD,
+	PHASE_DRAW_SUBMIT,
+	PHASE_DRAW_HUD,
+	PHASE_DRAW_SHADE,
+	PHASE_DRAW_CAPTURE,
+	PHASE_DRAW_SWAP,
+	NUM_PHASES
+};
+// The first drawing phase, everything before it is simulation
+#define PHASE_FIRST_DRAW PHASE_DRAW
+
+// Every count that gets recorded each tick
+enum {
+	COUNTER_ASTEROIDS,
+	COUNTER_MISSLES,
+	COUNTER_ALIENS,
+	COUNTER_EXPLOSIONS,
+	COUNTER_COLLISION_TESTS,
+	NUM_COUNTERS
+};
+
+// The names of the phases and counters, for showing them
+extern const char* phaseNames[NUM_PHASES];
+extern const char* counterNames[NUM_COUNTERS];
+
+// A struct holding everything recorded for one tick / frame
+typedef struct {
+	// How long each phase took in nanoseconds
+	uint32_t phaseNs[NUM_PHASES];
+	// The value of each counter
+	uint32_t counters[NUM_COUNTERS];
+} ProfileFrame;
+
+// A struct holding a summary of one phase over the history
+typedef struct {
+	// The mean, 99th percentile, and max time in nanoseconds
+	float mean;
+	float p99;
+	float max;
+} ProfileStats;
+
+// A struct holding a profiler and its history
+typedef struct {
+	// The tick / frame being recorded, only the recording thread touches it
+	ProfileFrame current;
+	// The last PROFILE_HISTORY frames that were finished
+	ProfileFrame frames[PROFILE_HISTORY];
+	// A sequence number for each frame, odd while the frame is being written
+	std::atomic<uint32_t> sequences[PROFILE_HISTORY];
+	// The number of frames finished so far
+	std::atomic<uint64_t> head;
+} Profiler;
+
+// A struct for timing phases one after another, each lap ends one phase and starts the next
+typedef struct {
+	// The profiler being recorded into, or NULL if profiling is off
+	Profiler* profiler;
+	// Whether each lap also goes into the trace (see trace.h)
+	bool tracing;
+	// When the last lap ended in nanoseconds
+	int64_t last;
+} ProfileTimer;
+
+/*
+	This function creates a profiler with an empty history.
+	@return A pointer to the profiler that was made.
+ */
+Profiler* createProfiler();
+
+/*
+	This function frees a profiler.
+	@param profiler A pointer to the profiler to destroy.
+ */
+void destroyProfiler(Profiler* profiler);
+
+/*
+	This function reads the clock the profiler uses.
+	@return The time in nanoseconds since some fixed point.
+ */
+int64_t profileNow();
+
+/*
+	This function starts recording a new tick / frame.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+ */
+void profileBeginFrame(Profiler* profiler);
+
+/*
+	This function finishes the tick / frame being recorded and adds it to the history.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+ */
+void profileEndFrame(Profiler* profiler);
+
+/*
+	This function adds time to a phase of the tick / frame being recorded.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+	@param phase The phase to add to.
+	@param ns The time in nanoseconds.
+ */
+void profileAdd(Profiler* profiler, int phase, int64_t ns);
+
+/*
+	This function sets a counter for the tick / frame being recorded.
+	@param profiler A pointer to the profiler, or NULL to do nothing.
+	@param counter The counter to set.
+	@param value The value to set it to.
+ */
+void profileCount(Profiler* profiler, int counter, uint32_t value);
+
+/*
+	This function starts a lap timer. Laps are recorded into the profiler and, if a trace
+	is running, into the trace as well.
+	@param timer A pointer to the timer to start.
+	@param profiler A pointer to the profiler to record into, or NULL for only the trace.
+ */
+void startProfileTimer(ProfileTimer* timer, Profiler* profiler);
+
+/*
+	This function ends the current lap, charging the time since the last lap to a phase.
+	@param timer A pointer to the timer.
+	@param phase The phase the lap that just ended belongs to.
+ */
+void profileLap(ProfileTimer* timer, int phase);
+
+/*
+	This function charges everything from some earlier point up to the end of the last lap to a phase.
+	@param timer A pointer to the timer.
+	@param phase The phase to charge.
+	@param start When the phase started, the last value of timer->last before its first lap.
+ */
+void profileSpan(ProfileTimer* timer, int phase, int64_t start);
+
+/*
+	This function copies the finished frames out of a profiler's history, oldest first.
+	It never blocks the thread recording, frames being overwritten while we copy are skipped.
+	@param profiler A pointer to the profiler to read.
+	@param out Where to copy the frames, there must be room for PROFILE_HISTORY of them.
+	@return The number of frames copied.
+ */
+int profileHistory(Profiler* profiler, ProfileFrame* out);
+
+/*
+	This function works out the mean, 99th percentile, and max of every phase over some frames.
+	@param frames The frames to look at.
+	@param count The number of frames.
+	@param stats Where to put the stats for each phase (NUM_PHASES of them).
+ */
+void profileSummarize(const ProfileFrame* frames, int count, ProfileStats* stats);
+
+// A struct that times the scope it lives in and charges it to a phase when the scope ends
+struct ProfileScope {
+	Profiler* profiler;
+	int phase;
+	int64_t start;
+	ProfileScope(Profiler* p, int ph) : profiler(p), phase(ph), start((p != NULL) ? profileNow() : 0) {}
+	~ProfileScope() { if (profiler != NULL) profileAdd(profiler, phase, profileNow() - start); }
+};
+
+// Times the rest of the current scope as the given phase
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(profiler, phase) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(profiler, phase)
+
+#endif
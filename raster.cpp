@@ -0,0 +1,789 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "raster.h"
+
+/*
+	@file raster.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the software rasterizer. Setting up and binning runs on the calling
+	thread, then the worker threads (workers.h) claim tiles one at a time and shade them: clear,
+	every triangle in the order it was added (with a depth test), every point, then every glyph on top.
+	Edge functions are stepped in fixed point, AVX2 or SSE2 is picked at compile time for the
+	inner loop, with a plain loop for everything else.
+ */
+
+// Pick the widest vector unit the compiler is allowed to use
+#if defined(__AVX2__)
+#define RASTER_AVX2
+#define RASTER_LANES 8
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RASTER_SSE2
+#define RASTER_LANES 4
+#include <emmintrin.h>
+#else
+#define RASTER_LANES 1
+#endif
+
+//Because there is no pi in zmath :(
+#define PI 3.14159265f
+// One pixel, and half of one, in sub-pixels
+#define SUBPIXEL_ONE (1 << RASTER_SUBPIXEL_BITS)
+#define SUBPIXEL_HALF (SUBPIXEL_ONE / 2)
+// Edge values are clamped to this at the start of each row, far enough out that a row of a tile
+// can never step them back across zero, and close enough in that stepping never overflows
+#define EDGE_LIMIT (1 << 30)
+// How much room the growing arrays start with
+#define RASTER_START_SIZE 256
+
+// The light initLighting sets up, one white directional light with no specular
+static const float lightAmbient = 0.2f;
+static const float lightDiffuse = 0.8f;
+static const float lightDirection[3] = { 0.0f, 0.39392f, 0.91914f };
+
+/*
+	This function packs a color into one pixel.
+	@param r The red part (0 to 1).
+	@param g The green part (0 to 1).
+	@param b The blue part (0 to 1).
+	@param a The alpha part (0 to 1).
+	@return The pixel, RGBA bytes in memory order.
+ */
+static uint32_t packColor(float r, float g, float b, float a)
+{
+	float parts[4] = { r, g, b, a };
+	unsigned char bytes[4];
+	for (int i = 0; i < 4; i++){
+		float c = (parts[i] < 0.0f) ? 0.0f : ((parts[i] > 1.0f) ? 1.0f : parts[i]);
+		bytes[i] = (unsigned char)((c * 255.0f) + 0.5f);
+	}
+	uint32_t pixel;
+	memcpy(&pixel, bytes, sizeof(pixel));
+	return pixel;
+}
+
+/*
+	This function makes sure a growing array has room for one more item.
+	@param items The array.
+	@param count How many items are in it.
+	@param capacity How many fit, updated if it grows.
+	@param size The size of one item.
+ */
+static void reserveItem(void** items, int count, int* capacity, size_t size)
+{
+	if (count < *capacity)
+		return;
+	*capacity = (*capacity == 0) ? RASTER_START_SIZE : (*capacity * 2);
+	*items = realloc(*items, (size_t)*capacity * size);
+}
+
+/*
+	This function adds an item to every tile a rectangle of pixels touches.
+	@param raster A pointer to the rasterizer.
+	@param bins The bins of the kind of item.
+	@param item The index of the item.
+	@param minX The leftmost pixel.
+	@param minY The bottom pixel.
+	@param maxX The rightmost pixel.
+	@param maxY The top pixel.
+ */
+static void binItem(Rasterizer* raster, RasterBin* bins, int item, int minX, int minY, int maxX, int maxY)
+{
+	for (int ty = minY / RASTER_TILE_SIZE; ty <= (maxY / RASTER_TILE_SIZE); ty++){
+		for (int tx = minX / RASTER_TILE_SIZE; tx <= (maxX / RASTER_TILE_SIZE); tx++){
+			RasterBin* bin = &bins[(ty * raster->tilesX) + tx];
+			reserveItem((void**)&bin->items, bin->count, &bin->capacity, sizeof(int));
+			bin->items[bin->count++] = item;
+		}
+	}
+}
+
+/*
+	This function clips a rectangle of pixels to the frame.
+	@param raster A pointer to the rasterizer.
+	@param minX The leftmost pixel, moved onto the frame.
+	@param minY The bottom pixel, moved onto the frame.
+	@param maxX The rightmost pixel, moved onto the frame.
+	@param maxY The top pixel, moved onto the frame.
+	@return True if any of the rectangle is left.
+ */
+static bool clipToFrame(const Rasterizer* raster, int* minX, int* minY, int* maxX, int* maxY)
+{
+	if (*minX < 0)
+		*minX = 0;
+	if (*minY < 0)
+		*minY = 0;
+	if (*maxX >= raster->width)
+		*maxX = raster->width - 1;
+	if (*maxY >= raster->height)
+		*maxY = raster->height - 1;
+	return (*minX <= *maxX) && (*minY <= *maxY);
+}
+
+/*
+	This function puts a point in front of the camera onto the frame.
+	@param raster A pointer to the rasterizer.
+	@param p The point.
+	@param out Where to put the pixel co-ordinates and depth, and 1 if it is in front of the near plane or 0 if not.
+ */
+static void projectPoint(const Rasterizer* raster, const float p[3], float out[4])
+{
+	float distance = -p[Z_];
+	// (written so a broken point that is not a number is dropped too)
+	if (!(distance >= RASTER_NEAR)){
+		out[3] = 0.0f;
+		return;
+	}
+	out[0] = (raster->width * 0.5f) + ((raster->xScale * p[X_]) / distance);
+	out[1] = (raster->height * 0.5f) + ((raster->yScale * p[Y_]) / distance);
+	out[2] = raster->zOffset - (raster->zScale / distance);
+	out[3] = 1.0f;
+}
+
+/*
+	This function finds the smallest of three values.
+	@param v The values.
+	@return The smallest.
+ */
+static inline int min3(const int v[3])
+{
+	int m = (v[0] < v[1]) ? v[0] : v[1];
+	return (m < v[2]) ? m : v[2];
+}
+
+/*
+	This function finds the largest of three values.
+	@param v The values.
+	@return The largest.
+ */
+static inline int max3(const int v[3])
+{
+	int m = (v[0] > v[1]) ? v[0] : v[1];
+	return (m > v[2]) ? m : v[2];
+}
+
+/*
+	This function checks if a point from projectPoint is close enough to the screen to set up.
+	@param raster A pointer to the rasterizer.
+	@param v The point.
+	@return True if it is in front of the camera and inside the guard band.
+ */
+static bool inGuardBand(const Rasterizer* raster, const float v[4])
+{
+	// (written so a broken point that is not a number is dropped too)
+	return (v[3] != 0.0f) && (v[0] >= -RASTER_GUARD_BAND) && (v[0] <= (raster->width + RASTER_GUARD_BAND)) &&
+		(v[1] >= -RASTER_GUARD_BAND) && (v[1] <= (raster->height + RASTER_GUARD_BAND)) && (v[2] == v[2]);
+}
+
+/*
+	This function sets up a triangle and bins it, if it faces the camera and is on the screen.
+	@param raster A pointer to the rasterizer.
+	@param v The corners of the triangle from projectPoint, counter clockwise if it faces the camera.
+	@param color The color of the triangle.
+ */
+static void addTriangle(Rasterizer* raster, const float* v[3], uint32_t color)
+{
+	// Drop anything behind the camera or far off the screen
+	int x[3];
+	int y[3];
+	for (int k = 0; k < 3; k++){
+		if (!inGuardBand(raster, v[k]))
+			return;
+		// Snap the corners to sub-pixels
+		x[k] = (int)lrintf(v[k][0] * SUBPIXEL_ONE);
+		y[k] = (int)lrintf(v[k][1] * SUBPIXEL_ONE);
+	}
+	// Drop it if it faces away (or has no area), like glCullFace(GL_BACK)
+	int64_t area = ((int64_t)(x[1] - x[0]) * (y[2] - y[0])) - ((int64_t)(x[2] - x[0]) * (y[1] - y[0]));
+	if (area <= 0)
+		return;
+
+	// Find the pixels whose centers it could cover
+	int minX = (min3(x) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1) >> RASTER_SUBPIXEL_BITS;
+	int minY = (min3(y) - SUBPIXEL_HALF + SUBPIXEL_ONE - 1) >> RASTER_SUBPIXEL_BITS;
+	int maxX = (max3(x) - SUBPIXEL_HALF) >> RASTER_SUBPIXEL_BITS;
+	int maxY = (max3(y) - SUBPIXEL_HALF) >> RASTER_SUBPIXEL_BITS;
+	if (!clipToFrame(raster, &minX, &minY, &maxX, &maxY))
+		return;
+
+	reserveItem((void**)&raster->triangles, raster->numTriangles, &raster->triangleCapacity, sizeof(RasterTriangle));
+	RasterTriangle* t = &raster->triangles[raster->numTriangles];
+	// An edge from each corner to the next, positive on the inside
+	for (int k = 0; k < 3; k++){
+		int j = (k + 1) % 3;
+		t->a[k] = y[k] - y[j];
+		t->b[k] = x[j] - x[k];
+		t->c[k] = -(((int64_t)t->a[k] * x[k]) + ((int64_t)t->b[k] * y[k]));
+		// Pixels exactly on an edge belong to only one of the two triangles sharing it
+		if (!((t->a[k] > 0) || ((t->a[k] == 0) && (t->b[k] < 0))))
+			t->c[k] -= 1;
+	}
+	// The plane the depth lies on, from the snapped corners
+	float x0 = (float)x[0] / SUBPIXEL_ONE;
+	float y0 = (float)y[0] / SUBPIXEL_ONE;
+	float dx1 = ((float)x[1] / SUBPIXEL_ONE) - x0;
+	float dy1 = ((float)y[1] / SUBPIXEL_ONE) - y0;
+	float dx2 = ((float)x[2] / SUBPIXEL_ONE) - x0;
+	float dy2 = ((float)y[2] / SUBPIXEL_ONE) - y0;
+	float dz1 = v[1][2] - v[0][2];
+	float dz2 = v[2][2] - v[0][2];
+	float pixelArea = (float)area / (SUBPIXEL_ONE * SUBPIXEL_ONE);
+	t->x0 = x0;
+	t->y0 = y0;
+	t->z0 = v[0][2];
+	t->dzdx = ((dz1 * dy2) - (dz2 * dy1)) / pixelArea;
+	t->dzdy = ((dz2 * dx1) - (dz1 * dx2)) / pixelArea;
+	t->minX = minX;
+	t->minY = minY;
+	t->maxX = maxX;
+	t->maxY = maxY;
+	t->color = color;
+	binItem(raster, raster->triangleBins, raster->numTriangles, minX, minY, maxX, maxY);
+	raster->numTriangles++;
+}
+
+/*
+	This function sets up every triangle of one mesh command.
+	@param raster A pointer to the rasterizer.
+	@param command The mesh command.
+ */
+static void addMesh(Rasterizer* raster, const DrawCommand* command)
+{
+	const MeshLibrary* meshes = raster->meshes;
+	const MeshSet* set = &meshes->sets[command->mesh];
+	const float (*points)[4] = meshes->texels + set->pointBase + (command->variant * set->meshPoints);
+	const float (*normals)[4] = meshes->texels + set->normalBase + (command->variant * set->meshNormals);
+	const unsigned short* indices = meshes->indices + set->indexBase;
+	const float (&model)[3][4] = command->model;
+
+	// Put every corner of the mesh on the screen once
+	if (set->meshPoints > raster->cornerCapacity){
+		raster->cornerCapacity = set->meshPoints;
+		raster->corners = (float(*)[4])realloc(raster->corners, raster->cornerCapacity * sizeof(float[4]));
+	}
+	for (int i = 0; i < set->meshPoints; i++){
+		float p[3];
+		for (int row = 0; row < 3; row++)
+			p[row] = (model[row][0] * points[i][X_]) + (model[row][1] * points[i][Y_]) + (model[row][2] * points[i][Z_]) + model[row][3];
+		projectPoint(raster, p, raster->corners[i]);
+	}
+
+	// Light each triangle flat the way the mesh shader does, then set it up
+	for (int i = 0; (i + 2) < set->numIndices; i += 3){
+		const float* normal = normals[i / 3];
+		float n[3];
+		for (int row = 0; row < 3; row++)
+			n[row] = (model[row][0] * normal[X_]) + (model[row][1] * normal[Y_]) + (model[row][2] * normal[Z_]);
+		float length = sqrt((n[X_] * n[X_]) + (n[Y_] * n[Y_]) + (n[Z_] * n[Z_]));
+		float facing = 0.0f;
+		if (length > 0.0f)
+			facing = ((n[X_] * lightDirection[X_]) + (n[Y_] * lightDirection[Y_]) + (n[Z_] * lightDirection[Z_])) / length;
+		float light = lightAmbient + ((facing > 0.0f) ? (facing * lightDiffuse) : 0.0f);
+		uint32_t color = packColor(light * command->mat[0], light * command->mat[1], light * command->mat[2], command->mat[3]);
+		const float* v[3] = { raster->corners[indices[i]], raster->corners[indices[i + 1]], raster->corners[indices[i + 2]] };
+		addTriangle(raster, v, color);
+	}
+}
+
+/*
+	This function sets up every point of one point command, as squares the way GL draws them.
+	@param raster A pointer to the rasterizer.
+	@param command The point command.
+	@param points The frame's points.
+ */
+static void addPoints(Rasterizer* raster, const DrawCommand* command, const PointVertex* points)
+{
+	int size = (int)(command->size + 0.5f);
+	if (size < 1)
+		size = 1;
+	for (int i = command->first; i < (command->first + command->count); i++){
+		float v[4];
+		projectPoint(raster, points[i].pos, v);
+		if (!inGuardBand(raster, v))
+			continue;
+		// The pixels whose centers are inside the square
+		int minX = (int)floorf(v[0] + 0.5f - (size * 0.5f));
+		int minY = (int)floorf(v[1] + 0.5f - (size * 0.5f));
+		int maxX = minX + size - 1;
+		int maxY = minY + size - 1;
+		if (!clipToFrame(raster, &minX, &minY, &maxX, &maxY))
+			continue;
+
+		reserveItem((void**)&raster->points, raster->numPoints, &raster->pointCapacity, sizeof(RasterPoint));
+		RasterPoint* p = &raster->points[raster->numPoints];
+		p->minX = minX;
+		p->minY = minY;
+		p->maxX = maxX;
+		p->maxY = maxY;
+		p->z = v[2];
+		memcpy(&p->color, points[i].color, sizeof(p->color));
+		binItem(raster, raster->pointBins, raster->numPoints, minX, minY, maxX, maxY);
+		raster->numPoints++;
+	}
+}
+
+/*
+	This function clamps an edge value at the start of a row so stepping it can never overflow.
+	@param value The edge value.
+	@return The clamped value.
+ */
+static inline int clampEdge(int64_t value)
+{
+	if (value > EDGE_LIMIT)
+		return EDGE_LIMIT;
+	if (value < -EDGE_LIMIT)
+		return -EDGE_LIMIT;
+	return (int)value;
+}
+
+#if defined(RASTER_AVX2)
+
+/*
+	This function shades one row of a triangle inside a tile, eight pixels at a time with AVX2.
+	@param t The triangle.
+	@param y The row.
+	@param minX The leftmost pixel to shade.
+	@param maxX The rightmost pixel to shade.
+	@param color The row of the frame's color.
+	@param depth The row of the frame's depth.
+ */
+static void shadeRow(const RasterTriangle* t, int y, int minX, int maxX, uint32_t* color, float* depth)
+{
+	// Start on a whole vector, the tile is a whole number of them so this never leaves it
+	int start = minX & ~(RASTER_LANES - 1);
+	int64_t px = ((int64_t)start << RASTER_SUBPIXEL_BITS) + SUBPIXEL_HALF;
+	int64_t py = ((int64_t)y << RASTER_SUBPIXEL_BITS) + SUBPIXEL_HALF;
+	const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	__m256i edge[3];
+	__m256i edgeStep[3];
+	for (int k = 0; k < 3; k++){
+		int step = t->a[k] << RASTER_SUBPIXEL_BITS;
+		edge[k] = _mm256_add_epi32(_mm256_set1_epi32(clampEdge((t->a[k] * px) + (t->b[k] * py) + t->c[k])), _mm256_mullo_epi32(lane, _mm256_set1_epi32(step)));
+		edgeStep[k] = _mm256_set1_epi32(step * RASTER_LANES);
+	}
+	float zStart = t->z0 + (t->dzdx * ((start + 0.5f) - t->x0)) + (t->dzdy * ((y + 0.5f) - t->y0));
+	__m256 z = _mm256_add_ps(_mm256_set1_ps(zStart), _mm256_mul_ps(_mm256_cvtepi32_ps(lane), _mm256_set1_ps(t->dzdx)));
+	const __m256 zStep = _mm256_set1_ps(t->dzdx * RASTER_LANES);
+	__m256i x = _mm256_add_epi32(_mm256_set1_epi32(start), lane);
+	const __m256i xStep = _mm256_set1_epi32(RASTER_LANES);
+	const __m256i lower = _mm256_set1_epi32(minX - 1);
+	const __m256i upper = _mm256_set1_epi32(maxX + 1);
+	const __m256 fill = _mm256_castsi256_ps(_mm256_set1_epi32((int)t->color));
+
+	for (int i = start; i <= maxX; i += RASTER_LANES){
+		// Inside every edge (no sign bits) and inside the span
+		__m256i outside = _mm256_srai_epi32(_mm256_or_si256(_mm256_or_si256(edge[0], edge[1]), edge[2]), 31);
+		__m256i span = _mm256_and_si256(_mm256_cmpgt_epi32(x, lower), _mm256_cmpgt_epi32(upper, x));
+		__m256i cover = _mm256_andnot_si256(outside, span);
+		if (!_mm256_testz_si256(cover, cover)){
+			// Then nearer than what is there
+			__m256 old = _mm256_loadu_ps(depth + i);
+			__m256 pass = _mm256_and_ps(_mm256_cmp_ps(z, old, _CMP_LT_OQ), _mm256_castsi256_ps(cover));
+			_mm256_storeu_ps(depth + i, _mm256_blendv_ps(old, z, pass));
+			__m256 pixels = _mm256_loadu_ps((const float*)(color + i));
+			_mm256_storeu_ps((float*)(color + i), _mm256_blendv_ps(pixels, fill, pass));
+		}
+		for (int k = 0; k < 3; k++)
+			edge[k] = _mm256_add_epi32(edge[k], edgeStep[k]);
+		z = _mm256_add_ps(z, zStep);
+		x = _mm256_add_epi32(x, xStep);
+	}
+}
+
+#elif defined(RASTER_SSE2)
+
+/*
+	This function shades one row of a triangle inside a tile, four pixels at a time with SSE2.
+	@param t The triangle.
+	@param y The row.
+	@param minX The leftmost pixel to shade.
+	@param maxX The rightmost pixel to shade.
+	@param color The row of the frame's color.
+	@param depth The row of the frame's depth.
+ */
+static void shadeRow(const RasterTriangle* t, int y, int minX, int maxX, uint32_t* color, float* depth)
+{
+	// Start on a whole vector, the tile is a whole number of them so this never leaves it
+	int start = minX & ~(RASTER_LANES - 1);
+	int64_t px = ((int64_t)start << RASTER_SUBPIXEL_BITS) + SUBPIXEL_HALF;
+	int64_t py = ((int64_t)y << RASTER_SUBPIXEL_BITS) + SUBPIXEL_HALF;
+	__m128i edge[3];
+	__m128i edgeStep[3];
+	for (int k = 0; k < 3; k++){
+		int step = t->a[k] << RASTER_SUBPIXEL_BITS;
+		edge[k] = _mm_add_epi32(_mm_set1_epi32(clampEdge((t->a[k] * px) + (t->b[k] * py) + t->c[k])), _mm_setr_epi32(0, step, step * 2, step * 3));
+		edgeStep[k] = _mm_set1_epi32(step * RASTER_LANES);
+	}
+	float zStart = t->z0 + (t->dzdx * ((start + 0.5f) - t->x0)) + (t->dzdy * ((y + 0.5f) - t->y0));
+	__m128 z = _mm_add_ps(_mm_set1_ps(zStart), _mm_mul_ps(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f), _mm_set1_ps(t->dzdx)));
+	const __m128 zStep = _mm_set1_ps(t->dzdx * RASTER_LANES);
+	__m128i x = _mm_setr_epi32(start, start + 1, start + 2, start + 3);
+	const __m128i xStep = _mm_set1_epi32(RASTER_LANES);
+	const __m128i lower = _mm_set1_epi32(minX - 1);
+	const __m128i upper = _mm_set1_epi32(maxX + 1);
+	const __m128 fill = _mm_castsi128_ps(_mm_set1_epi32((int)t->color));
+
+	for (int i = start; i <= maxX; i += RASTER_LANES){
+		// Inside every edge (no sign bits) and inside the span
+		__m128i outside = _mm_srai_epi32(_mm_or_si128(_mm_or_si128(edge[0], edge[1]), edge[2]), 31);
+		__m128i span = _mm_and_si128(_mm_cmpgt_epi32(x, lower), _mm_cmpgt_epi32(upper, x));
+		__m128i cover = _mm_andnot_si128(outside, span);
+		if (_mm_movemask_epi8(cover) != 0){
+			// Then nearer than what is there
+			__m128 old = _mm_loadu_ps(depth + i);
+			__m128 pass = _mm_and_ps(_mm_cmplt_ps(z, old), _mm_castsi128_ps(cover));
+			_mm_storeu_ps(depth + i, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, old)));
+			__m128 pixels = _mm_loadu_ps((const float*)(color + i));
+			_mm_storeu_ps((float*)(color + i), _mm_or_ps(_mm_and_ps(pass, fill), _mm_andnot_ps(pass, pixels)));
+		}
+		for (int k = 0; k < 3; k++)
+			edge[k] = _mm_add_epi32(edge[k], edgeStep[k]);
+		z = _mm_add_ps(z, zStep);
+		x = _mm_add_epi32(x, xStep);
+	}
+}
+
+#else
+
+/*
+	This function shades one row of a triangle inside a tile, one pixel at a time.
+	@param t The triangle.
+	@param y The row.
+	@param minX The leftmost pixel to shade.
+	@param maxX The rightmost pixel to shade.
+	@param color The row of the frame's color.
+	@param depth The row of the frame's depth.
+ */
+static void shadeRow(const RasterTriangle* t, int y, int minX, int maxX, uint32_t* color, float* depth)
+{
+	int64_t px = ((int64_t)minX << RASTER_SUBPIXEL_BITS) + SUBPIXEL_HALF;
+	int64_t py = ((int64_t)y << RASTER_SUBPIXEL_BITS) + SUBPIXEL_HALF;
+	int edge[3];
+	int edgeStep[3];
+	for (int k = 0; k < 3; k++){
+		edge[k] = clampEdge((t->a[k] * px) + (t->b[k] * py) + t->c[k]);
+		edgeStep[k] = t->a[k] << RASTER_SUBPIXEL_BITS;
+	}
+	float z = t->z0 + (t->dzdx * ((minX + 0.5f) - t->x0)) + (t->dzdy * ((y + 0.5f) - t->y0));
+
+	for (int i = minX; i <= maxX; i++){
+		// Inside every edge and nearer than what is there
+		if (((edge[0] | edge[1] | edge[2]) >= 0) && (z < depth[i])){
+			depth[i] = z;
+			color[i] = t->color;
+		}
+		for (int k = 0; k < 3; k++)
+			edge[k] += edgeStep[k];
+		z += t->dzdx;
+	}
+}
+
+#endif
+
+/*
+	This function shades one tile: clears it, then draws every triangle, point, and glyph that
+	touches it. It is run on the worker threads.
+	@param data A pointer to the rasterizer.
+	@param tile The tile to shade.
+ */
+static void shadeTile(void* data, int tile)
+{
+	Rasterizer* raster = (Rasterizer*)data;
+	int tileX = (tile % raster->tilesX) * RASTER_TILE_SIZE;
+	int tileY = (tile / raster->tilesX) * RASTER_TILE_SIZE;
+	int stride = raster->stride;
+
+	// Clear all of it, padding included (nobody else touches it)
+	// Each array gets its own loop so the compiler can clear it a vector at a time
+	const uint32_t clear = packColor(0.0f, 0.0f, 0.0f, 0.0f);
+	for (int y = tileY; y < (tileY + RASTER_TILE_SIZE); y++){
+		uint32_t* color = raster->color + ((size_t)y * stride) + tileX;
+		float* depth = raster->depth + ((size_t)y * stride) + tileX;
+		for (int x = 0; x < RASTER_TILE_SIZE; x++)
+			color[x] = clear;
+		for (int x = 0; x < RASTER_TILE_SIZE; x++)
+			depth[x] = 1.0f;
+	}
+
+	// The triangles, in the order they were added
+	const RasterBin* bin = &raster->triangleBins[tile];
+	for (int i = 0; i < bin->count; i++){
+		const RasterTriangle* t = &raster->triangles[bin->items[i]];
+		int minX = (t->minX > tileX) ? t->minX : tileX;
+		int maxX = (t->maxX < (tileX + RASTER_TILE_SIZE - 1)) ? t->maxX : (tileX + RASTER_TILE_SIZE - 1);
+		int minY = (t->minY > tileY) ? t->minY : tileY;
+		int maxY = (t->maxY < (tileY + RASTER_TILE_SIZE - 1)) ? t->maxY : (tileY + RASTER_TILE_SIZE - 1);
+		for (int y = minY; y <= maxY; y++)
+			shadeRow(t, y, minX, maxX, raster->color + ((size_t)y * stride), raster->depth + ((size_t)y * stride));
+	}
+
+	// The points, depth tested like the triangles
+	bin = &raster->pointBins[tile];
+	for (int i = 0; i < bin->count; i++){
+		const RasterPoint* p = &raster->points[bin->items[i]];
+		int minX = (p->minX > tileX) ? p->minX : tileX;
+		int maxX = (p->maxX < (tileX + RASTER_TILE_SIZE - 1)) ? p->maxX : (tileX + RASTER_TILE_SIZE - 1);
+		int minY = (p->minY > tileY) ? p->minY : tileY;
+		int maxY = (p->maxY < (tileY + RASTER_TILE_SIZE - 1)) ? p->maxY : (tileY + RASTER_TILE_SIZE - 1);
+		for (int y = minY; y <= maxY; y++){
+			uint32_t* color = raster->color + ((size_t)y * stride);
+			float* depth = raster->depth + ((size_t)y * stride);
+			for (int x = minX; x <= maxX; x++){
+				if (p->z < depth[x]){
+					depth[x] = p->z;
+					color[x] = p->color;
+				}
+			}
+		}
+	}
+
+	// The text, over the top of everything
+	bin = &raster->glyphBins[tile];
+	for (int i = 0; i < bin->count; i++){
+		const RasterGlyph* g = &raster->glyphs[bin->items[i]];
+		int minX = (g->x > tileX) ? g->x : tileX;
+		int maxX = g->x + (GLYPH_WIDTH * g->scale) - 1;
+		if (maxX > (tileX + RASTER_TILE_SIZE - 1))
+			maxX = tileX + RASTER_TILE_SIZE - 1;
+		int minY = (g->y > tileY) ? g->y : tileY;
+		int maxY = g->y + (GLYPH_HEIGHT * g->scale) - 1;
+		if (maxY > (tileY + RASTER_TILE_SIZE - 1))
+			maxY = tileY + RASTER_TILE_SIZE - 1;
+		for (int y = minY; y <= maxY; y++){
+			// The font is stored top row first
+			unsigned char bits = fontGlyphs[g->glyph][GLYPH_HEIGHT - 1 - ((y - g->y) / g->scale)];
+			uint32_t* color = raster->color + ((size_t)y * stride);
+			for (int x = minX; x <= maxX; x++){
+				if (bits & (0x80 >> ((x - g->x) / g->scale)))
+					color[x] = g->color;
+			}
+		}
+	}
+}
+
+/*
+	This function frees the frame and the bins of a rasterizer.
+	@param raster A pointer to the rasterizer.
+ */
+static void freeFrame(Rasterizer* raster)
+{
+	int numTiles = raster->tilesX * raster->tilesY;
+	for (int i = 0; i < numTiles; i++){
+		free(raster->triangleBins[i].items);
+		free(raster->pointBins[i].items);
+		free(raster->glyphBins[i].items);
+	}
+	free(raster->triangleBins);
+	free(raster->pointBins);
+	free(raster->glyphBins);
+	free(raster->color);
+	free(raster->depth);
+}
+
+/*
+	This function makes the frame and the bins of a rasterizer and points the camera at it.
+	@param raster A pointer to the rasterizer.
+	@param width The width of the frame in pixels.
+	@param height The height of the frame in pixels.
+ */
+static void allocateFrame(Rasterizer* raster, int width, int height)
+{
+	raster->width = (width < 1) ? 1 : width;
+	raster->height = (height < 1) ? 1 : height;
+	raster->tilesX = (raster->width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	raster->tilesY = (raster->height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+	raster->stride = raster->tilesX * RASTER_TILE_SIZE;
+	size_t pixels = (size_t)raster->stride * raster->tilesY * RASTER_TILE_SIZE;
+	raster->color = (uint32_t*)calloc(pixels, sizeof(uint32_t));
+	raster->depth = (float*)calloc(pixels, sizeof(float));
+	int numTiles = raster->tilesX * raster->tilesY;
+	raster->triangleBins = (RasterBin*)calloc(numTiles, sizeof(RasterBin));
+	raster->pointBins = (RasterBin*)calloc(numTiles, sizeof(RasterBin));
+	raster->glyphBins = (RasterBin*)calloc(numTiles, sizeof(RasterBin));
+
+	// The same camera as gluPerspective, folded down to what a point in front of it needs
+	float f = 1.0f / tan((RASTER_FOV * 0.5) * (PI / 180.0f));
+	float aspect = (float)raster->width / raster->height;
+	raster->xScale = (f / aspect) * 0.5f * raster->width;
+	raster->yScale = f * 0.5f * raster->height;
+	raster->zOffset = 0.5f - (0.5f * (RASTER_FAR + RASTER_NEAR) / (RASTER_NEAR - RASTER_FAR));
+	raster->zScale = (RASTER_FAR * RASTER_NEAR) / (RASTER_FAR - RASTER_NEAR);
+}
+
+/*
+	This function creates a rasterizer and starts its threads.
+	@param width The width of the frame in pixels.
+	@param height The height of the frame in pixels.
+	@param numThreads The number of worker threads to start on top of the caller, or -1 for one per core.
+	@return A pointer to the rasterizer.
+*/
+Rasterizer* createRasterizer(int width, int height, int numThreads)
+{
+	Rasterizer* raster = (Rasterizer*)malloc(sizeof(Rasterizer));
+	raster->meshes = buildMeshLibrary();
+	raster->corners = NULL;
+	raster->cornerCapacity = 0;
+	raster->triangles = NULL;
+	raster->numTriangles = 0;
+	raster->triangleCapacity = 0;
+	raster->points = NULL;
+	raster->numPoints = 0;
+	raster->pointCapacity = 0;
+	raster->glyphs = NULL;
+	raster->numGlyphs = 0;
+	raster->glyphCapacity = 0;
+	allocateFrame(raster, width, height);
+
+	// Start the threads that shade the tiles
+	raster->workers = createWorkers(numThreads, "raster worker");
+	return raster;
+}
+
+/*
+	This function stops the threads of a rasterizer and frees it.
+	@param raster A pointer to the rasterizer to destroy.
+*/
+void destroyRasterizer(Rasterizer* raster)
+{
+	if (raster == NULL)
+		return;
+	destroyWorkers(raster->workers);
+	freeFrame(raster);
+	destroyMeshLibrary(raster->meshes);
+	free(raster->corners);
+	free(raster->triangles);
+	free(raster->points);
+	free(raster->glyphs);
+	free(raster);
+}
+
+/*
+	This function changes the size of a rasterizer's frame (and the camera's aspect with it).
+	It must not be called between beginRaster and finishRaster.
+	@param raster A pointer to the rasterizer.
+	@param width The new width of the frame in pixels.
+	@param height The new height of the frame in pixels.
+*/
+void resizeRasterizer(Rasterizer* raster, int width, int height)
+{
+	if ((width == raster->width) && (height == raster->height))
+		return;
+	freeFrame(raster);
+	allocateFrame(raster, width, height);
+}
+
+/*
+	This function starts a frame, throwing away everything set up for the last one.
+	@param raster A pointer to the rasterizer.
+*/
+void beginRaster(Rasterizer* raster)
+{
+	raster->numTriangles = 0;
+	raster->numPoints = 0;
+	raster->numGlyphs = 0;
+	int numTiles = raster->tilesX * raster->tilesY;
+	for (int i = 0; i < numTiles; i++){
+		raster->triangleBins[i].count = 0;
+		raster->pointBins[i].count = 0;
+		raster->glyphBins[i].count = 0;
+	}
+}
+
+/*
+	This function sets up and bins everything in a frame's draw commands.
+	@param raster A pointer to the rasterizer.
+	@param commands The commands to draw, sorted.
+*/
+void rasterCommands(Rasterizer* raster, const CommandBuffer* commands)
+{
+	for (int i = 0; i < commands->count; i++){
+		const DrawCommand* command = &commands->commands[i];
+		if (command->kind == COMMAND_MESH)
+			addMesh(raster, command);
+		else if ((command->first + command->count) <= commands->numPoints)
+			addPoints(raster, command, commands->points);
+	}
+}
+
+/*
+	This function sets up and bins a string, drawn on top of everything.
+	@param raster A pointer to the rasterizer.
+	@param x The x co-ordinate of where the string starts (its baseline on the left).
+	@param y The y co-ordinate of where the string starts.
+	@param z The z co-ordinate of where the string starts.
+	@param string The string to draw.
+	@param scale How many pixels wide and tall each pixel of the font is drawn.
+	@param color The color to draw the string in.
+*/
+void addRasterText(Rasterizer* raster, float x, float y, float z, const char* string, int scale, const unsigned char color[4])
+{
+	// Find the anchor on the screen, snapped to a pixel the way a raster position is
+	float p[3] = { x, y, z };
+	float anchor[4];
+	projectPoint(raster, p, anchor);
+	if (!inGuardBand(raster, anchor))
+		return;
+	int penX = (int)floorf(anchor[0]);
+	int bottom = (int)floorf(anchor[1]) - (GLYPH_DESCENT * scale);
+	uint32_t pixel;
+	memcpy(&pixel, color, sizeof(pixel));
+
+	for (const char* c = string; *c != '\0'; c++, penX += GLYPH_WIDTH * scale){
+		// Spaces take up room but need nothing drawn
+		int glyph = ((*c >= FIRST_GLYPH) && (*c <= LAST_GLYPH)) ? *c - FIRST_GLYPH : 0;
+		if (glyph == 0)
+			continue;
+		int minX = penX;
+		int minY = bottom;
+		int maxX = penX + (GLYPH_WIDTH * scale) - 1;
+		int maxY = bottom + (GLYPH_HEIGHT * scale) - 1;
+		if (!clipToFrame(raster, &minX, &minY, &maxX, &maxY))
+			continue;
+
+		reserveItem((void**)&raster->glyphs, raster->numGlyphs, &raster->glyphCapacity, sizeof(RasterGlyph));
+		RasterGlyph* g = &raster->glyphs[raster->numGlyphs];
+		g->x = penX;
+		g->y = bottom;
+		g->scale = scale;
+		g->glyph = glyph;
+		g->color = pixel;
+		binItem(raster, raster->glyphBins, raster->numGlyphs, minX, minY, maxX, maxY);
+		raster->numGlyphs++;
+	}
+}
+
+/*
+	This function shades every tile of the frame in parallel and waits until they are all done.
+	@param raster A pointer to the rasterizer.
+*/
+void finishRaster(Rasterizer* raster)
+{
+	runWorkers(raster->workers, shadeTile, raster, raster->tilesX * raster->tilesY, 1);
+}
+
+/*
+	This function writes a finished frame to a binary PPM image, top row first.
+	@param raster A pointer to the rasterizer.
+	@param path Where to write the image.
+	@return True if the image was written.
+*/
+bool saveRasterImage(const Rasterizer* raster, const char* path)
+{
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		return false;
+	fprintf(file, "P6\n%d %d\n255\n", raster->width, raster->height);
+	unsigned char* row = (unsigned char*)malloc((size_t)raster->width * 3);
+	bool ok = true;
+	for (int y = raster->height - 1; (y >= 0) && ok; y--){
+		// Drop the alpha of every pixel
+		const unsigned char* pixels = (const unsigned char*)(raster->color + ((size_t)y * raster->stride));
+		for (int x = 0; x < raster->width; x++)
+			memcpy(row + (x * 3), pixels + (x * 4), 3);
+		ok = fwrite(row, 3, raster->width, file) == (size_t)raster->width;
+	}
+	free(row);
+	return (fclose(file) == 0) && ok;
+}
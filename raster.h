@@ -0,0 +1,187 @@
+#ifndef __RASTER__
+#define __RASTER__
+
+#include <stdint.h>
+#include "commands.h"
+#include "meshes.h"
+#include "font.h"
+#include "workers.h"
+
+/*
+	@file raster.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the software rasterizer, a renderer that draws a frame's draw
+	commands on the CPU for machines with no GPU. Every triangle, point, and glyph of HUD text is
+	set up once and binned into the square screen tiles it touches, then the tiles are shaded in
+	parallel on a pool of threads, each thread owning whole tiles so no two ever touch the same
+	pixel. Triangles are filled with vector edge functions, several pixels at a time.
+	The frame ends up in memory, bottom row first like glReadPixels, for the caller to put in a
+	window with one glDrawPixels or to keep. Nothing in here knows about GLUT or OpenGL.
+*/
+
+// How many pixels wide and tall each screen tile is (a multiple of the widest vector)
+#define RASTER_TILE_SIZE 32
+// How many bits of each triangle corner are below the pixel
+#define RASTER_SUBPIXEL_BITS 4
+// Triangles with a corner farther off the screen than this many pixels are dropped
+#define RASTER_GUARD_BAND 8192
+// The camera the game draws with (see handleResize), it sits at the origin looking down -z
+#define RASTER_FOV 45.0
+#define RASTER_NEAR 1.0
+#define RASTER_FAR 200.0
+
+// A struct holding a triangle set up for shading
+typedef struct {
+	// The edge functions, a pixel is inside if (a * x) + (b * y) + c >= 0 for all three
+	// (x and y are the pixel's center in sub-pixels)
+	int a[3];
+	int b[3];
+	int64_t c[3];
+	// The depth at the first corner, and how much it changes each pixel across and up
+	float x0;
+	float y0;
+	float z0;
+	float dzdx;
+	float dzdy;
+	// The pixels the triangle could cover (inclusive)
+	int minX;
+	int minY;
+	int maxX;
+	int maxY;
+	// The flat lit color of the triangle
+	uint32_t color;
+} RasterTriangle;
+
+// A struct holding a point set up for shading, a square of pixels at one depth
+typedef struct {
+	// The pixels the point covers (inclusive)
+	int minX;
+	int minY;
+	int maxX;
+	int maxY;
+	// The depth of the point, and its color
+	float z;
+	uint32_t color;
+} RasterPoint;
+
+// A struct holding a glyph of text set up for shading
+typedef struct {
+	// The bottom left pixel of the glyph, and how many pixels each pixel of the font covers
+	int x;
+	int y;
+	int scale;
+	// Which glyph of the font, and its color
+	int glyph;
+	uint32_t color;
+} RasterGlyph;
+
+// A struct holding the indices of everything of one kind that touches a tile
+typedef struct {
+	int* items;
+	int count;
+	int capacity;
+} RasterBin;
+
+// A struct holding the rasterizer, its frame, and the threads that shade it
+typedef struct {
+	// The size of the frame in pixels
+	int width;
+	int height;
+	// The frame is padded out to whole tiles, stride is how many pixels a row really has
+	int stride;
+	int tilesX;
+	int tilesY;
+	// The color (RGBA bytes, bottom row first) and depth of every pixel
+	uint32_t* color;
+	float* depth;
+	// How the camera maps a point in front of it onto the frame
+	float xScale;
+	float yScale;
+	float zScale;
+	float zOffset;
+	// Every mesh a command can draw with, and room for the corners of one mesh on the screen
+	MeshLibrary* meshes;
+	float (*corners)[4];
+	int cornerCapacity;
+	// Everything set up this frame
+	RasterTriangle* triangles;
+	int numTriangles;
+	int triangleCapacity;
+	RasterPoint* points;
+	int numPoints;
+	int pointCapacity;
+	RasterGlyph* glyphs;
+	int numGlyphs;
+	int glyphCapacity;
+	// What touches each tile, in the order it was added
+	RasterBin* triangleBins;
+	RasterBin* pointBins;
+	RasterBin* glyphBins;
+	// The worker threads that shade tiles (the thread calling finishRaster works too)
+	WorkerPool* workers;
+} Rasterizer;
+
+/*
+	This function creates a rasterizer and starts its threads.
+	@param width The width of the frame in pixels.
+	@param height The height of the frame in pixels.
+	@param numThreads The number of worker threads to start on top of the caller, or -1 for one per core.
+	@return A pointer to the rasterizer.
+ */
+Rasterizer* createRasterizer(int width, int height, int numThreads);
+
+/*
+	This function stops the threads of a rasterizer and frees it.
+	@param raster A pointer to the rasterizer to destroy.
+ */
+void destroyRasterizer(Rasterizer* raster);
+
+/*
+	This function changes the size of a rasterizer's frame (and the camera's aspect with it).
+	It must not be called between beginRaster and finishRaster.
+	@param raster A pointer to the rasterizer.
+	@param width The new width of the frame in pixels.
+	@param height The new height of the frame in pixels.
+ */
+void resizeRasterizer(Rasterizer* raster, int width, int height);
+
+/*
+	This function starts a frame, throwing away everything set up for the last one.
+	@param raster A pointer to the rasterizer.
+ */
+void beginRaster(Rasterizer* raster);
+
+/*
+	This function sets up and bins everything in a frame's draw commands.
+	@param raster A pointer to the rasterizer.
+	@param commands The commands to draw, sorted.
+ */
+void rasterCommands(Rasterizer* raster, const CommandBuffer* commands);
+
+/*
+	This function sets up and bins a string, drawn on top of everything.
+	@param raster A pointer to the rasterizer.
+	@param x The x co-ordinate of where the string starts (its baseline on the left).
+	@param y The y co-ordinate of where the string starts.
+	@param z The z co-ordinate of where the string starts.
+	@param string The string to draw.
+	@param scale How many pixels wide and tall each pixel of the font is drawn.
+	@param color The color to draw the string in.
+ */
+void addRasterText(Rasterizer* raster, float x, float y, float z, const char* string, int scale, const unsigned char color[4]);
+
+/*
+	This function shades every tile of the frame in parallel and waits until they are all done.
+	@param raster A pointer to the rasterizer.
+ */
+void finishRaster(Rasterizer* raster);
+
+/*
+	This function writes a finished frame to a binary PPM image, top row first.
+	@param raster A pointer to the rasterizer.
+	@param path Where to write the image.
+	@return True if the image was written.
+ */
+bool saveRasterImage(const Rasterizer* raster, const char* path);
+
+#endif
@@ -0,0 +1,80 @@
+#include <stdlib.h>
+#include "readback.h"
+
+/*
+	@file readback.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the frame reader. glReadPixels into a bound pixel buffer returns right
+	away, mapping the buffer is what waits, so each buffer is mapped only when its turn comes
+	around again.
+ */
+
+/*
+	This function creates a frame reader. loadGLFunctions must have been called first.
+	@param width The width of the frames to read in pixels.
+	@param height The height of the frames to read in pixels.
+	@return A pointer to the frame reader.
+*/
+FrameReader* createFrameReader(int width, int height)
+{
+	FrameReader* reader = (FrameReader*)calloc(1, sizeof(FrameReader));
+	reader->width = width;
+	reader->height = height;
+	glGenBuffers(READBACK_BUFFERS, reader->buffers);
+	for (int i = 0; i < READBACK_BUFFERS; i++){
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, reader->buffers[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	return reader;
+}
+
+/*
+	This function frees a frame reader and its buffers.
+	@param reader A pointer to the frame reader to destroy.
+*/
+void destroyFrameReader(FrameReader* reader)
+{
+	if (reader == NULL)
+		return;
+	glDeleteBuffers(READBACK_BUFFERS, reader->buffers);
+	free(reader);
+}
+
+/*
+	This function starts reading the frame just drawn (before the buffers are swapped), and hands
+	the capture the oldest frame that has finished coming back. Frames drawn while the window is
+	not the reader's size are handed over as dropped.
+	@param reader A pointer to the frame reader.
+	@param capture The capture to hand finished frames to.
+	@param width The width of the window in pixels.
+	@param height The height of the window in pixels.
+*/
+void readFrame(FrameReader* reader, FrameCapture* capture, int width, int height)
+{
+	int slot = (int)(reader->frames % READBACK_BUFFERS);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, reader->buffers[slot]);
+
+	// Hand over what was read into this buffer a few frames ago, the GPU is long done with it
+	if (reader->frames >= READBACK_BUFFERS){
+		int readWidth = reader->readWidths[slot];
+		int readHeight = reader->readHeights[slot];
+		const void* pixels = NULL;
+		if ((readWidth == reader->width) && (readHeight == reader->height))
+			pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+		// A frame that was never read (or could not be mapped) is handed over with no size, which drops it
+		if (pixels != NULL){
+			captureFrame(capture, pixels, readWidth, readHeight, readWidth);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		else captureFrame(capture, NULL, 0, 0, 0);
+	}
+
+	// Start reading this frame, it only fits if the window is still the size it started at
+	reader->readWidths[slot] = width;
+	reader->readHeights[slot] = height;
+	if ((width == reader->width) && (height == reader->height))
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	reader->frames++;
+}
@@ -0,0 +1,60 @@
+#ifndef __READBACK__
+#define __READBACK__
+
+#include "glfuncs.h"
+#include "capture.h"
+
+/*
+	@file readback.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the frame reader, which copies each finished frame off the GPU for a
+	capture without stalling. Every frame is read into one of a few pixel buffers, which the GPU fills
+	on its own time, and a buffer is only looked at again a couple of frames later once it is surely
+	done. The frames handed to the capture are that many frames behind, and the last few are lost
+	when the game closes.
+	It needs OpenGL 2.1 (pixel buffer objects) and a current context.
+*/
+
+// The number of frames that can be on their way back from the GPU
+#define READBACK_BUFFERS 3
+
+// A struct holding the pixel buffers frames are read into
+typedef struct {
+	// The buffers, each big enough for one frame
+	GLuint buffers[READBACK_BUFFERS];
+	// The size of the frames read into the buffers, anything else is not read
+	int width;
+	int height;
+	// The size the window was when each buffer was last used (0 if it has not been)
+	int readWidths[READBACK_BUFFERS];
+	int readHeights[READBACK_BUFFERS];
+	// The number of frames read so far
+	unsigned long long frames;
+} FrameReader;
+
+/*
+	This function creates a frame reader. loadGLFunctions must have been called first.
+	@param width The width of the frames to read in pixels.
+	@param height The height of the frames to read in pixels.
+	@return A pointer to the frame reader.
+ */
+FrameReader* createFrameReader(int width, int height);
+
+/*
+	This function frees a frame reader and its buffers.
+	@param reader A pointer to the frame reader to destroy.
+ */
+void destroyFrameReader(FrameReader* reader);
+
+/*
+	This function starts reading the frame just drawn (before the buffers are swapped), and hands
+	the capture the oldest frame that has finished coming back. Frames drawn while the window is
+	not the reader's size are handed over as dropped.
+	@param reader A pointer to the frame reader.
+	@param capture The capture to hand finished frames to.
+	@param width The width of the window in pixels.
+	@param height The height of the window in pixels.
+ */
+void readFrame(FrameReader* reader, FrameCapture* capture, int width, int height);
+
+#endif
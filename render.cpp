@@ -0,0 +1,404 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "render.h"
+
+/*
+	@file render.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the renderer. Every mesh in the mesh library lives in buffers the vertex
+	shader pulls its vertices from (through an index buffer, since the triangles share points).
+	A frame arrives as sorted draw commands, and a fresh buffer of instances (one transform and
+	material per mesh command) is streamed in for each run of commands that share a mesh set, so
+	everything is drawn with one call per set. Missles and explosions are streamed the same way,
+	as one buffer of colored points drawn with one call per point size.
+ */
+
+// Where each instance attribute lives
+enum {
+	ATTRIB_MODEL_X,
+	ATTRIB_MODEL_Y,
+	ATTRIB_MODEL_Z,
+	ATTRIB_MATERIAL,
+	ATTRIB_MESH
+};
+
+// Lights an instanced mesh the way the fixed function pipeline lights it (one directional light, no specular)
+// Each vertex looks up which point it is, and the normal of the triangle it is in
+static const char* meshVertexShader =
+	"#version 150 compatibility\n"
+	"uniform samplerBuffer meshes;\n"
+	"uniform usamplerBuffer indices;\n"
+	"uniform int pointBase;\n"
+	"uniform int meshPoints;\n"
+	"uniform int normalBase;\n"
+	"uniform int meshNormals;\n"
+	"uniform int indexBase;\n"
+	"in vec4 modelX;\n"
+	"in vec4 modelY;\n"
+	"in vec4 modelZ;\n"
+	"in vec4 material;\n"
+	"in int mesh;\n"
+	"flat out vec4 color;\n"
+	"void main()\n"
+	"{\n"
+	"	int point = int(texelFetch(indices, indexBase + gl_VertexID).r);\n"
+	"	vec4 p = vec4(texelFetch(meshes, pointBase + (mesh * meshPoints) + point).xyz, 1.0);\n"
+	"	vec3 n = texelFetch(meshes, normalBase + (mesh * meshNormals) + (gl_VertexID / 3)).xyz;\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4(dot(modelX, p), dot(modelY, p), dot(modelZ, p), 1.0);\n"
+	"	vec3 normal = normalize(gl_NormalMatrix * vec3(dot(modelX.xyz, n), dot(modelY.xyz, n), dot(modelZ.xyz, n)));\n"
+	"	vec3 light = normalize(gl_LightSource[0].position.xyz);\n"
+	"	vec3 lit = (gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb) * material.rgb;\n"
+	"	lit += max(dot(normal, light), 0.0) * gl_LightSource[0].diffuse.rgb * material.rgb;\n"
+	"	color = vec4(clamp(lit, 0.0, 1.0), material.a);\n"
+	"}\n";
+
+// Fills in every pixel with the color of the triangle
+static const char* meshFragmentShader =
+	"#version 150 compatibility\n"
+	"flat in vec4 color;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor = color;\n"
+	"}\n";
+
+/*
+	This function compiles a shader.
+	@param type The kind of shader.
+	@param source The GLSL source.
+	@return The shader, or 0 (after printing why) if it did not compile.
+ */
+static GLuint compileShader(GLenum type, const char* source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	GLint ok = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if (!ok){
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		fprintf(stderr, "Could not compile a shader:\n%s\n", log);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+/*
+	This function builds the program that draws instanced meshes.
+	@return The program, or 0 (after printing why) if it could not be built.
+ */
+static GLuint buildMeshProgram()
+{
+	GLuint vertex = compileShader(GL_VERTEX_SHADER, meshVertexShader);
+	GLuint fragment = compileShader(GL_FRAGMENT_SHADER, meshFragmentShader);
+	if ((vertex == 0) || (fragment == 0)){
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		return 0;
+	}
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertex);
+	glAttachShader(program, fragment);
+	// Pin the attributes to the slots the vertex arrays use
+	glBindAttribLocation(program, ATTRIB_MODEL_X, "modelX");
+	glBindAttribLocation(program, ATTRIB_MODEL_Y, "modelY");
+	glBindAttribLocation(program, ATTRIB_MODEL_Z, "modelZ");
+	glBindAttribLocation(program, ATTRIB_MATERIAL, "material");
+	glBindAttribLocation(program, ATTRIB_MESH, "mesh");
+	glLinkProgram(program);
+	// The program keeps what it needs
+	glDeleteShader(vertex);
+	glDeleteShader(fragment);
+	GLint ok = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &ok);
+	if (!ok){
+		char log[1024];
+		glGetProgramInfoLog(program, sizeof(log), NULL, log);
+		fprintf(stderr, "Could not link a shader program:\n%s\n", log);
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+/*
+	This function makes a batch of instances and the vertex array that reads them, one per instance.
+	@param batch A pointer to the batch to set up.
+	@param capacity The most instances the batch can hold.
+ */
+static void createBatch(InstanceBatch* batch, int capacity)
+{
+	batch->count = 0;
+	batch->capacity = capacity;
+	batch->instances = (RenderInstance*)malloc(capacity * sizeof(RenderInstance));
+	glGenBuffers(1, &batch->buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, batch->buffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)capacity * sizeof(RenderInstance), NULL, GL_STREAM_DRAW);
+	// Describe a RenderInstance to the vertex array
+	glGenVertexArrays(1, &batch->vao);
+	glBindVertexArray(batch->vao);
+	for (int row = 0; row < 3; row++){
+		glEnableVertexAttribArray(ATTRIB_MODEL_X + row);
+		glVertexAttribPointer(ATTRIB_MODEL_X + row, 4, GL_FLOAT, GL_FALSE, sizeof(RenderInstance),
+			(const void*)(offsetof(RenderInstance, model) + (row * sizeof(float[4]))));
+		glVertexAttribDivisor(ATTRIB_MODEL_X + row, 1);
+	}
+	glEnableVertexAttribArray(ATTRIB_MATERIAL);
+	glVertexAttribPointer(ATTRIB_MATERIAL, 4, GL_FLOAT, GL_FALSE, sizeof(RenderInstance), (const void*)offsetof(RenderInstance, mat));
+	glVertexAttribDivisor(ATTRIB_MATERIAL, 1);
+	glEnableVertexAttribArray(ATTRIB_MESH);
+	glVertexAttribIPointer(ATTRIB_MESH, 1, GL_INT, sizeof(RenderInstance), (const void*)offsetof(RenderInstance, mesh));
+	glVertexAttribDivisor(ATTRIB_MESH, 1);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/*
+	This function frees a batch of instances.
+	@param batch A pointer to the batch.
+ */
+static void destroyBatch(InstanceBatch* batch)
+{
+	glDeleteBuffers(1, &batch->buffer);
+	glDeleteVertexArrays(1, &batch->vao);
+	free(batch->instances);
+}
+
+/*
+	This function makes a buffer holding some data and a buffer texture to read it through.
+	@param format The format of each texel.
+	@param data The data to put in the buffer.
+	@param size The size of the data in bytes.
+	@param buffer Where to put the buffer.
+	@param texture Where to put the texture.
+ */
+static void createBufferTexture(GLenum format, const void* data, GLsizeiptr size, GLuint* buffer, GLuint* texture)
+{
+	glGenBuffers(1, buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, *buffer);
+	glBufferData(GL_TEXTURE_BUFFER, size, data, GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	glGenTextures(1, texture);
+	glBindTexture(GL_TEXTURE_BUFFER, *texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, format, *buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+/*
+	This function builds every mesh the renderer draws and uploads them.
+	@param renderer A pointer to the renderer.
+ */
+static void uploadMeshes(Renderer* renderer)
+{
+	MeshLibrary* library = buildMeshLibrary();
+	memcpy(renderer->meshSets, library->sets, sizeof(renderer->meshSets));
+
+	// Send it all at once
+	createBufferTexture(GL_RGBA32F, library->texels, library->numTexels * sizeof(float[4]), &renderer->meshBuffer, &renderer->meshTexture);
+	createBufferTexture(GL_R16UI, library->indices, library->numIndices * sizeof(unsigned short), &renderer->indexBuffer, &renderer->indexTexture);
+	destroyMeshLibrary(library);
+}
+
+/*
+	This function creates a renderer. All GPU memory it will ever use is allocated here, sized to
+	hold everything the world's pools can, and every mesh is built and uploaded once.
+	loadGLFunctions must have been called first.
+	@param world The world that will be drawn.
+	@return A pointer to the renderer, or NULL (after printing why) if it could not be made.
+*/
+Renderer* createRenderer(World* world)
+{
+	GLuint program = buildMeshProgram();
+	if (program == 0)
+		return NULL;
+
+	Renderer* renderer = (Renderer*)malloc(sizeof(Renderer));
+	renderer->meshProgram = program;
+	// Find the uniforms that change with each mesh set, and point the samplers at their texture units
+	renderer->pointBaseLoc = glGetUniformLocation(program, "pointBase");
+	renderer->meshPointsLoc = glGetUniformLocation(program, "meshPoints");
+	renderer->normalBaseLoc = glGetUniformLocation(program, "normalBase");
+	renderer->meshNormalsLoc = glGetUniformLocation(program, "meshNormals");
+	renderer->indexBaseLoc = glGetUniformLocation(program, "indexBase");
+	glUseProgram(program);
+	glUniform1i(glGetUniformLocation(program, "meshes"), 0);
+	glUniform1i(glGetUniformLocation(program, "indices"), 1);
+	glUseProgram(0);
+
+	// Every mesh is fixed, they only need to be sent once
+	uploadMeshes(renderer);
+
+	// Room for every asteroid, alien, and the player at once, refilled for each mesh set every frame
+	createBatch(&renderer->batch, world->asteroids->capacity + world->aliens->capacity + 1);
+
+	// Room for every missle and every bit of every explosion, refilled every frame
+	renderer->pointCapacity = world->playerShots->capacity + world->alienShots->capacity + (world->explosions->capacity * EXPLOSION_NUM_PTS);
+	glGenBuffers(1, &renderer->pointBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, renderer->pointBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)renderer->pointCapacity * sizeof(PointVertex), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return renderer;
+}
+
+/*
+	This function frees a renderer and everything it keeps on the GPU.
+	@param renderer A pointer to the renderer to destroy.
+*/
+void destroyRenderer(Renderer* renderer)
+{
+	glDeleteProgram(renderer->meshProgram);
+	glDeleteTextures(1, &renderer->meshTexture);
+	glDeleteTextures(1, &renderer->indexTexture);
+	glDeleteBuffers(1, &renderer->meshBuffer);
+	glDeleteBuffers(1, &renderer->indexBuffer);
+	destroyBatch(&renderer->batch);
+	glDeleteBuffers(1, &renderer->pointBuffer);
+	free(renderer);
+}
+
+/*
+	This function binds the program and the meshes so batches can be drawn.
+	@param renderer A pointer to the renderer.
+ */
+static void beginMeshes(Renderer* renderer)
+{
+	glUseProgram(renderer->meshProgram);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_BUFFER, renderer->indexTexture);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, renderer->meshTexture);
+}
+
+/*
+	This function unbinds everything beginMeshes bound, so the old style drawing is not disturbed.
+ */
+static void endMeshes()
+{
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glActiveTexture(GL_TEXTURE0);
+	glUseProgram(0);
+}
+
+/*
+	This function sends a batch of instances to the GPU and draws them all with one call, then empties the batch.
+	beginMeshes must have been called first.
+	@param renderer A pointer to the renderer.
+	@param set The meshes to draw the instances with.
+	@param batch A pointer to the batch.
+ */
+static void drawBatch(Renderer* renderer, const MeshSet* set, InstanceBatch* batch)
+{
+	if (batch->count == 0)
+		return;
+	// Send the instances
+	streamBuffer(GL_ARRAY_BUFFER, batch->buffer, (size_t)batch->capacity * sizeof(RenderInstance),
+		batch->instances, (size_t)batch->count * sizeof(RenderInstance));
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Tell the program where the meshes are, then draw them all at once
+	glUniform1i(renderer->pointBaseLoc, set->pointBase);
+	glUniform1i(renderer->meshPointsLoc, set->meshPoints);
+	glUniform1i(renderer->normalBaseLoc, set->normalBase);
+	glUniform1i(renderer->meshNormalsLoc, set->meshNormals);
+	glUniform1i(renderer->indexBaseLoc, set->indexBase);
+	glBindVertexArray(batch->vao);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, set->numIndices, batch->count);
+	batch->count = 0;
+}
+
+/*
+	This function draws the points of every point command in a buffer, with one call per command.
+	@param renderer A pointer to the renderer.
+	@param commands The commands.
+	@param first The first point command.
+ */
+static void drawPointCommands(Renderer* renderer, const CommandBuffer* commands, int first)
+{
+	int count = commands->numPoints;
+	if (count > renderer->pointCapacity)
+		count = renderer->pointCapacity;
+	if (count == 0)
+		return;
+
+	// Send the points, the buffer stays bound for the pointers below
+	streamBuffer(GL_ARRAY_BUFFER, renderer->pointBuffer, (size_t)renderer->pointCapacity * sizeof(PointVertex),
+		commands->points, (size_t)count * sizeof(PointVertex));
+
+	// Points are not lit
+	glPushAttrib(GL_ENABLE_BIT | GL_POINT_BIT);
+	glDisable(GL_LIGHTING);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(PointVertex), (const void*)offsetof(PointVertex, pos));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(PointVertex), (const void*)offsetof(PointVertex, color));
+	for (int i = first; i < commands->count; i++){
+		const DrawCommand* command = &commands->commands[i];
+		if ((command->first + command->count) > count)
+			continue;
+		glPointSize(command->size);
+		glDrawArrays(GL_POINTS, command->first, command->count);
+	}
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glPopAttrib();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/*
+	This function draws a frame's draw commands, which must already be sorted.
+	The modelview matrix is used as the camera.
+	@param renderer A pointer to the renderer.
+	@param commands The commands to draw.
+*/
+void drawCommands(Renderer* renderer, const CommandBuffer* commands)
+{
+	InstanceBatch* batch = &renderer->batch;
+	int i = 0;
+
+	// Every mesh command comes first, grouped by mesh set, so each set is one draw call
+	if ((commands->count > 0) && (commands->commands[0].kind == COMMAND_MESH)){
+		beginMeshes(renderer);
+		int set = commands->commands[0].mesh;
+		for (; (i < commands->count) && (commands->commands[i].kind == COMMAND_MESH); i++){
+			const DrawCommand* command = &commands->commands[i];
+			// Draw what has been gathered when the set changes or there is no more room
+			if ((command->mesh != set) || (batch->count == batch->capacity)){
+				drawBatch(renderer, &renderer->meshSets[set], batch);
+				set = command->mesh;
+			}
+			RenderInstance* instance = &batch->instances[batch->count++];
+			memcpy(instance->model, command->model, sizeof(instance->model));
+			memcpy(instance->mat, command->mat, sizeof(instance->mat));
+			instance->mesh = command->variant;
+		}
+		drawBatch(renderer, &renderer->meshSets[set], batch);
+		endMeshes();
+	}
+
+	// Then the points
+	if (i < commands->count)
+		drawPointCommands(renderer, commands, i);
+}
+
+/*
+	This function refills a buffer that is rewritten every frame. The old contents are thrown away
+	first (the buffer is orphaned), so the upload never waits on the GPU to finish drawing the last frame.
+	The buffer is left bound.
+	@param target What to bind the buffer to.
+	@param buffer The buffer to fill.
+	@param capacity How big the buffer is in bytes.
+	@param data The new contents.
+	@param bytes How many bytes of new contents there are, at most capacity.
+*/
+void streamBuffer(GLenum target, GLuint buffer, size_t capacity, const void* data, size_t bytes)
+{
+	glBindBuffer(target, buffer);
+	glBufferData(target, (GLsizeiptr)capacity, NULL, GL_STREAM_DRAW);
+	glBufferSubData(target, 0, (GLsizeiptr)bytes, data);
+}
@@ -0,0 +1,103 @@
+#ifndef __RENDER__
+#define __RENDER__
+
+#include "glfuncs.h"
+#include "objects.h"
+#include "datastructures.h"
+#include "world.h"
+#include "scene.h"
+#include "commands.h"
+
+/*
+	@file render.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the renderer, which keeps everything it draws in buffers on the GPU
+	and draws a frame's sorted draw commands (see commands.h) with one instanced draw call per
+	mesh set and one draw call per point size, no matter how many objects there are. It lights
+	meshes the same way the fixed function pipeline does, reading the light set up by
+	initLighting, so it can be mixed with the old style drawing.
+	It needs OpenGL 3.3 (the compatibility profile) and a current context.
+*/
+
+// A struct holding the transform and material of one instance of a mesh
+typedef struct {
+	// The rows of the model matrix (rotation and scale, with the translation in the last column)
+	float model[3][4];
+	// The material to draw with
+	float mat[4];
+	// Which mesh in its set the instance is drawn with
+	int mesh;
+} RenderInstance;
+
+// A struct holding the instances of one draw call, streamed to the GPU every frame
+typedef struct {
+	// The buffer the instances are sent to, and the vertex array reading it
+	GLuint buffer;
+	GLuint vao;
+	// The instances waiting to be drawn
+	RenderInstance* instances;
+	// How many instances are waiting, and how many fit
+	int count;
+	int capacity;
+} InstanceBatch;
+
+// A struct holding everything the renderer keeps on the GPU
+typedef struct {
+	// The program that lights and draws instanced meshes, and where its per-set uniforms are
+	GLuint meshProgram;
+	GLint pointBaseLoc;
+	GLint meshPointsLoc;
+	GLint normalBaseLoc;
+	GLint meshNormalsLoc;
+	GLint indexBaseLoc;
+	// Every mesh (points and triangle normals), and a buffer texture the program reads them through
+	GLuint meshBuffer;
+	GLuint meshTexture;
+	// The triangles of every mesh, and a buffer texture the program reads them through
+	GLuint indexBuffer;
+	GLuint indexTexture;
+	// Each set of meshes a command can draw with (the MESH_ values)
+	MeshSet meshSets[NUM_MESH_SETS];
+	// The instances of whichever set is being drawn
+	InstanceBatch batch;
+	// The buffer every missle and bit of explosion is streamed into, and how many points fit
+	GLuint pointBuffer;
+	int pointCapacity;
+} Renderer;
+
+/*
+	This function creates a renderer. All GPU memory it will ever use is allocated here, sized to
+	hold everything the world's pools can, and every mesh is built and uploaded once.
+	loadGLFunctions must have been called first.
+	@param world The world that will be drawn.
+	@return A pointer to the renderer, or NULL (after printing why) if it could not be made.
+ */
+Renderer* createRenderer(World* world);
+
+/*
+	This function frees a renderer and everything it keeps on the GPU.
+	@param renderer A pointer to the renderer to destroy.
+ */
+void destroyRenderer(Renderer* renderer);
+
+/*
+	This function draws a frame's draw commands, which must already be sorted.
+	The modelview matrix is used as the camera.
+	@param renderer A pointer to the renderer.
+	@param commands The commands to draw.
+ */
+void drawCommands(Renderer* renderer, const CommandBuffer* commands);
+
+/*
+	This function refills a buffer that is rewritten every frame. The old contents are thrown away
+	first (the buffer is orphaned), so the upload never waits on the GPU to finish drawing the last frame.
+	The buffer is left bound.
+	@param target What to bind the buffer to.
+	@param buffer The buffer to fill.
+	@param capacity How big the buffer is in bytes.
+	@param data The new contents.
+	@param bytes How many bytes of new contents there are, at most capacity.
+ */
+void streamBuffer(GLenum target, GLuint buffer, size_t capacity, const void* data, size_t bytes);
+
+#endif
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "replay.h"
+
+/*
+	@file replay.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements recording, saving, and loading replays.
+	A file is a little endian header (magic, version, seed, tick rate, tick count)
+	followed by runs of (input byte, 16 bit run length).
+ */
+
+// The longest run a single record in the file can hold
+#define REPLAY_MAX_RUN 0xFFFF
+
+/*
+	This function writes an unsigned value to a file in little endian order.
+	@param f The file to write to.
+	@param value The value to write.
+	@param bytes How many bytes of the value to write.
+	@return True if it was written.
+ */
+static bool writeLE(FILE* f, uint64_t value, int bytes)
+{
+	unsigned char buf[8];
+	for (int i = 0; i < bytes; i++)
+		buf[i] = (unsigned char)(value >> (8 * i));
+	return fwrite(buf, 1, bytes, f) == (size_t)bytes;
+}
+
+/*
+	This function reads an unsigned little endian value from a file.
+	@param f The file to read from.
+	@param value Where to put the value.
+	@param bytes How many bytes the value takes up.
+	@return True if it was read.
+ */
+static bool readLE(FILE* f, uint64_t* value, int bytes)
+{
+	unsigned char buf[8];
+	if (fread(buf, 1, bytes, f) != (size_t)bytes)
+		return false;
+	*value = 0;
+	for (int i = 0; i < bytes; i++)
+		*value |= (uint64_t)buf[i] << (8 * i);
+	return true;
+}
+
+/*
+	This function creates an empty replay for a world.
+	@param seed The seed the world was made with.
+	@param tickRate The tick rate the world was made with.
+	@return A pointer to the replay that was made.
+*/
+Replay* createReplay(uint64_t seed, int tickRate)
+{
+	Replay* replay = (Replay*)malloc(sizeof(Replay));
+	replay->seed = seed;
+	replay->tickRate = tickRate;
+	replay->numTicks = 0;
+	replay->capacity = REPLAY_INIT_CAPACITY;
+	replay->inputs = (unsigned char*)malloc(replay->capacity);
+	return replay;
+}
+
+/*
+	This function frees a replay.
+	@param replay A pointer to the replay to destroy.
+*/
+void destroyReplay(Replay* replay)
+{
+	free(replay->inputs);
+	free(replay);
+}
+
+/*
+	This function adds a tick's input to the end of a replay.
+	@param replay A pointer to the replay to add to.
+	@param input The INPUT_ bits the tick was stepped with.
+*/
+void replayRecord(Replay* replay, unsigned int input)
+{
+	// Double the room when we run out, this happens less and less often as the game goes on
+	if (replay->numTicks == replay->capacity){
+		replay->capacity *= 2;
+		replay->inputs = (unsigned char*)realloc(replay->inputs, replay->capacity);
+	}
+	replay->inputs[replay->numTicks++] = (unsigned char)input;
+}
+
+/*
+	This function writes a replay to a file. Ticks are stored as runs of the same input
+	so long stretches of holding (or not touching) the keys take a few bytes.
+	@param replay A pointer to the replay to save.
+	@param path The file to write.
+	@return True if the whole file was written, false otherwise.
+*/
+bool saveReplay(const Replay* replay, const char* path)
+{
+	FILE* f = fopen(path, "wb");
+	if (f == NULL)
+		return false;
+
+	// Write the header
+	bool ok = writeLE(f, REPLAY_MAGIC, 4) && writeLE(f, REPLAY_VERSION, 4) &&
+		writeLE(f, replay->seed, 8) && writeLE(f, (uint64_t)replay->tickRate, 4) &&
+		writeLE(f, replay->numTicks, 4);
+
+	// Write each run of identical inputs
+	for (unsigned int i = 0; ok && (i < replay->numTicks);){
+		unsigned char input = replay->inputs[i];
+		unsigned int run = 1;
+		while (((i + run) < replay->numTicks) && (replay->inputs[i + run] == input) && (run < REPLAY_MAX_RUN))
+			run++;
+		ok = writeLE(f, input, 1) && writeLE(f, run, 2);
+		i += run;
+	}
+
+	// Closing flushes, so it can fail too
+	if (fclose(f) != 0)
+		ok = false;
+	return ok;
+}
+
+/*
+	This function reads a replay from a file.
+	@param path The file to read.
+	@return A pointer to the replay, or NULL if the file could not be read or is not a replay.
+*/
+Replay* loadReplay(const char* path)
+{
+	FILE* f = fopen(path, "rb");
+	if (f == NULL)
+		return NULL;
+
+	// Read and check the header
+	uint64_t magic, version, seed, tickRate, numTicks;
+	if (!readLE(f, &magic, 4) || !readLE(f, &version, 4) || !readLE(f, &seed, 8) ||
+		!readLE(f, &tickRate, 4) || !readLE(f, &numTicks, 4) ||
+		(magic != REPLAY_MAGIC) || (version != REPLAY_VERSION)){
+		fclose(f);
+		return NULL;
+	}
+
+	// Make room for every tick up front
+	Replay* replay = createReplay(seed, (int)tickRate);
+	if (numTicks > replay->capacity){
+		replay->capacity = (unsigned int)numTicks;
+		replay->inputs = (unsigned char*)realloc(replay->inputs, replay->capacity);
+	}
+
+	// Expand the runs back out
+	while (replay->numTicks < numTicks){
+		uint64_t input, run;
+		// A short or corrupt file is no good to anyone
+		if (!readLE(f, &input, 1) || !readLE(f, &run, 2) || (run == 0) || (run > (numTicks - replay->numTicks))){
+			destroyReplay(replay);
+			fclose(f);
+			return NULL;
+		}
+		for (uint64_t i = 0; i < run; i++)
+			replay->inputs[replay->numTicks++] = (unsigned char)input;
+	}
+
+	fclose(f);
+	return replay;
+}
@@ -0,0 +1,72 @@
+#ifndef __REPLAY__
+#define __REPLAY__
+
+#include <stdint.h>
+
+/*
+	@file replay.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines a recording of a game: the seed and tick rate it was played with
+	and the input bits for every tick. Feeding the inputs back into a world made with the same
+	seed and tick rate plays the exact same game again.
+*/
+
+// The first four bytes of every replay file
+#define REPLAY_MAGIC 0x52545341
+// The version of the file layout, bump it whenever the layout or the simulation changes
+#define REPLAY_VERSION 1
+// How many ticks of room a replay starts with
+#define REPLAY_INIT_CAPACITY 4096
+
+// A struct holding a recorded game
+typedef struct {
+	// The seed the world was made with
+	uint64_t seed;
+	// The tick rate the world was made with
+	int tickRate;
+	// The input bits for every tick, in order
+	unsigned char* inputs;
+	// The number of ticks recorded
+	unsigned int numTicks;
+	// The number of ticks there is room for
+	unsigned int capacity;
+} Replay;
+
+/*
+	This function creates an empty replay for a world.
+	@param seed The seed the world was made with.
+	@param tickRate The tick rate the world was made with.
+	@return A pointer to the replay that was made.
+ */
+Replay* createReplay(uint64_t seed, int tickRate);
+
+/*
+	This function frees a replay.
+	@param replay A pointer to the replay to destroy.
+ */
+void destroyReplay(Replay* replay);
+
+/*
+	This function adds a tick's input to the end of a replay.
+	@param replay A pointer to the replay to add to.
+	@param input The INPUT_ bits the tick was stepped with.
+ */
+void replayRecord(Replay* replay, unsigned int input);
+
+/*
+	This function writes a replay to a file. Ticks are stored as runs of the same input
+	so long stretches of holding (or not touching) the keys take a few bytes.
+	@param replay A pointer to the replay to save.
+	@param path The file to write.
+	@return True if the whole file was written, false otherwise.
+ */
+bool saveReplay(const Replay* replay, const char* path);
+
+/*
+	This function reads a replay from a file.
+	@param path The file to read.
+	@return A pointer to the replay, or NULL if the file could not be read or is not a replay.
+ */
+Replay* loadReplay(const char* path);
+
+#endif
@@ -0,0 +1,70 @@
+#include "rng.h"
+
+/*
+	@file rng.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements a counter based random number generator built on the
+	SplitMix64 finalizer. Drawing a number is a handful of multiplies and shifts.
+ */
+
+// The golden ratio in 64 bits, used to spread counters out before mixing
+#define RNG_GOLDEN 0x9E3779B97F4A7C15ULL
+
+/*
+	This function scrambles 64 bits so every input bit affects every output bit.
+	@param z The bits to scramble.
+	@return The scrambled bits.
+ */
+static inline uint64_t mix64(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/*
+	This function mixes a stream key and a counter into a random number.
+	It has no state, the same key and counter always give the same number.
+	@param key The stream key.
+	@param counter Which number in the stream to make.
+	@return 64 random bits.
+*/
+uint64_t rngHash(uint64_t key, uint64_t counter)
+{
+	return mix64(key + ((counter + 1) * RNG_GOLDEN));
+}
+
+/*
+	This function starts a stream.
+	@param rng A pointer to the stream to start.
+	@param seed The seed shared by everything in a world.
+	@param stream The id of this stream under the seed.
+*/
+void seedRng(Rng* rng, uint64_t seed, uint64_t stream)
+{
+	// Hash the seed and stream id together so nearby seeds and ids give unrelated keys
+	rng->key = mix64(mix64(seed) ^ (stream * RNG_GOLDEN));
+	rng->counter = 0;
+}
+
+/*
+	This function draws the next number from a stream.
+	@param rng A pointer to the stream to draw from.
+	@return 32 random bits.
+*/
+uint32_t rngNext(Rng* rng)
+{
+	return (uint32_t)(rngHash(rng->key, rng->counter++) >> 32);
+}
+
+/*
+	This function draws a whole number in [0, n) from a stream, like rand() % n.
+	@param rng A pointer to the stream to draw from.
+	@param n The number of values to pick from, must be positive.
+	@return The number picked.
+*/
+int rngInt(Rng* rng, int n)
+{
+	// Scale 32 random bits into the range with a multiply instead of a divide
+	return (int)(((uint64_t)rngNext(rng) * (uint32_t)n) >> 32);
+}
@@ -0,0 +1,60 @@
+#ifndef __RNG__
+#define __RNG__
+
+#include <stdint.h>
+
+/*
+	@file rng.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines a small counter based random number generator.
+	Every number is a hash of a stream key and how many numbers the stream has handed out,
+	so streams never share state and any number of them can be used side by side.
+*/
+
+// Stream ids, every world and every entity that needs randomness draws from its own stream
+// The stream the world uses for spawning and setting up levels
+#define RNG_STREAM_WORLD 0
+// Aliens get stream RNG_STREAM_ALIENS + n, where n counts the aliens spawned in the world
+#define RNG_STREAM_ALIENS 0x100000000ULL
+
+// A struct describing one stream of random numbers
+typedef struct {
+	// The key picking out this stream, made from a seed and a stream id
+	uint64_t key;
+	// How many numbers have been drawn from the stream
+	uint64_t counter;
+} Rng;
+
+/*
+	This function mixes a stream key and a counter into a random number.
+	It has no state, the same key and counter always give the same number.
+	@param key The stream key.
+	@param counter Which number in the stream to make.
+	@return 64 random bits.
+ */
+uint64_t rngHash(uint64_t key, uint64_t counter);
+
+/*
+	This function starts a stream.
+	@param rng A pointer to the stream to start.
+	@param seed The seed shared by everything in a world.
+	@param stream The id of this stream under the seed.
+ */
+void seedRng(Rng* rng, uint64_t seed, uint64_t stream);
+
+/*
+	This function draws the next number from a stream.
+	@param rng A pointer to the stream to draw from.
+	@return 32 random bits.
+ */
+uint32_t rngNext(Rng* rng);
+
+/*
+	This function draws a whole number in [0, n) from a stream, like rand() % n.
+	@param rng A pointer to the stream to draw from.
+	@param n The number of values to pick from, must be positive.
+	@return The number picked.
+ */
+int rngInt(Rng* rng, int n);
+
+#endif
@@ -0,0 +1,548 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "scene.h"
+
+/*
+	@file scene.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements scenes and the triple buffer they are handed over in. The writer always
+	has a scene of its own to fill, and once it is filled it is swapped with the one in between.
+	The reader swaps the one in between with its own only when a fresh one is there, so neither
+	ever waits and the reader always gets the newest tick. Before every tick the writer remembers
+	where everything is, so each scene can say where each object was one tick earlier.
+ */
+
+// The range angles are kept in
+#define ANGLE_LOWER 0.0f
+#define ANGLE_UPPER 360.0f
+
+/*
+	This is a helper function that copies an object's transform and material into a scene object.
+	@param object The scene object to fill in.
+	@param x The x co-ordinate of the object.
+	@param y The y co-ordinate of the object.
+	@param z The z co-ordinate of the object.
+	@param spin The angle the object is turned by.
+	@param prev Where the object was the tick before, or NULL if it was not around.
+	@param prevSpin The angle the object was turned by the tick before.
+	@param axis The axis the object is turned around.
+	@param scale How big the object is on each axis.
+	@param mat The material of the object.
+	@param mesh Which mesh the object is drawn with.
+ */
+static void setObject(SceneObject* object, float x, float y, float z, float spin, const float* prev, float prevSpin,
+	const float axis[3], const float scale[3], const float mat[4], int mesh)
+{
+	object->pos[X_] = x;
+	object->pos[Y_] = y;
+	object->pos[Z_] = z;
+	object->spin = spin;
+	// Anything new this tick is drawn where it is
+	if (prev != NULL){
+		memcpy(object->prevPos, prev, sizeof(object->prevPos));
+		object->prevSpin = prevSpin;
+	}
+	else {
+		memcpy(object->prevPos, object->pos, sizeof(object->prevPos));
+		object->prevSpin = spin;
+	}
+	memcpy(object->axis, axis, sizeof(object->axis));
+	memcpy(object->scale, scale, sizeof(object->scale));
+	memcpy(object->mat, mat, sizeof(object->mat));
+	object->mesh = mesh;
+}
+
+/*
+	This is a helper function that adds a point to a scene.
+	@param scene The scene to add the point to.
+	@param index Where in the scene's points to put it.
+	@param x The x co-ordinate of the point.
+	@param y The y co-ordinate of the point.
+	@param z The z co-ordinate of the point.
+	@param prev Where the point was the tick before, or NULL if it was not around.
+	@param color The color of the point.
+ */
+static void setPoint(Scene* scene, int index, float x, float y, float z, const float* prev, const unsigned char color[4])
+{
+	PointVertex* point = &scene->points[index];
+	point->pos[X_] = x;
+	point->pos[Y_] = y;
+	point->pos[Z_] = z;
+	memcpy(point->color, color, sizeof(point->color));
+	memcpy(scene->prevPoints[index], (prev != NULL) ? prev : point->pos, sizeof(scene->prevPoints[index]));
+}
+
+/*
+	This is a helper function that finds where the object in a slot was the tick before.
+	@param history Where everything in the pool was, or NULL if nothing is remembered.
+	@param pool The pool the object is in.
+	@param slot The slot the object is in.
+	@return A pointer to where the object was (its first point), or NULL if the object was not in the slot the tick before.
+ */
+static const float* recall(const PoolHistory* history, const ObjectPool* pool, int slot)
+{
+	if ((history == NULL) || !history->live[slot] || (history->generations[slot] != pool->generations[slot]))
+		return NULL;
+	return history->points[slot * history->pointsPerSlot];
+}
+
+/*
+	This is a helper function that adds every missle in a pool to a scene's points.
+	@param scene The scene to add the points to.
+	@param count How many points are already there.
+	@param shots The pool of missles.
+	@param history Where every missle in the pool was, or NULL if nothing is remembered.
+	@param color The color to draw the missles.
+	@return How many points are there now.
+ */
+static int addShots(Scene* scene, int count, const ObjectPool* shots, const PoolHistory* history, const unsigned char color[4])
+{
+	MotionStore* motion = shots->motion;
+	for (int i = 0; i < shots->highWater; i++){
+		// Skip empty slots
+		if (!shots->live[i])
+			continue;
+		setPoint(scene, count++, motion->posX[i], motion->posY[i], Z_LEVEL, recall(history, shots, i), color);
+	}
+	return count;
+}
+
+/*
+	This is a helper function that allocates room in a scene for everything a world's pools can hold.
+	@param scene A pointer to the scene.
+	@param world The world the scene will be taken of.
+ */
+static void allocateScene(Scene* scene, const World* world)
+{
+	int maxPoints = world->playerShots->capacity + world->alienShots->capacity + (world->explosions->capacity * EXPLOSION_NUM_PTS);
+	memset(scene, 0, sizeof(Scene));
+	scene->asteroids = (SceneObject*)malloc(world->asteroids->capacity * sizeof(SceneObject));
+	scene->aliens = (SceneObject*)malloc(world->aliens->capacity * sizeof(SceneObject));
+	scene->points = (PointVertex*)malloc(maxPoints * sizeof(PointVertex));
+	scene->prevPoints = (float(*)[3])malloc(maxPoints * sizeof(float[3]));
+}
+
+/*
+	This is a helper function that frees everything allocateScene allocated.
+	@param scene A pointer to the scene.
+ */
+static void freeScene(Scene* scene)
+{
+	free(scene->asteroids);
+	free(scene->aliens);
+	free(scene->points);
+	free(scene->prevPoints);
+}
+
+/*
+	This is a helper function that allocates room to remember every slot of a pool.
+	@param history A pointer to the history to set up.
+	@param pool The pool that will be remembered.
+	@param pointsPerSlot How many points each object has.
+ */
+static void allocatePoolHistory(PoolHistory* history, const ObjectPool* pool, int pointsPerSlot)
+{
+	history->capacity = pool->capacity;
+	history->pointsPerSlot = pointsPerSlot;
+	history->live = (bool*)calloc(pool->capacity, sizeof(bool));
+	history->generations = (unsigned int*)calloc(pool->capacity, sizeof(unsigned int));
+	history->points = (float(*)[3])calloc(pool->capacity * pointsPerSlot, sizeof(float[3]));
+	history->spin = (float*)calloc(pool->capacity, sizeof(float));
+}
+
+/*
+	This is a helper function that frees everything allocatePoolHistory allocated.
+	@param history A pointer to the history.
+ */
+static void freePoolHistory(PoolHistory* history)
+{
+	free(history->live);
+	free(history->generations);
+	free(history->points);
+	free(history->spin);
+}
+
+/*
+	This is a helper function that remembers which slots of a pool are live, and their generations.
+	@param history A pointer to the history.
+	@param pool The pool to remember.
+ */
+static void rememberSlots(PoolHistory* history, const ObjectPool* pool)
+{
+	memcpy(history->live, pool->live, pool->highWater * sizeof(bool));
+	memset(history->live + pool->highWater, 0, (pool->capacity - pool->highWater) * sizeof(bool));
+	memcpy(history->generations, pool->generations, pool->highWater * sizeof(unsigned int));
+}
+
+/*
+	This is a helper function that remembers where an object with one point was and how it was turned.
+	@param history A pointer to the history.
+	@param slot The slot the object is in.
+	@param x The x co-ordinate of the object.
+	@param y The y co-ordinate of the object.
+	@param z The z co-ordinate of the object.
+	@param spin The angle the object is turned by.
+ */
+static void rememberObject(PoolHistory* history, int slot, float x, float y, float z, float spin)
+{
+	float* point = history->points[slot];
+	point[X_] = x;
+	point[Y_] = y;
+	point[Z_] = z;
+	history->spin[slot] = spin;
+}
+
+/*
+	This function creates a scene with room for everything a world's pools can hold, holding the world as it is now.
+	@param world The world the scene will be taken of.
+	@return A pointer to the scene.
+*/
+Scene* createScene(const World* world)
+{
+	Scene* scene = (Scene*)malloc(sizeof(Scene));
+	allocateScene(scene, world);
+	captureScene(world, NULL, scene);
+	return scene;
+}
+
+/*
+	This function frees a scene made by createScene.
+	@param scene A pointer to the scene to destroy.
+*/
+void destroyScene(Scene* scene)
+{
+	if (scene == NULL)
+		return;
+	freeScene(scene);
+	free(scene);
+}
+
+/*
+	This function copies everything needed to draw a world into a scene.
+	The scene must have been sized for the world by createScene or createSceneBuffer.
+	@param world The world to copy.
+	@param history Where everything was the tick before, or NULL to blend nothing.
+	@param scene A pointer to the scene to fill in.
+*/
+void captureScene(const World* world, const SceneHistory* history, Scene* scene)
+{
+	const unsigned char cyan[] = { 0, 255, 255, 255 };
+	const unsigned char red[] = { 255, 0, 0, 255 };
+	const unsigned char white[] = { 255, 255, 255, 255 };
+	const float unitScale[] = { 1.0f, 1.0f, 1.0f };
+	// Only use the history if there is one
+	if ((history != NULL) && !history->valid)
+		history = NULL;
+	scene->tick = world->ticks;
+	scene->time = profileNow();
+	scene->tickLength = 1000000000LL / world->tickRate;
+
+	// Every asteroid, their motion lives in the pool's motion store
+	ObjectPool* asteroids = world->asteroids;
+	MotionStore* motion = asteroids->motion;
+	scene->numAsteroids = 0;
+	for (int i = 0; i < asteroids->highWater; i++){
+		Asteroid* a = (Asteroid*)poolSlot(asteroids, i);
+		if (a == NULL)
+			continue;
+		const float* prev = recall(history ? &history->asteroids : NULL, asteroids, i);
+		setObject(&scene->asteroids[scene->numAsteroids++], motion->posX[i], motion->posY[i], Z_LEVEL,
+			motion->spin[i], prev, prev ? history->asteroids.spin[i] : 0.0f, a->orientation, a->scale, a->mat, a->variant);
+	}
+
+	// Every alien, drawn with the mesh of its size
+	ObjectPool* aliens = world->aliens;
+	scene->numAliens = 0;
+	for (int i = 0; i < aliens->highWater; i++){
+		Alien* a = (Alien*)poolSlot(aliens, i);
+		if (a == NULL)
+			continue;
+		const float* prev = recall(history ? &history->aliens : NULL, aliens, i);
+		setObject(&scene->aliens[scene->numAliens++], a->positionVector[X_], a->positionVector[Y_], a->positionVector[Z_],
+			a->spin, prev, prev ? history->aliens.spin[i] : 0.0f, a->orientation, unitScale, a->mat, a->isBig ? ALIEN_CLASS_LARGE : ALIEN_CLASS_SMALL);
+	}
+
+	// The player
+	PlayerShip* p = world->p;
+	setObject(&scene->player, p->positionVector[X_], p->positionVector[Y_], p->positionVector[Z_],
+		p->spin, history ? history->playerPos : NULL, history ? history->playerSpin : 0.0f, p->orientation, p->scale, p->mat, 0);
+
+	// Every missle first, they are all the same size
+	int count = addShots(scene, 0, world->playerShots, history ? &history->playerShots : NULL, cyan);
+	count = addShots(scene, count, world->alienShots, history ? &history->alienShots : NULL, red);
+	scene->numShots = count;
+	// Then every bit of every explosion
+	ObjectPool* explosions = world->explosions;
+	for (int i = 0; i < explosions->highWater; i++){
+		Explosion* exp = (Explosion*)poolSlot(explosions, i);
+		if (exp == NULL)
+			continue;
+		const float* prev = recall(history ? &history->explosions : NULL, explosions, i);
+		for (int j = 0; j < EXPLOSION_NUM_PTS; j++)
+			setPoint(scene, count++, exp->positionVector[X_] + exp->points[j][X_], exp->positionVector[Y_] + exp->points[j][Y_],
+				exp->positionVector[Z_] + exp->points[j][Z_], prev ? prev + (j * 3) : NULL, white);
+	}
+	scene->numPoints = count;
+
+	// And the score line
+	scene->score = p->score;
+	scene->deathsLeft = p->deathsLeft;
+}
+
+/*
+	This function finds how far between a scene's last tick and its newest one a moment is.
+	@param scene The scene.
+	@param now The moment, in nanoseconds on the profileNow clock.
+	@return 0 for the tick before, 1 for the newest tick (and any time after it), or anything between.
+*/
+float sceneAlpha(const Scene* scene, int64_t now)
+{
+	float alpha = (float)(now - scene->time) / (float)scene->tickLength;
+	if (alpha < 0.0f)
+		return 0.0f;
+	if (alpha > 1.0f)
+		return 1.0f;
+	return alpha;
+}
+
+/*
+	This is a helper function that blends a value that wraps around, taking the short way around.
+	@param from Where the value was.
+	@param to Where the value is now.
+	@param alpha How far to blend.
+	@param lower The lower bound the value wraps at.
+	@param upper The upper bound the value wraps at.
+	@param maxJump The farthest the value can move and still be blended.
+	@return The blended value, wrapped back into [lower, upper].
+ */
+static float blendWrapped(float from, float to, float alpha, float lower, float upper, float maxJump)
+{
+	float span = upper - lower;
+	float delta = to - from;
+	// If it went off one edge and came back on the other, it really only moved a little
+	if (delta > span / 2)
+		delta -= span;
+	else if (delta < -span / 2)
+		delta += span;
+	// It was put there, not moved there
+	if (fabsf(delta) > maxJump)
+		return to;
+	// Blend back from where it is now, so it lands exactly there at alpha 1
+	float value = to - (delta * (1.0f - alpha));
+	if (value > upper)
+		value -= span;
+	else if (value < lower)
+		value += span;
+	return value;
+}
+
+/*
+	This is a helper function that blends a scene object between where it was and where it is.
+	@param object The object to blend.
+	@param alpha How far to blend.
+	@param out Where to put the blended object.
+ */
+static void blendObject(const SceneObject* object, float alpha, SceneObject* out)
+{
+	*out = *object;
+	out->pos[X_] = blendWrapped(object->prevPos[X_], object->pos[X_], alpha, BOUND_X_LOWER, BOUND_X_UPPER, SCENE_MAX_JUMP);
+	out->pos[Y_] = blendWrapped(object->prevPos[Y_], object->pos[Y_], alpha, BOUND_Y_LOWER, BOUND_Y_UPPER, SCENE_MAX_JUMP);
+	// Nothing moves in depth
+	out->spin = blendWrapped(object->prevSpin, object->spin, alpha, ANGLE_LOWER, ANGLE_UPPER, ANGLE_UPPER);
+	memcpy(out->prevPos, out->pos, sizeof(out->prevPos));
+	out->prevSpin = out->spin;
+}
+
+/*
+	This function blends everything in a scene between where it was the tick before and where it is now.
+	Anything that wrapped around the edge of the screen is blended the short way around, and
+	anything that jumped farther than SCENE_MAX_JUMP is drawn where it is now.
+	@param scene The scene to blend.
+	@param alpha How far to blend, 0 for the tick before and 1 for now.
+	@param out A pointer to the scene to fill in, sized for the same world.
+*/
+void interpolateScene(const Scene* scene, float alpha, Scene* out)
+{
+	// Everything that is not blended is copied straight over
+	out->tick = scene->tick;
+	out->time = scene->time;
+	out->tickLength = scene->tickLength;
+	out->numAsteroids = scene->numAsteroids;
+	out->numAliens = scene->numAliens;
+	out->numShots = scene->numShots;
+	out->numPoints = scene->numPoints;
+	out->score = scene->score;
+	out->deathsLeft = scene->deathsLeft;
+
+	// Blend every object
+	for (int i = 0; i < scene->numAsteroids; i++)
+		blendObject(&scene->asteroids[i], alpha, &out->asteroids[i]);
+	for (int i = 0; i < scene->numAliens; i++)
+		blendObject(&scene->aliens[i], alpha, &out->aliens[i]);
+	blendObject(&scene->player, alpha, &out->player);
+
+	// And every point, missles wrap around the screen but explosions just spread out
+	for (int i = 0; i < scene->numPoints; i++){
+		const float* from = scene->prevPoints[i];
+		const PointVertex* to = &scene->points[i];
+		PointVertex* point = &out->points[i];
+		if (i < scene->numShots){
+			point->pos[X_] = blendWrapped(from[X_], to->pos[X_], alpha, BOUND_X_LOWER, BOUND_X_UPPER, SCENE_MAX_JUMP);
+			point->pos[Y_] = blendWrapped(from[Y_], to->pos[Y_], alpha, BOUND_Y_LOWER, BOUND_Y_UPPER, SCENE_MAX_JUMP);
+		}
+		else {
+			point->pos[X_] = to->pos[X_] - ((to->pos[X_] - from[X_]) * (1.0f - alpha));
+			point->pos[Y_] = to->pos[Y_] - ((to->pos[Y_] - from[Y_]) * (1.0f - alpha));
+		}
+		point->pos[Z_] = to->pos[Z_] - ((to->pos[Z_] - from[Z_]) * (1.0f - alpha));
+		memcpy(point->color, to->color, sizeof(point->color));
+		memcpy(out->prevPoints[i], point->pos, sizeof(out->prevPoints[i]));
+	}
+}
+
+/*
+	This function creates a scene buffer with room in every scene for everything the world's pools can hold.
+	Every scene starts out holding the world as it is now.
+	@param world The world the scenes will be taken of.
+	@return A pointer to the scene buffer.
+*/
+SceneBuffer* createSceneBuffer(const World* world)
+{
+	// The atomic needs a real constructor
+	SceneBuffer* buffer = new SceneBuffer();
+	for (int i = 0; i < SCENE_SLOTS; i++){
+		allocateScene(&buffer->slots[i], world);
+		captureScene(world, NULL, &buffer->slots[i]);
+	}
+	// Nothing has been remembered until the first tick
+	SceneHistory* history = &buffer->history;
+	allocatePoolHistory(&history->asteroids, world->asteroids, 1);
+	allocatePoolHistory(&history->aliens, world->aliens, 1);
+	allocatePoolHistory(&history->playerShots, world->playerShots, 1);
+	allocatePoolHistory(&history->alienShots, world->alienShots, 1);
+	allocatePoolHistory(&history->explosions, world->explosions, EXPLOSION_NUM_PTS);
+	history->valid = false;
+	// The writer starts on the first, the reader on the last, and nothing is fresh yet
+	buffer->back = 0;
+	buffer->shared.store(1);
+	buffer->front = 2;
+	return buffer;
+}
+
+/*
+	This function frees a scene buffer and every scene in it.
+	@param buffer A pointer to the scene buffer to destroy.
+*/
+void destroySceneBuffer(SceneBuffer* buffer)
+{
+	if (buffer == NULL)
+		return;
+	for (int i = 0; i < SCENE_SLOTS; i++)
+		freeScene(&buffer->slots[i]);
+	freePoolHistory(&buffer->history.asteroids);
+	freePoolHistory(&buffer->history.aliens);
+	freePoolHistory(&buffer->history.playerShots);
+	freePoolHistory(&buffer->history.alienShots);
+	freePoolHistory(&buffer->history.explosions);
+	delete buffer;
+}
+
+/*
+	This function remembers where everything in a world is, it should be called right before
+	each tick so the next scene published knows where everything was. Only the writing thread may call it.
+	@param buffer A pointer to the scene buffer.
+	@param world The world about to be ticked.
+*/
+void rememberTick(SceneBuffer* buffer, const World* world)
+{
+	SceneHistory* history = &buffer->history;
+
+	// The asteroids
+	ObjectPool* asteroids = world->asteroids;
+	rememberSlots(&history->asteroids, asteroids);
+	for (int i = 0; i < asteroids->highWater; i++)
+		if (asteroids->live[i])
+			rememberObject(&history->asteroids, i, asteroids->motion->posX[i], asteroids->motion->posY[i], Z_LEVEL, asteroids->motion->spin[i]);
+
+	// The aliens
+	ObjectPool* aliens = world->aliens;
+	rememberSlots(&history->aliens, aliens);
+	for (int i = 0; i < aliens->highWater; i++){
+		Alien* a = (Alien*)poolSlot(aliens, i);
+		if (a != NULL)
+			rememberObject(&history->aliens, i, a->positionVector[X_], a->positionVector[Y_], a->positionVector[Z_], a->spin);
+	}
+
+	// The missles
+	ObjectPool* shots[] = { world->playerShots, world->alienShots };
+	PoolHistory* shotHistories[] = { &history->playerShots, &history->alienShots };
+	for (int k = 0; k < 2; k++){
+		rememberSlots(shotHistories[k], shots[k]);
+		for (int i = 0; i < shots[k]->highWater; i++)
+			if (shots[k]->live[i])
+				rememberObject(shotHistories[k], i, shots[k]->motion->posX[i], shots[k]->motion->posY[i], Z_LEVEL, 0.0f);
+	}
+
+	// Every bit of every explosion
+	ObjectPool* explosions = world->explosions;
+	rememberSlots(&history->explosions, explosions);
+	for (int i = 0; i < explosions->highWater; i++){
+		Explosion* exp = (Explosion*)poolSlot(explosions, i);
+		if (exp == NULL)
+			continue;
+		for (int j = 0; j < EXPLOSION_NUM_PTS; j++){
+			float* point = history->explosions.points[(i * EXPLOSION_NUM_PTS) + j];
+			for (int k = 0; k < 3; k++)
+				point[k] = exp->positionVector[k] + exp->points[j][k];
+		}
+	}
+
+	// And the player
+	memcpy(history->playerPos, world->p->positionVector, sizeof(history->playerPos));
+	history->playerSpin = world->p->spin;
+	history->valid = true;
+}
+
+/*
+	This function takes a scene of a world and hands it to the reading thread, replacing any
+	scene it has not taken yet. Only the writing thread may call it.
+	@param buffer A pointer to the scene buffer.
+	@param world The world to take the scene of.
+	@param time When the world's newest tick was due in real time (in nanoseconds on the profileNow clock).
+*/
+void publishScene(SceneBuffer* buffer, const World* world, int64_t time)
+{
+	Scene* scene = &buffer->slots[buffer->back];
+	captureScene(world, &buffer->history, scene);
+	scene->time = time;
+	// Release the scene to the reader, and take back whichever one was in between
+	unsigned int old = buffer->shared.exchange(buffer->back | SCENE_FRESH, std::memory_order_acq_rel);
+	buffer->back = old & SCENE_INDEX_MASK;
+}
+
+/*
+	This function checks if a scene has been published since the reading thread last took one.
+	@param buffer A pointer to the scene buffer.
+	@return True if there is a newer scene to take.
+*/
+bool sceneWaiting(SceneBuffer* buffer)
+{
+	return (buffer->shared.load(std::memory_order_relaxed) & SCENE_FRESH) != 0;
+}
+
+/*
+	This function takes the newest scene published, or keeps the last one if nothing new has been.
+	The scene stays untouched until the next call. Only the reading thread may call it.
+	@param buffer A pointer to the scene buffer.
+	@return A pointer to the newest scene.
+*/
+const Scene* latestScene(SceneBuffer* buffer)
+{
+	// Only swap when there is something fresh, otherwise we would hand back an older scene
+	if (sceneWaiting(buffer)){
+		unsigned int old = buffer->shared.exchange(buffer->front, std::memory_order_acq_rel);
+		buffer->front = old & SCENE_INDEX_MASK;
+	}
+	return &buffer->slots[buffer->front];
+}
@@ -0,0 +1,213 @@
+#ifndef __SCENE__
+#define __SCENE__
+
+#include <stdint.h>
+#include <atomic>
+#include "objects.h"
+#include "world.h"
+
+/*
+	@file scene.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines scenes, copies of everything needed to draw one tick of a world
+	(where things are, how they are turned, what they are made of, and every point), and a
+	triple buffer for handing them from the thread running the world to the thread drawing it.
+	A scene never changes after it is handed over, so drawing never has to touch the live world
+	and neither thread ever waits on the other.
+	Each scene also holds where everything was the tick before, so drawing can blend between the
+	two and show smooth motion no matter how slowly the world is ticked.
+	Nothing in here knows about GLUT or OpenGL.
+*/
+
+// The number of scenes a scene buffer holds, one being written, one being drawn, and one in between
+#define SCENE_SLOTS 3
+// The bit set on the shared slot when it holds a scene the drawing thread has not taken yet
+#define SCENE_FRESH 0x4
+// The bits of the shared slot that say which scene it is
+#define SCENE_INDEX_MASK 0x3
+// The alien size classes, each has its own mesh
+#define ALIEN_CLASS_LARGE 0
+#define ALIEN_CLASS_SMALL 1
+#define NUM_ALIEN_CLASSES 2
+// The farthest anything can move in one tick and still be blended, anything farther was put there
+#define SCENE_MAX_JUMP 2.0f
+
+// A struct holding what is needed to draw one object made of a mesh
+typedef struct {
+	// Where the object is, and where it was the tick before
+	float pos[3];
+	float prevPos[3];
+	// The angle the object is turned by (and was the tick before), and the axis it is turned around
+	float spin;
+	float prevSpin;
+	float axis[3];
+	// How big the object is on each axis
+	float scale[3];
+	// The material to draw with
+	float mat[4];
+	// Which mesh to draw it with (the asteroid shape, or the alien size class)
+	int mesh;
+} SceneObject;
+
+// A struct holding one colored point (a missle or a bit of an explosion)
+typedef struct {
+	// Where the point is
+	float pos[3];
+	// The color of the point
+	unsigned char color[4];
+} PointVertex;
+
+// A struct holding everything needed to draw one tick of a world
+typedef struct {
+	// The tick the scene was taken after
+	unsigned int tick;
+	// When the tick was due in real time, and how long a tick lasts (in nanoseconds, on the profileNow clock)
+	int64_t time;
+	int64_t tickLength;
+	// Every asteroid
+	SceneObject* asteroids;
+	int numAsteroids;
+	// Every alien, the mesh is its size class
+	SceneObject* aliens;
+	int numAliens;
+	// The player's ship
+	SceneObject player;
+	// Every missle, then every bit of every explosion, and where each was the tick before
+	PointVertex* points;
+	float (*prevPoints)[3];
+	int numShots;
+	int numPoints;
+	// What goes on the score line
+	int score;
+	int deathsLeft;
+} Scene;
+
+// A struct remembering where every object in a pool was on the last tick
+typedef struct {
+	// Whether each slot was live, and its generation, so an object is only blended with itself
+	bool* live;
+	unsigned int* generations;
+	// Where each slot was (pointsPerSlot points a slot), and the angle it was turned by
+	float (*points)[3];
+	float* spin;
+	int pointsPerSlot;
+	// The number of slots remembered
+	int capacity;
+} PoolHistory;
+
+// A struct remembering where everything in a world was on the last tick
+typedef struct {
+	// Where the player was and how it was turned
+	float playerPos[3];
+	float playerSpin;
+	// Every pool
+	PoolHistory asteroids;
+	PoolHistory aliens;
+	PoolHistory playerShots;
+	PoolHistory alienShots;
+	PoolHistory explosions;
+	// Whether anything has been remembered yet
+	bool valid;
+} SceneHistory;
+
+// A struct holding three scenes handed from one writing thread to one reading thread
+typedef struct {
+	// The scenes
+	Scene slots[SCENE_SLOTS];
+	// Where everything was the tick before the one being written, only the writing thread touches it
+	SceneHistory history;
+	// The scene in between the two threads, with SCENE_FRESH set if it is newer than the one being read
+	std::atomic<unsigned int> shared;
+	// The scene being written, only the writing thread touches it
+	unsigned int back;
+	// The scene being read, only the reading thread touches it
+	unsigned int front;
+} SceneBuffer;
+
+/*
+	This function creates a scene with room for everything a world's pools can hold, holding the world as it is now.
+	@param world The world the scene will be taken of.
+	@return A pointer to the scene.
+ */
+Scene* createScene(const World* world);
+
+/*
+	This function frees a scene made by createScene.
+	@param scene A pointer to the scene to destroy.
+ */
+void destroyScene(Scene* scene);
+
+/*
+	This function copies everything needed to draw a world into a scene.
+	The scene must have been sized for the world by createScene or createSceneBuffer.
+	@param world The world to copy.
+	@param history Where everything was the tick before, or NULL to blend nothing.
+	@param scene A pointer to the scene to fill in.
+ */
+void captureScene(const World* world, const SceneHistory* history, Scene* scene);
+
+/*
+	This function finds how far between a scene's last tick and its newest one a moment is.
+	@param scene The scene.
+	@param now The moment, in nanoseconds on the profileNow clock.
+	@return 0 for the tick before, 1 for the newest tick (and any time after it), or anything between.
+ */
+float sceneAlpha(const Scene* scene, int64_t now);
+
+/*
+	This function blends everything in a scene between where it was the tick before and where it is now.
+	Anything that wrapped around the edge of the screen is blended the short way around, and
+	anything that jumped farther than SCENE_MAX_JUMP is drawn where it is now.
+	@param scene The scene to blend.
+	@param alpha How far to blend, 0 for the tick before and 1 for now.
+	@param out A pointer to the scene to fill in, sized for the same world.
+ */
+void interpolateScene(const Scene* scene, float alpha, Scene* out);
+
+/*
+	This function creates a scene buffer with room in every scene for everything the world's pools can hold.
+	Every scene starts out holding the world as it is now.
+	@param world The world the scenes will be taken of.
+	@return A pointer to the scene buffer.
+ */
+SceneBuffer* createSceneBuffer(const World* world);
+
+/*
+	This function frees a scene buffer and every scene in it.
+	@param buffer A pointer to the scene buffer to destroy.
+ */
+void destroySceneBuffer(SceneBuffer* buffer);
+
+/*
+	This function remembers where everything in a world is, it should be called right before
+	each tick so the next scene published knows where everything was. Only the writing thread may call it.
+	@param buffer A pointer to the scene buffer.
+	@param world The world about to be ticked.
+ */
+void rememberTick(SceneBuffer* buffer, const World* world);
+
+/*
+	This function takes a scene of a world and hands it to the reading thread, replacing any
+	scene it has not taken yet. Only the writing thread may call it.
+	@param buffer A pointer to the scene buffer.
+	@param world The world to take the scene of.
+	@param time When the world's newest tick was due in real time (in nanoseconds on the profileNow clock).
+ */
+void publishScene(SceneBuffer* buffer, const World* world, int64_t time);
+
+/*
+	This function checks if a scene has been published since the reading thread last took one.
+	@param buffer A pointer to the scene buffer.
+	@return True if there is a newer scene to take.
+ */
+bool sceneWaiting(SceneBuffer* buffer);
+
+/*
+	This function takes the newest scene published, or keeps the last one if nothing new has been.
+	The scene stays untouched until the next call. Only the reading thread may call it.
+	@param buffer A pointer to the scene buffer.
+	@return A pointer to the newest scene.
+ */
+const Scene* latestScene(SceneBuffer* buffer);
+
+#endif
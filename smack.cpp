@@ -1,7 +1,9 @@
 #include "smack.h"
 #include "objects.h"
 #include "datastructures.h"
+#include "trace.h"
 #include <math.h>
+#include <string.h>
 
 /*
 	@file smack.cpp
@@ -15,7 +17,134 @@ static bool checkPointInCircle(float radius, float sx, float sy, float x, float
 static bool checkLineInCircle(float radius, float sx, float sy, float x1, float y1, float x2, float y2);
 static bool checkPointInLine(float x, float y, float x1, float y1, float x2, float y2);
 static bool checkPointInTriangle(float ptx, float pty, float v1x, float v1y, float v2x, float v2y, float v3x, float v3y);
-static void splitOrRemove(ObjectList* list, Asteroid* asteroid, Missle* shot);
+static void splitOrRemove(ObjectPool* list, int asteroid, Missle* shot);
+
+
+/* Functions for building colliders */
+
+
+/*
+	This function works out where the player's ship can be hit, its hull in world space and
+	the circle and box around it.
+	@param ship The player ship to update.
+*/
+void updateShipCollider(PlayerShip* ship)
+{
+	Collider* c = &ship->collider;
+	c->center[X_] = ship->positionVector[X_];
+	c->center[Y_] = ship->positionVector[Y_];
+	c->radius = 0.0f;
+	c->min[X_] = c->max[X_] = c->center[X_];
+	c->min[Y_] = c->max[Y_] = c->center[Y_];
+
+	// Lay the ship's three points flat in the window the same way it is drawn
+	for (int k = 0; k < 3; k++){
+		float xtemp = (ship->scale[X_] * spaceShip[k][X_]);
+		float ytemp = (ship->scale[Z_] * spaceShip[k][Z_]);
+		float x = ship->positionVector[X_] + ytemp;
+		float y = ship->positionVector[Y_] - xtemp;
+		ship->hull[k][X_] = x;
+		ship->hull[k][Y_] = y;
+
+		// Grow the circle and box to fit the point
+		float r = sqrt((ytemp * ytemp) + (xtemp * xtemp));
+		if (r > c->radius)
+			c->radius = r;
+		if (x < c->min[X_])
+			c->min[X_] = x;
+		if (x > c->max[X_])
+			c->max[X_] = x;
+		if (y < c->min[Y_])
+			c->min[Y_] = y;
+		if (y > c->max[Y_])
+			c->max[Y_] = y;
+	}
+}
+
+/*
+	This function works out where an alien can be hit, its boxes against each kind of object
+	and the circle and box around all of them.
+	@param alien The alien to update.
+*/
+void updateAlienCollider(Alien* alien)
+{
+	// The alien's total width and height against asteroids (reduced to make collisions appear more realistic)
+	alien->asteroidBox[X_] = (1.6 * alien->torusOuterRadius) + (3.5 * alien->torusInnerRadius);
+	alien->asteroidBox[Y_] = 1.6 * alien->sphereRadius;
+	// Half its width and height against missles (reduced to look slightly more realistic)
+	float shotW = (1.5 * alien->torusOuterRadius) + (3.5 * alien->torusInnerRadius);
+	float shotH = 1.5 * alien->sphereRadius;
+	alien->shotBox[X_] = shotW / 2;
+	alien->shotBox[Y_] = shotH / 2;
+	// Half its width and height against the player
+	alien->playerBox[X_] = ((1.7 * alien->torusOuterRadius) + (3.6 * alien->torusInnerRadius)) / 2;
+	alien->playerBox[Y_] = (1.6 * alien->sphereRadius) / 2;
+
+	// The box and circle around the alien fit the biggest of those
+	Collider* c = &alien->collider;
+	c->center[X_] = alien->positionVector[X_];
+	c->center[Y_] = alien->positionVector[Y_];
+	float halfW = alien->asteroidBox[X_] / 2;
+	float halfH = alien->asteroidBox[Y_] / 2;
+	if (alien->shotBox[X_] > halfW)
+		halfW = alien->shotBox[X_];
+	if (alien->playerBox[X_] > halfW)
+		halfW = alien->playerBox[X_];
+	if (alien->shotBox[Y_] > halfH)
+		halfH = alien->shotBox[Y_];
+	if (alien->playerBox[Y_] > halfH)
+		halfH = alien->playerBox[Y_];
+	c->radius = sqrt((halfW * halfW) + (halfH * halfH));
+	c->min[X_] = c->center[X_] - halfW;
+	c->max[X_] = c->center[X_] + halfW;
+	c->min[Y_] = c->center[Y_] - halfH;
+	c->max[Y_] = c->center[Y_] + halfH;
+}
+
+/*
+	This function works out where an asteroid can be hit, its circle, its box against aliens,
+	and the box around it.
+	@param asteroids The pool of asteroids.
+	@param asteroid The slot of the asteroid to update.
+*/
+void updateAsteroidCollider(ObjectPool* asteroids, int asteroid)
+{
+	Asteroid* a = (Asteroid*)poolSlot(asteroids, asteroid);
+	Collider* c = &a->collider;
+	c->center[X_] = asteroids->motion->posX[asteroid];
+	c->center[Y_] = asteroids->motion->posY[asteroid];
+	c->radius = a->scale[X_];
+	c->min[X_] = c->center[X_] - c->radius;
+	c->max[X_] = c->center[X_] + c->radius;
+	c->min[Y_] = c->center[Y_] - c->radius;
+	c->max[Y_] = c->center[Y_] + c->radius;
+	// Its width and height against aliens (reduced to make collisions appear more realistic)
+	a->alienBox[X_] = 1.9 * a->scale[X_];
+	a->alienBox[Y_] = 1.9 * a->scale[Y_];
+}
+
+/*
+	This function rebuilds the colliders of the player, every asteroid, and every alien.
+	It runs once a tick after everything has moved, every detectCollide function reads from
+	what it stores (missles are points, so they are read straight from their motion store).
+	@param ship The player ship.
+	@param asteroids The pool of asteroids.
+	@param aliens The pool of aliens.
+*/
+void updateColliders(PlayerShip* ship, ObjectPool* asteroids, ObjectPool* aliens)
+{
+	updateShipCollider(ship);
+	for (int i = 0; i < asteroids->highWater; i++){
+		if (asteroids->live[i])
+			updateAsteroidCollider(asteroids, i);
+	}
+	for (int i = 0; i < aliens->highWater; i++){
+		Alien* a = (Alien*)poolSlot(aliens, i);
+		if (a != NULL)
+			updateAlienCollider(a);
+	}
+}
+
 
 
 /* Function for detecting collisions */
@@ -23,67 +152,64 @@ static void splitOrRemove(ObjectList* list, Asteroid* asteroid, Missle* shot);
 
 /*
 	This function determines if an Asteroid and a Missle collided.
-	@param asteroid The Asteroid to look at.
-	@param shot The Missle to look at.
+	@param asteroids The pool of Asteroids.
+	@param asteroid The slot of the Asteroid to look at.
+	@param shots The pool of Missles.
+	@param shot The slot of the Missle to look at.
 	@return True if a collision occured false otherwise.
 */
-bool detectCollideAsteroidShot(Asteroid* asteroid, Missle* shot)
+bool detectCollideAsteroidShot(ObjectPool* asteroids, int asteroid, ObjectPool* shots, int shot)
 {
+	const Collider* c = &((Asteroid*)poolSlot(asteroids, asteroid))->collider;
 	// Check a point in a circle
-	return checkPointInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
-		shot->positionVector[0], shot->positionVector[1]);
+	return checkPointInCircle(c->radius, c->center[X_], c->center[Y_], shots->motion->posX[shot], shots->motion->posY[shot]);
 }
 
 /*
 	This function determines if an Asteroid and a player collided.
-	@param asteroid The Asteroid to look at.
+	@param asteroids The pool of Asteroids.
+	@param asteroid The slot of the Asteroid to look at.
 	@param ship The player to look at.
 	@return True if a collision occured false otherwise.
 */
-bool detectCollideAsteroidShip(Asteroid* asteroid, PlayerShip* ship)
+bool detectCollideAsteroidShip(ObjectPool* asteroids, int asteroid, PlayerShip* ship)
 {
-	// Determine the point for the three lines that define the ship
-	float xtemp = (ship->scale[X_] * spaceShip[0][X_]);
-	float ytemp = (ship->scale[Z_] * spaceShip[0][Z_]);
-
-	float x1 = ship->positionVector[X_] + ytemp;
-	float y1 = ship->positionVector[Y_] - xtemp;
-
-	xtemp = (ship->scale[X_] * spaceShip[1][X_]);
-	ytemp = (ship->scale[Z_] * spaceShip[1][Z_]);
-
-	float x2 = ship->positionVector[X_] + ytemp;
-	float y2 = ship->positionVector[Y_] - xtemp;
-
-	xtemp = (ship->scale[X_] * spaceShip[2][X_]);
-	ytemp = (ship->scale[Z_] * spaceShip[2][Z_]);
-
-	float x3 = ship->positionVector[X_] + ytemp;
-	float y3 = ship->positionVector[Y_] - xtemp;
-
+	// Grab the asteroid's circle
+	const Collider* c = &((Asteroid*)poolSlot(asteroids, asteroid))->collider;
+	float radius = c->radius;
+	float sx = c->center[X_];
+	float sy = c->center[Y_];
+
+	// Grab the three points that define the ship
+	float x1 = ship->hull[0][X_];
+	float y1 = ship->hull[0][Y_];
+	float x2 = ship->hull[1][X_];
+	float y2 = ship->hull[1][Y_];
+	float x3 = ship->hull[2][X_];
+	float y3 = ship->hull[2][Y_];
 
 	// Check points in circle
-	if (checkPointInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
-		ship->positionVector[0], ship->positionVector[1]))
+	if (checkPointInCircle(radius, sx, sy,
+		ship->collider.center[X_], ship->collider.center[Y_]))
 		return true;
-	else if (checkPointInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
+	else if (checkPointInCircle(radius, sx, sy,
 		x1, y1))
 		return true;
-	else if (checkPointInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
+	else if (checkPointInCircle(radius, sx, sy,
 		x2, y2))
 		return true;
-	else if (checkPointInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
+	else if (checkPointInCircle(radius, sx, sy,
 		x3, y3))
 		return true;
 
 	// Check line segments in circle
-	if (checkLineInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
+	if (checkLineInCircle(radius, sx, sy,
 		x1, y1, x2, y2))
 		return true;
-	else if (checkLineInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
+	else if (checkLineInCircle(radius, sx, sy,
 		x2, y2, x3, y3))
 		return true;
-	else if (checkLineInCircle(asteroid->scale[0], asteroid->positionVector[0], asteroid->positionVector[1],
+	else if (checkLineInCircle(radius, sx, sy,
 		x1, y1, x3, y3))
 		return true;
 
@@ -92,20 +218,17 @@ bool detectCollideAsteroidShip(Asteroid* asteroid, PlayerShip* ship)
 
 /*
 	This function checks if a given asteroid and alien are colliding.
-	@param asteroid A pointer to the asteroid to look at.
+	@param asteroids The pool of asteroids.
+	@param asteroid The slot of the asteroid to look at.
 	@param alien A pointer to the alien ship to look att.
 	@return True if the asteroid and the alien are colliding, false otherwise.
  */
-bool detectCollideAsteroidAlien(Asteroid* asteroid, Alien* alien)
+bool detectCollideAsteroidAlien(ObjectPool* asteroids, int asteroid, Alien* alien)
 {
-	// Calculate the alien and the asteroid's total width and height (reduced to make collisions appear more realistic)
-	float alien_w = (1.6 * alien->torusOuterRadius) + (3.5 * alien->torusInnerRadius);
-	float alien_h = 1.6 * alien->sphereRadius;
-	float asteroid_w = 1.9 * asteroid->scale[X_];
-	float asteroid_h = 1.9 * asteroid->scale[Y_];
+	Asteroid* a = (Asteroid*)poolSlot(asteroids, asteroid);
 	// Check how close the alien and asteroid are
-	if ((abs(asteroid->positionVector[X_] - alien->positionVector[X_]) <= ((alien_w + asteroid_w) / 2)) &&
-		(abs(asteroid->positionVector[Y_] - alien->positionVector[Y_]) <= ((alien_h + asteroid_h) / 2)))
+	if ((abs(a->collider.center[X_] - alien->collider.center[X_]) <= ((alien->asteroidBox[X_] + a->alienBox[X_]) / 2)) &&
+		(abs(a->collider.center[Y_] - alien->collider.center[Y_]) <= ((alien->asteroidBox[Y_] + a->alienBox[Y_]) / 2)))
 		return true;
 	else return false;
 }
@@ -113,17 +236,15 @@ bool detectCollideAsteroidAlien(Asteroid* asteroid, Alien* alien)
 /*
 	This function detects if a collision has occured between a given alien and missle.
 	@param alien A pointer to the alien to look at.
-	@param missle A pointer to the missle to look at.
+	@param shots The pool of missles.
+	@param missle The slot of the missle to look at.
 	@return True if the given alien and missle are colliding.
  */
-bool detectCollideAlienShot(Alien* alien, Missle* missle)
+bool detectCollideAlienShot(Alien* alien, ObjectPool* shots, int missle)
 {
-	// Calculate the alien's width and height (reduced to look slightly more realistic)
-	float alien_w = (1.5 * alien->torusOuterRadius) + (3.5 * alien->torusInnerRadius);
-	float alien_h = 1.5 * alien->sphereRadius;
 	// See how close the missle is to the alien
-	if ((abs(missle->positionVector[X_] - alien->positionVector[X_]) <= ((alien_w) / 2)) &&
-		(abs(missle->positionVector[Y_] - alien->positionVector[Y_]) <= ((alien_h) / 2)))
+	if ((abs(shots->motion->posX[missle] - alien->collider.center[X_]) <= alien->shotBox[X_]) &&
+		(abs(shots->motion->posY[missle] - alien->collider.center[Y_]) <= alien->shotBox[Y_]))
 		return true;
 	else return false;
 }
@@ -136,70 +257,141 @@ bool detectCollideAlienShot(Alien* alien, Missle* missle)
  */
 bool detectCollideAlienPlayer(Alien* alien, PlayerShip* ship)
 {
-	// Calculate the aliens adjusted height and width.
-	float alien_w = ((1.7 * alien->torusOuterRadius) + (3.6 * alien->torusInnerRadius)) / 2;
-	float alien_h = (1.6 * alien->sphereRadius) / 2;
-
-	// Calculate the co-ordinates for the player's three points
-	float xtemp = (ship->scale[X_] * spaceShip[0][X_]);
-	float ytemp = (ship->scale[Z_] * spaceShip[0][Z_]);
-
-	float x1 = ship->positionVector[X_] + ytemp;
-	float y1 = ship->positionVector[Y_] - xtemp;
-
-	xtemp = (ship->scale[X_] * spaceShip[1][X_]);
-	ytemp = (ship->scale[Z_] * spaceShip[1][Z_]);
-
-	float x2 = ship->positionVector[X_] + ytemp;
-	float y2 = ship->positionVector[Y_] - xtemp;
-
-	xtemp = (ship->scale[X_] * spaceShip[2][X_]);
-	ytemp = (ship->scale[Z_] * spaceShip[2][Z_]);
-
-	float x3 = ship->positionVector[X_] + ytemp;
-	float y3 = ship->positionVector[Y_] - xtemp;
+	float alien_w = alien->playerBox[X_];
+	float alien_h = alien->playerBox[Y_];
+	float ax = alien->collider.center[X_];
+	float ay = alien->collider.center[Y_];
 
 	// Check if any of the 3 points collide with the alien
-	if ((abs(x1 - alien->positionVector[X_]) <= alien_w) &&
-		(abs(y1 - alien->positionVector[Y_]) <= alien_h))
-		return true;
-	else if ((abs(x2 - alien->positionVector[X_]) <= alien_w) &&
-			 (abs(y2 - alien->positionVector[Y_]) <= alien_h))
-		return true;
-	else if ((abs(x3 - alien->positionVector[X_]) <= alien_w) &&
-			 (abs(y3 - alien->positionVector[Y_]) <= alien_h))
-		return true;
-	else return false;
+	for (int k = 0; k < 3; k++){
+		if ((abs(ship->hull[k][X_] - ax) <= alien_w) &&
+			(abs(ship->hull[k][Y_] - ay) <= alien_h))
+			return true;
+	}
+	return false;
 }
 
 /*
 	This function detects if a collision between a given player
 	and missle has occured.
 	@param ship A pointer to the player ship to look at.
-	@param missle A pointer to the missle to look at.
+	@param shots The pool of missles.
+	@param missle The slot of the missle to look at.
 	@return True if a collision has occured.
  */
-bool detectCollidePlayerShot(PlayerShip* ship, Missle* missle)
+bool detectCollidePlayerShot(PlayerShip* ship, ObjectPool* shots, int missle)
 {
-	float xtemp = (ship->scale[X_] * spaceShip[0][X_]);
-	float ytemp = (ship->scale[Z_] * spaceShip[0][Z_]);
+	return checkPointInTriangle(shots->motion->posX[missle], shots->motion->posY[missle],
+		ship->hull[0][X_], ship->hull[0][Y_], ship->hull[1][X_], ship->hull[1][Y_], ship->hull[2][X_], ship->hull[2][Y_]);
+}
 
-	float x1 = ship->positionVector[X_] + ytemp;
-	float y1 = ship->positionVector[Y_] - xtemp;
 
-	xtemp = (ship->scale[X_] * spaceShip[1][X_]);
-	ytemp = (ship->scale[Z_] * spaceShip[1][Z_]);
 
-	float x2 = ship->positionVector[X_] + ytemp;
-	float y2 = ship->positionVector[Y_] - xtemp;
+/* Functions for detecting collisions a block at a time */
 
-	xtemp = (ship->scale[X_] * spaceShip[2][X_]);
-	ytemp = (ship->scale[Z_] * spaceShip[2][Z_]);
 
-	float x3 = ship->positionVector[X_] + ytemp;
-	float y3 = ship->positionVector[Y_] - xtemp;
+/*
+	This function packs live missles into a block for the batch tests, picking up where the last
+	call left off.
+	@param block The block to fill, it is emptied first.
+	@param shots The pool of missles.
+	@param slots The slots of the missles to pack (from a grid query).
+	@param count The number of slots.
+	@param next The first slot to look at.
+	@return Where the next call should pick up, count once every slot has been packed.
+*/
+int gatherShots(TargetBlock* block, ObjectPool* shots, const int* slots, int count, int next)
+{
+	int n = 0;
+	for (; (next < count) && (n < BATCH_MAX); next++){
+		int j = slots[next];
+		// Skip missles that hit something earlier this tick
+		if (!shots->live[j])
+			continue;
+		block->x[n] = shots->motion->posX[j];
+		block->y[n] = shots->motion->posY[j];
+		block->slot[n] = j;
+		n++;
+	}
+	block->count = n;
+	return next;
+}
 
-	return checkPointInTriangle(missle->positionVector[X_], missle->positionVector[Y_], x1, y1, x2, y2, x3, y3);
+/*
+	This function packs live aliens into a block for the batch tests, picking up where the last
+	call left off. Each alien is packed as its box against asteroids.
+	@param block The block to fill, it is emptied first.
+	@param aliens The pool of aliens.
+	@param slots The slots of the aliens to pack (from a grid query).
+	@param count The number of slots.
+	@param next The first slot to look at.
+	@return Where the next call should pick up, count once every slot has been packed.
+*/
+int gatherAliens(TargetBlock* block, ObjectPool* aliens, const int* slots, int count, int next)
+{
+	int n = 0;
+	for (; (next < count) && (n < BATCH_MAX); next++){
+		Alien* alien = (Alien*)poolSlot(aliens, slots[next]);
+		// Skip aliens that were destroyed earlier this tick
+		if (alien == NULL)
+			continue;
+		block->x[n] = alien->collider.center[X_];
+		block->y[n] = alien->collider.center[Y_];
+		block->w[n] = alien->asteroidBox[X_];
+		block->h[n] = alien->asteroidBox[Y_];
+		block->slot[n] = slots[next];
+		n++;
+	}
+	block->count = n;
+	return next;
+}
+
+/*
+	This function determines which missles in a block hit an Asteroid.
+	@param asteroids The pool of Asteroids.
+	@param asteroid The slot of the Asteroid to look at.
+	@param shots The block of Missles.
+	@return A mask with bit k set if the kth Missle hit.
+*/
+uint32_t detectCollideAsteroidShots(ObjectPool* asteroids, int asteroid, const TargetBlock* shots)
+{
+	const Collider* c = &((Asteroid*)poolSlot(asteroids, asteroid))->collider;
+	return batchPointInCircle(c->radius, c->center[X_], c->center[Y_], shots);
+}
+
+/*
+	This function determines which aliens in a block hit an Asteroid.
+	@param asteroids The pool of Asteroids.
+	@param asteroid The slot of the Asteroid to look at.
+	@param aliens The block of aliens (packed by gatherAliens).
+	@return A mask with bit k set if the kth alien hit.
+*/
+uint32_t detectCollideAsteroidAliens(ObjectPool* asteroids, int asteroid, const TargetBlock* aliens)
+{
+	Asteroid* a = (Asteroid*)poolSlot(asteroids, asteroid);
+	return batchBoxInBox(a->collider.center[X_], a->collider.center[Y_], a->alienBox[X_], a->alienBox[Y_], aliens);
+}
+
+/*
+	This function determines which missles in a block hit an alien.
+	@param alien A pointer to the alien to look at.
+	@param shots The block of missles.
+	@return A mask with bit k set if the kth missle hit.
+*/
+uint32_t detectCollideAlienShots(Alien* alien, const TargetBlock* shots)
+{
+	return batchPointInBox(alien->collider.center[X_], alien->collider.center[Y_], alien->shotBox[X_], alien->shotBox[Y_], shots);
+}
+
+/*
+	This function determines which missles in a block hit the player.
+	@param ship A pointer to the player ship to look at.
+	@param shots The block of missles.
+	@return A mask with bit k set if the kth missle hit.
+*/
+uint32_t detectCollidePlayerShots(PlayerShip* ship, const TargetBlock* shots)
+{
+	return batchPointInTriangle(ship->hull, shots);
 }
 
 
@@ -211,130 +403,134 @@ bool detectCollidePlayerShot(PlayerShip* ship, Missle* missle)
 /*
 	This function is responsible for handling what happens when a collision happens
 	between an Asteroid and a Missle.
-	@param asteroidList The list of Asteroids.
-	@param asteroid The Asteroid that collided.
-	@param shots The list of Missles.
-	@param shot The Missle that collided.
-	@param eList The list of explosions.
+	@param asteroidList The pool of Asteroids.
+	@param asteroid The slot of the Asteroid that collided.
+	@param shots The pool of Missles.
+	@param shot The slot of the Missle that collided.
+	@param eList The pool of explosions.
 */
-void handleCollideAsteroidShot(ObjectList* asteroidList, Asteroid* asteroid, ObjectList* shots, Missle* shot, ObjectList* eList)
+void handleCollideAsteroidShot(ObjectPool* asteroidList, int asteroid, ObjectPool* shots, int shot, ObjectPool* eList)
 {
+	// Trace the response
+	TRACE_SCOPE("handleCollideAsteroidShot");
 	// Explosion
-	Explosion* newExp = makeExplosion(asteroid->positionVector[X_], asteroid->positionVector[Y_], asteroid->positionVector[Z_]);
-	addToList(newExp, eList);
+	makeExplosion(asteroidList->motion->posX[asteroid], asteroidList->motion->posY[asteroid], Z_LEVEL, eList);
 	// Split or remove asteroid
-	splitOrRemove(asteroidList, asteroid, shot);
+	Missle* m = (Missle*)poolSlot(shots, shot);
+	splitOrRemove(asteroidList, asteroid, m);
 	// Remove shot
-	if (removeFromList(shot, shots))
-		free(shot);
+	poolRemove(m, shots);
 }
 
 /*
 	This function is responsible for handling what happens when a collision happens
 	between an Asteroid and a player.
-	@param asteroidList The list of Asteroids.
-	@param asteroid The Asteroid that collided.
+	@param asteroidList The pool of Asteroids.
+	@param asteroid The slot of the Asteroid that collided.
 	@param ship The player that collided.
-	@param eList The list of explosions.
+	@param eList The pool of explosions.
 */
-void handleCollideAsteroidShip(ObjectList* asteroidList, Asteroid* asteroid, PlayerShip* ship, ObjectList* eList)
+void handleCollideAsteroidShip(ObjectPool* asteroidList, int asteroid, PlayerShip* ship, ObjectPool* eList)
 {
+	// Trace the response
+	TRACE_SCOPE("handleCollideAsteroidShip");
 	// Explosion
-	Explosion* newExp1 = makeExplosion(ship->positionVector[X_], ship->positionVector[Y_], ship->positionVector[Z_]);
-	addToList(newExp1, eList);
-	Explosion* newExp2 = makeExplosion(asteroid->positionVector[X_], asteroid->positionVector[Y_], asteroid->positionVector[Z_]);
-	addToList(newExp2, eList);
+	makeExplosion(ship->positionVector[X_], ship->positionVector[Y_], ship->positionVector[Z_], eList);
+	makeExplosion(asteroidList->motion->posX[asteroid], asteroidList->motion->posY[asteroid], Z_LEVEL, eList);
 	// Split or remove asteroid
 	splitOrRemove(asteroidList, asteroid, NULL);
 	// Reset player
 	ship->positionVector[X_] = PLAYER_INIT_POSX;
 	ship->positionVector[Y_] = PLAYER_INIT_POSY;
 	ship->spin = 0.0f;
+	// The player moved, so later tests this tick must see it where it is now
+	updateShipCollider(ship);
 }
 
 /*
 	This function handles reponding to a collision between an asteroid and
 	an alien ship.
-	@param asteroidList The list of asteroid the asteroid is apart of.
-	@param asteroid A pointer to the asteroid that collided.
-	@param alienList The list of alien ships the alien is apart of.
+	@param asteroidList The pool of asteroids the asteroid is apart of.
+	@param asteroid The slot of the asteroid that collided.
+	@param alienList The pool of alien ships the alien is apart of.
 	@param alien A pointer to the alien that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param eList The pool of explosions to add new explosions to.
  */
-void handleCollideAsteroidAlien(ObjectList* asteroidList, Asteroid* asteroid, ObjectList* alienList, Alien* alien, ObjectList* eList)
+void handleCollideAsteroidAlien(ObjectPool* asteroidList, int asteroid, ObjectPool* alienList, Alien* alien, ObjectPool* eList)
 {
+	// Trace the response
+	TRACE_SCOPE("handleCollideAsteroidAlien");
 	// Explosion
-	Explosion* newExp1 = makeExplosion(alien->positionVector[X_], alien->positionVector[Y_], alien->positionVector[Z_]);
-	addToList(newExp1, eList);
-	Explosion* newExp2 = makeExplosion(asteroid->positionVector[X_], asteroid->positionVector[Y_], asteroid->positionVector[Z_]);
-	addToList(newExp2, eList);
+	makeExplosion(alien->positionVector[X_], alien->positionVector[Y_], alien->positionVector[Z_], eList);
+	makeExplosion(asteroidList->motion->posX[asteroid], asteroidList->motion->posY[asteroid], Z_LEVEL, eList);
 	// Split or remove asteroid
 	splitOrRemove(asteroidList, asteroid, NULL);
-	if (removeFromList(alien, alienList))
-		free(alien);
+	poolRemove(alien, alienList);
 }
 
 /*
 	This function responds to a collision between an alien and a missle.
-	@param alienList The list of alien ships the alien is apart of.
+	@param alienList The pool of alien ships the alien is apart of.
 	@param alien A pointer to the alien that collided.
-	@param shots The list of missles the missle belongs to.
-	@param missle A pointer to the missle that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param shots The pool of missles the missle belongs to.
+	@param missle The slot of the missle that collided.
+	@param eList The pool of explosions to add new explosions to.
  */
-void handleCollideAlienShot(ObjectList* alienList, Alien* alien, ObjectList* shots, Missle* missle, ObjectList* eList)
+void handleCollideAlienShot(ObjectPool* alienList, Alien* alien, ObjectPool* shots, int missle, ObjectPool* eList)
 {
+	// Trace the response
+	TRACE_SCOPE("handleCollideAlienShot");
 	// Explosion
-	Explosion* newExp1 = makeExplosion(alien->positionVector[X_], alien->positionVector[Y_], alien->positionVector[Z_]);
-	addToList(newExp1, eList);
+	makeExplosion(alien->positionVector[X_], alien->positionVector[Y_], alien->positionVector[Z_], eList);
 	// Remove alien and missle
-	if (removeFromList(missle, shots))
-		free(missle);
-	if (removeFromList(alien, alienList))
-		free(alien);
+	poolRemove(poolSlot(shots, missle), shots);
+	poolRemove(alien, alienList);
 }
 
 /*
 	This function responds to a collision between an alien and a player.
-	@param alienList The list of alien ships the alien is apart of.
+	@param alienList The pool of alien ships the alien is apart of.
 	@param alien A pointer to the alien that collided.
 	@param ship The player that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param eList The pool of explosions to add new explosions to.
 */
-void handleCollideAlienPlayer(ObjectList* alienList, Alien* alien, PlayerShip* ship, ObjectList* eList)
+void handleCollideAlienPlayer(ObjectPool* alienList, Alien* alien, PlayerShip* ship, ObjectPool* eList)
 {
+	// Trace the response
+	TRACE_SCOPE("handleCollideAlienPlayer");
 	// Explosions
-	Explosion* newExp1 = makeExplosion(alien->positionVector[X_], alien->positionVector[Y_], alien->positionVector[Z_]);
-	addToList(newExp1, eList);
-	Explosion* newExp2 = makeExplosion(ship->positionVector[X_], ship->positionVector[Y_], ship->positionVector[Z_]);
-	addToList(newExp2, eList);
-	if (removeFromList(alien, alienList))
-		free(alien);
+	makeExplosion(alien->positionVector[X_], alien->positionVector[Y_], alien->positionVector[Z_], eList);
+	makeExplosion(ship->positionVector[X_], ship->positionVector[Y_], ship->positionVector[Z_], eList);
+	poolRemove(alien, alienList);
 	// Reset player
 	ship->positionVector[X_] = PLAYER_INIT_POSX;
 	ship->positionVector[Y_] = PLAYER_INIT_POSY;
 	ship->spin = 0.0f;
+	// The player moved, so later tests this tick must see it where it is now
+	updateShipCollider(ship);
 }
 
 
 /*
 	This function responds to a collision between an player and a missle.
 	@param ship The player that collided.
-	@param shots The list of missles the missle belongs to.
-	@param missle A pointer to the missle that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param shots The pool of missles the missle belongs to.
+	@param missle The slot of the missle that collided.
+	@param eList The pool of explosions to add new explosions to.
 */
-void handleCollidePlayerShot(PlayerShip* ship, ObjectList* shots, Missle* missle, ObjectList* eList)
+void handleCollidePlayerShot(PlayerShip* ship, ObjectPool* shots, int missle, ObjectPool* eList)
 {
+	// Trace the response
+	TRACE_SCOPE("handleCollidePlayerShot");
 	// Make an explosion
-	Explosion* newExp1 = makeExplosion(ship->positionVector[X_], ship->positionVector[Y_], ship->positionVector[Z_]);
-	addToList(newExp1, eList);
-	if (removeFromList(missle, shots))
-		free(missle);
+	makeExplosion(ship->positionVector[X_], ship->positionVector[Y_], ship->positionVector[Z_], eList);
+	poolRemove(poolSlot(shots, missle), shots);
 	// Reset player
 	ship->positionVector[X_] = PLAYER_INIT_POSX;
 	ship->positionVector[Y_] = PLAYER_INIT_POSY;
 	ship->spin = 0.0f;
+	// The player moved, so later tests this tick must see it where it is now
+	updateShipCollider(ship);
 }
 
 
@@ -463,31 +659,38 @@ static bool checkPointInTriangle(float ptx, float pty, float v1x, float v1y, flo
 
 /*
 	This function handles splitting an asteroid or removing it.
-	@param list The list of asteroid the asteroid is apart of.
-	@param asteroid The asteroid that we are working on.
+	@param list The pool of asteroids the asteroid is apart of.
+	@param asteroid The slot of the asteroid that we are working on.
 	@param shot The missle that hit the asteroid.
  */
-static void splitOrRemove(ObjectList* list, Asteroid* asteroid, Missle* shot)
+static void splitOrRemove(ObjectPool* list, int asteroid, Missle* shot)
 {
+	// Time the split on its own, it nests inside the handler that called it
+	TRACE_SCOPE("splitOrRemove");
+	Asteroid* a = (Asteroid*)poolSlot(list, asteroid);
+	MotionStore* motion = list->motion;
 	// Check how many times the asteroid has been split
-	if (asteroid->age == 0){
-		if (removeFromList(asteroid, list))
-			free(asteroid);
-	}
+	if (a->age == 0)
+		poolRemove(a, list);
 	else {
 		// Make the asteroid smaller
 		for (int i = 0; i < 3; i++)
-			asteroid->scale[i] = asteroid->scale[i] / 1.7f;
+			a->scale[i] = a->scale[i] / 1.7f;
 		// Decrement the age
-		asteroid->age--;
+		a->age--;
 
-		// Make a clone of the asteroid
-		Asteroid* newAsteroid = (Asteroid*)malloc(sizeof(Asteroid));
-		memcpy(newAsteroid, asteroid, sizeof(Asteroid));
+		// Make a clone of the asteroid (if the pool is full the asteroid just shrinks)
+		Asteroid* newAsteroid = (Asteroid*)poolAdd(list);
+		int clone = -1;
+		if (newAsteroid != NULL){
+			memcpy(newAsteroid, a, sizeof(Asteroid));
+			clone = poolIndexOf(newAsteroid, list);
+			copyMotionSlot(motion, clone, asteroid);
+		}
 
 		// Remember the asteroid's original velocity
 		float theta = 0.0f;
-		GLfloat oldV[] = { asteroid->vVector[X_], asteroid->vVector[Y_] };
+		float oldV[] = { motion->velX[asteroid], motion->velY[asteroid] };
 		float vMag = sqrt((oldV[Y_] * oldV[Y_]) + (oldV[X_] * oldV[X_]));
 
 		// If we were hit by a shot, adjust our direction
@@ -497,12 +700,16 @@ static void splitOrRemove(ObjectList* list, Asteroid* asteroid, Missle* shot)
 			theta = atan(shot->directionVector[X_] / shot->directionVector[Y_]) * (180 / 3.1415);
 
 		// Adjust direction for both asteroids so they fly away from each other
-		asteroid->vVector[X_] = vMag * cos(theta + COLLISION_PHI);
-		asteroid->vVector[Y_] = vMag * sin(theta + COLLISION_PHI);
-		newAsteroid->vVector[X_] = vMag * cos(theta - COLLISION_PHI);
-		newAsteroid->vVector[Y_] = vMag * sin(theta - COLLISION_PHI);
-
-		// Add the new asteroid to the list
-		addToList(newAsteroid, list);
+		motion->velX[asteroid] = vMag * cos(theta + COLLISION_PHI);
+		motion->velY[asteroid] = vMag * sin(theta + COLLISION_PHI);
+		if (clone >= 0){
+			motion->velX[clone] = vMag * cos(theta - COLLISION_PHI);
+			motion->velY[clone] = vMag * sin(theta - COLLISION_PHI);
+		}
+
+		// Both halves shrank, so later tests this tick must see their new size
+		updateAsteroidCollider(list, asteroid);
+		if (clone >= 0)
+			updateAsteroidCollider(list, clone);
 	}
 }
@@ -3,6 +3,7 @@
 
 #include "objects.h"
 #include "datastructures.h"
+#include "batch.h"
 
 /*
 	@file smack.h
@@ -12,37 +13,108 @@
 */
 
 
+// How far the player's hull can reach from its center in X or Y
+#define PLAYER_REACH (1.35f * PLAYER_SIZE)
+// How far the biggest alien's collision box can reach from its center in X and in Y
+#define ALIEN_REACH_X (((1.7f * ALIEN_LARGE_TOR_OUT_R) + (3.6f * ALIEN_LARGE_TOR_IN_R)) / 2)
+#define ALIEN_REACH_Y ((1.6f * ALIEN_LARGE_SPH_R) / 2)
+// How far an asteroid's collision box reaches past its radius when checked against an alien
+#define ASTEROID_ALIEN_REACH 0.95f
+
+
+/*
+	This function works out where the player's ship can be hit, its hull in world space and
+	the circle and box around it.
+	@param ship The player ship to update.
+*/
+void updateShipCollider(PlayerShip* ship);
+
+/*
+	This function works out where an alien can be hit, its boxes against each kind of object
+	and the circle and box around all of them.
+	@param alien The alien to update.
+*/
+void updateAlienCollider(Alien* alien);
+
+/*
+	This function works out where an asteroid can be hit, its circle, its box against aliens,
+	and the box around it.
+	@param asteroids The pool of asteroids.
+	@param asteroid The slot of the asteroid to update.
+*/
+void updateAsteroidCollider(ObjectPool* asteroids, int asteroid);
+
+/*
+	This function rebuilds the colliders of the player, every asteroid, and every alien.
+	It runs once a tick after everything has moved, every detectCollide function reads from
+	what it stores (missles are points, so they are read straight from their motion store).
+	@param ship The player ship.
+	@param asteroids The pool of asteroids.
+	@param aliens The pool of aliens.
+*/
+void updateColliders(PlayerShip* ship, ObjectPool* asteroids, ObjectPool* aliens);
+
+/*
+	This function packs live missles into a block for the batch tests, picking up where the last
+	call left off.
+	@param block The block to fill, it is emptied first.
+	@param shots The pool of missles.
+	@param slots The slots of the missles to pack (from a grid query).
+	@param count The number of slots.
+	@param next The first slot to look at.
+	@return Where the next call should pick up, count once every slot has been packed.
+*/
+int gatherShots(TargetBlock* block, ObjectPool* shots, const int* slots, int count, int next);
+
+/*
+	This function packs live aliens into a block for the batch tests, picking up where the last
+	call left off. Each alien is packed as its box against asteroids.
+	@param block The block to fill, it is emptied first.
+	@param aliens The pool of aliens.
+	@param slots The slots of the aliens to pack (from a grid query).
+	@param count The number of slots.
+	@param next The first slot to look at.
+	@return Where the next call should pick up, count once every slot has been packed.
+*/
+int gatherAliens(TargetBlock* block, ObjectPool* aliens, const int* slots, int count, int next);
+
+
 /*
 	This function determines if an Asteroid and a Missle collided.
-	@param asteroid The Asteroid to look at.
-	@param shot The Missle to look at.
+	@param asteroids The pool of Asteroids.
+	@param asteroid The slot of the Asteroid to look at.
+	@param shots The pool of Missles.
+	@param shot The slot of the Missle to look at.
 	@return True if a collision occured false otherwise.
 */
-bool detectCollideAsteroidShot(Asteroid* asteroid, Missle* shot);
+bool detectCollideAsteroidShot(ObjectPool* asteroids, int asteroid, ObjectPool* shots, int shot);
 
 /*
 	This function determines if an Asteroid and a player collided.
-	@param asteroid The Asteroid to look at.
+	@param asteroids The pool of Asteroids.
+	@param asteroid The slot of the Asteroid to look at.
 	@param ship The player to look at.
 	@return True if a collision occured false otherwise.
 */
-bool detectCollideAsteroidShip(Asteroid* asteroid, PlayerShip* ship);
+bool detectCollideAsteroidShip(ObjectPool* asteroids, int asteroid, PlayerShip* ship);
 
 /*
 	This function checks if a given asteroid and alien are colliding.
-	@param asteroid A pointer to the asteroid to look at.
+	@param asteroids The pool of asteroids.
+	@param asteroid The slot of the asteroid to look at.
 	@param alien A pointer to the alien ship to look att.
 	@return True if the asteroid and the alien are colliding, false otherwise.
 */
-bool detectCollideAsteroidAlien(Asteroid* asteroid, Alien* alien);
+bool detectCollideAsteroidAlien(ObjectPool* asteroids, int asteroid, Alien* alien);
 
 /*
 	This function detects if a collision has occured between a given alien and missle.
 	@param alien A pointer to the alien to look at.
-	@param missle A pointer to the missle to look at.
+	@param shots The pool of missles.
+	@param missle The slot of the missle to look at.
 	@return True if the given alien and missle are colliding.
 */
-bool detectCollideAlienShot(Alien* alien, Missle* missle);
+bool detectCollideAlienShot(Alien* alien, ObjectPool* shots, int missle);
 
 /*
 	This function checks if a given alien ship and player ship are colliding.
@@ -56,69 +128,80 @@ bool detectCollideAlienPlayer(Alien* alien, PlayerShip* ship);
 	This function detects if a collision between a given player
 	and missle has occured.
 	@param ship A pointer to the player ship to look at.
-	@param missle A pointer to the missle to look at.
+	@param shots The pool of missles.
+	@param missle The slot of the missle to look at.
 	@return True if a collision has occured.
 */
-bool detectCollidePlayerShot(PlayerShip* ship, Missle* missle);
+bool detectCollidePlayerShot(PlayerShip* ship, ObjectPool* shots, int missle);
 
 /*
 	This function is responsible for handling what happens when a collision happens
 	between an Asteroid and a Missle.
-	@param asteroidList The list of Asteroids.
-	@param asteroid The Asteroid that collided.
-	@param shots The list of Missles.
-	@param shot The Missle that collided.
-	@param eList The list of explosions.
+	@param asteroidList The pool of Asteroids.
+	@param asteroid The slot of the Asteroid that collided.
+	@param shots The pool of Missles.
+	@param shot The slot of the Missle that collided.
+	@param eList The pool of explosions.
 */
-void handleCollideAsteroidShot(ObjectList* asteroidList, Asteroid* asteroid, ObjectList* shots, Missle* shot, ObjectList* eList);
+void handleCollideAsteroidShot(ObjectPool* asteroidList, int asteroid, ObjectPool* shots, int shot, ObjectPool* eList);
 
 /*
 	This function is responsible for handling what happens when a collision happens
 	between an Asteroid and a player.
-	@param asteroidList The list of Asteroids.
-	@param asteroid The Asteroid that collided.
+	@param asteroidList The pool of Asteroids.
+	@param asteroid The slot of the Asteroid that collided.
 	@param ship The player that collided.
-	@param eList The list of explosions.
+	@param eList The pool of explosions.
 */
-void handleCollideAsteroidShip(ObjectList* asteroidList, Asteroid* asteroid, PlayerShip* ship, ObjectList* eList);
+void handleCollideAsteroidShip(ObjectPool* asteroidList, int asteroid, PlayerShip* ship, ObjectPool* eList);
 
 /*
 	This function handles reponding to a collision between an asteroid and
 	an alien ship.
-	@param asteroidList The list of asteroid the asteroid is apart of.
-	@param asteroid A pointer to the asteroid that collided.
-	@param alienList The list of alien ships the alien is apart of.
+	@param asteroidList The pool of asteroids the asteroid is apart of.
+	@param asteroid The slot of the asteroid that collided.
+	@param alienList The pool of alien ships the alien is apart of.
 	@param alien A pointer to the alien that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param eList The pool of explosions to add new explosions to.
 */
-void handleCollideAsteroidAlien(ObjectList* asteroidList, Asteroid* asteroid, ObjectList* alienList, Alien* alien, ObjectList* eList);
+void handleCollideAsteroidAlien(ObjectPool* asteroidList, int asteroid, ObjectPool* alienList, Alien* alien, ObjectPool* eList);
 
 /*
 	This function responds to a collision between an alien and a missle.
-	@param alienList The list of alien ships the alien is apart of.
+	@param alienList The pool of alien ships the alien is apart of.
 	@param alien A pointer to the alien that collided.
-	@param shots The list of missles the missle belongs to.
-	@param missle A pointer to the missle that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param shots The pool of missles the missle belongs to.
+	@param missle The slot of the missle that collided.
+	@param eList The pool of explosions to add new explosions to.
 */
-void handleCollideAlienShot(ObjectList* alienList, Alien* alien, ObjectList* shots, Missle* missle, ObjectList* eList);
+void handleCollideAlienShot(ObjectPool* alienList, Alien* alien, ObjectPool* shots, int missle, ObjectPool* eList);
 
 /*
 	This function responds to a collision between an alien and a player.
-	@param alienList The list of alien ships the alien is apart of.
+	@param alienList The pool of alien ships the alien is apart of.
 	@param alien A pointer to the alien that collided.
 	@param ship The player that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param eList The pool of explosions to add new explosions to.
 */
-void handleCollideAlienPlayer(ObjectList* alienList, Alien* alien, PlayerShip* ship, ObjectList* eList);
+void handleCollideAlienPlayer(ObjectPool* alienList, Alien* alien, PlayerShip* ship, ObjectPool* eList);
 
 /*
 	This function responds to a collision between an player and a missle.
 	@param ship The player that collided.
-	@param shots The list of missles the missle belongs to.
-	@param missle A pointer to the missle that collided.
-	@param eList The list of explosions to add new explosions to.
+	@param shots The pool of missles the missle belongs to.
+	@param missle The slot of the missle that collided.
+	@param eList The pool of explosions to add new explosions to.
+*/
+void handleCollidePlayerShot(PlayerShip* ship, ObjectPool* shots, int missle, ObjectPool* eList);
+
+/*
+	These functions are the detectCollide functions above for a whole block of missles or aliens
+	(packed by gatherShots or gatherAliens). Bit k of the mask they give back is what the
+	single test would say about the kth object in the block.
 */
-void handleCollidePlayerShot(PlayerShip* ship, ObjectList* shots, Missle* missle, ObjectList* eList);
+uint32_t detectCollideAsteroidShots(ObjectPool* asteroids, int asteroid, const TargetBlock* shots);
+uint32_t detectCollideAsteroidAliens(ObjectPool* asteroids, int asteroid, const TargetBlock* aliens);
+uint32_t detectCollideAlienShots(Alien* alien, const TargetBlock* shots);
+uint32_t detectCollidePlayerShots(PlayerShip* ship, const TargetBlock* shots);
 
 #endif
@@ -0,0 +1,207 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+#include "text.h"
+#include "render.h"
+
+/*
+	@file text.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the text renderer. The font (see font.h) is unpacked into the atlas
+	once, then strings are turned into quads on the CPU (six corners a glyph) and streamed into
+	one buffer that is drawn once at the end of the frame.
+ */
+
+/*
+	This function creates a text renderer, building the atlas and making room for the glyphs.
+	loadGLFunctions must have been called first.
+	@param maxGlyphs The most glyphs that can be drawn in one frame, any more are dropped.
+	@return A pointer to the text renderer.
+*/
+TextRenderer* createTextRenderer(int maxGlyphs)
+{
+	TextRenderer* text = (TextRenderer*)calloc(1, sizeof(TextRenderer));
+	text->capacity = maxGlyphs;
+	text->verts = (TextVertex*)malloc(maxGlyphs * 6 * sizeof(TextVertex));
+
+	// Unpack every glyph into its cell of the atlas, one byte a pixel, top row first
+	int width = ATLAS_COLUMNS * GLYPH_WIDTH;
+	int height = ATLAS_ROWS * GLYPH_HEIGHT;
+	unsigned char* pixels = (unsigned char*)calloc(width * height, 1);
+	for (int glyph = 0; glyph < NUM_GLYPHS; glyph++){
+		int cellX = (glyph % ATLAS_COLUMNS) * GLYPH_WIDTH;
+		int cellY = (glyph / ATLAS_COLUMNS) * GLYPH_HEIGHT;
+		for (int row = 0; row < GLYPH_HEIGHT; row++)
+			for (int col = 0; col < GLYPH_WIDTH; col++)
+				if (fontGlyphs[glyph][row] & (0x80 >> col))
+					pixels[(cellY + row) * width + cellX + col] = 255;
+	}
+
+	// Send it up, sampled exactly so every glyph pixel lands on a screen pixel
+	glGenTextures(1, &text->atlas);
+	glBindTexture(GL_TEXTURE_2D, text->atlas);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA8, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	free(pixels);
+
+	// Make room on the GPU for a full frame of glyphs
+	glGenBuffers(1, &text->buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, text->buffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)maxGlyphs * 6 * sizeof(TextVertex), NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return text;
+}
+
+/*
+	This function frees a text renderer and everything it keeps on the GPU.
+	@param text A pointer to the text renderer to destroy.
+*/
+void destroyTextRenderer(TextRenderer* text)
+{
+	if (text == NULL)
+		return;
+	glDeleteTextures(1, &text->atlas);
+	glDeleteBuffers(1, &text->buffer);
+	free(text->verts);
+	free(text);
+}
+
+/*
+	This function starts a frame of text. The modelview and projection matrices and the viewport
+	are saved here, so every anchor given to addText goes through the same camera.
+	@param text A pointer to the text renderer.
+*/
+void beginText(TextRenderer* text)
+{
+	text->count = 0;
+	glGetDoublev(GL_MODELVIEW_MATRIX, text->modelview);
+	glGetDoublev(GL_PROJECTION_MATRIX, text->projection);
+	glGetIntegerv(GL_VIEWPORT, text->viewport);
+}
+
+/*
+	This is a helper function that sets one corner of a glyph's quad.
+	@param vert The corner to set.
+	@param x The x co-ordinate of the corner in window pixels.
+	@param y The y co-ordinate of the corner in window pixels.
+	@param u The u co-ordinate of the corner in the atlas.
+	@param v The v co-ordinate of the corner in the atlas.
+	@param color The color of the text.
+*/
+static void setCorner(TextVertex* vert, float x, float y, float u, float v, const unsigned char color[4])
+{
+	vert->pos[0] = x;
+	vert->pos[1] = y;
+	vert->uv[0] = u;
+	vert->uv[1] = v;
+	memcpy(vert->color, color, sizeof(vert->color));
+}
+
+/*
+	This function queues a string to be drawn at the end of the frame.
+	@param text A pointer to the text renderer.
+	@param x The x co-ordinate of where the string starts (its baseline on the left).
+	@param y The y co-ordinate of where the string starts.
+	@param z The z co-ordinate of where the string starts.
+	@param string The string to draw.
+	@param scale How many pixels wide and tall each pixel of the font is drawn.
+	@param color The color to draw the string in.
+*/
+void addText(TextRenderer* text, float x, float y, float z, const char* string, int scale, const unsigned char color[4])
+{
+	// Find the anchor on the screen, snapped to a pixel the way a raster position is
+	double winX, winY, winZ;
+	gluProject(x, y, z, text->modelview, text->projection, text->viewport, &winX, &winY, &winZ);
+	float penX = floorf((float)winX);
+	float bottom = floorf((float)winY) - GLYPH_DESCENT * scale;
+	float top = bottom + GLYPH_HEIGHT * scale;
+
+	for (const char* c = string; *c != '\0'; c++, penX += GLYPH_WIDTH * scale){
+		// Spaces take up room but need no quad
+		int glyph = ((*c >= FIRST_GLYPH) && (*c <= LAST_GLYPH)) ? *c - FIRST_GLYPH : 0;
+		if (glyph == 0)
+			continue;
+		// Drop whatever does not fit this frame
+		if (text->count >= text->capacity)
+			return;
+
+		// Find the glyph's cell in the atlas
+		float u0 = (float)(glyph % ATLAS_COLUMNS) / ATLAS_COLUMNS;
+		float u1 = u0 + 1.0f / ATLAS_COLUMNS;
+		float v0 = (float)(glyph / ATLAS_COLUMNS) / ATLAS_ROWS;
+		float v1 = v0 + 1.0f / ATLAS_ROWS;
+		float right = penX + GLYPH_WIDTH * scale;
+
+		// Two triangles, the atlas is stored top row first
+		TextVertex* vert = &text->verts[text->count * 6];
+		setCorner(&vert[0], penX, bottom, u0, v1, color);
+		setCorner(&vert[1], right, bottom, u1, v1, color);
+		setCorner(&vert[2], right, top, u1, v0, color);
+		setCorner(&vert[3], penX, bottom, u0, v1, color);
+		setCorner(&vert[4], right, top, u1, v0, color);
+		setCorner(&vert[5], penX, top, u0, v0, color);
+		text->count++;
+	}
+}
+
+/*
+	This function draws every string queued this frame with one draw call, on top of everything.
+	@param text A pointer to the text renderer.
+*/
+void endText(TextRenderer* text)
+{
+	if (text->count == 0)
+		return;
+
+	// Send the glyphs, the buffer stays bound for the pointers below
+	streamBuffer(GL_ARRAY_BUFFER, text->buffer, (size_t)text->capacity * 6 * sizeof(TextVertex),
+		text->verts, (size_t)text->count * 6 * sizeof(TextVertex));
+
+	// Draw straight in window pixels
+	GLint* view = text->viewport;
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(view[0], view[0] + view[2], view[1], view[1] + view[3], -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	// Only the glyph pixels are drawn, over the top of everything
+	glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_ALPHA_TEST);
+	glAlphaFunc(GL_GREATER, 0.5f);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, text->atlas);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(TextVertex), (const void*)offsetof(TextVertex, pos));
+	glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), (const void*)offsetof(TextVertex, uv));
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), (const void*)offsetof(TextVertex, color));
+	glDrawArrays(GL_TRIANGLES, 0, text->count * 6);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Put everything back the way it was
+	glPopAttrib();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	text->count = 0;
+}
@@ -0,0 +1,85 @@
+#ifndef __TEXT__
+#define __TEXT__
+
+#include "glfuncs.h"
+#include "font.h"
+
+/*
+	@file text.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the text renderer. Every glyph of a fixed width font is packed into
+	one small texture when it is made, then each frame every line of text is queued up as a quad
+	per glyph and the whole lot is drawn at once, so a screen full of overlay costs one draw call.
+	Text is anchored at a point in the world, but is drawn on whole pixels so it stays crisp.
+*/
+
+// The glyphs are packed into the atlas in rows of this many
+#define ATLAS_COLUMNS 16
+#define ATLAS_ROWS ((NUM_GLYPHS + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS)
+
+// A struct holding one corner of a glyph's quad
+typedef struct {
+	// Where the corner is in window pixels
+	float pos[2];
+	// Where the corner is in the atlas
+	float uv[2];
+	// The color of the text
+	unsigned char color[4];
+} TextVertex;
+
+// A struct holding the atlas and the glyphs waiting to be drawn with it
+typedef struct {
+	// The texture holding every glyph
+	GLuint atlas;
+	// The buffer the glyphs are streamed into, and the copy it is filled from
+	GLuint buffer;
+	TextVertex* verts;
+	// How many glyphs are waiting, and how many fit
+	int count;
+	int capacity;
+	// The camera and window the text is anchored with, saved by beginText
+	double modelview[16];
+	double projection[16];
+	GLint viewport[4];
+} TextRenderer;
+
+/*
+	This function creates a text renderer, building the atlas and making room for the glyphs.
+	loadGLFunctions must have been called first.
+	@param maxGlyphs The most glyphs that can be drawn in one frame, any more are dropped.
+	@return A pointer to the text renderer.
+ */
+TextRenderer* createTextRenderer(int maxGlyphs);
+
+/*
+	This function frees a text renderer and everything it keeps on the GPU.
+	@param text A pointer to the text renderer to destroy.
+ */
+void destroyTextRenderer(TextRenderer* text);
+
+/*
+	This function starts a frame of text. The modelview and projection matrices and the viewport
+	are saved here, so every anchor given to addText goes through the same camera.
+	@param text A pointer to the text renderer.
+ */
+void beginText(TextRenderer* text);
+
+/*
+	This function queues a string to be drawn at the end of the frame.
+	@param text A pointer to the text renderer.
+	@param x The x co-ordinate of where the string starts (its baseline on the left).
+	@param y The y co-ordinate of where the string starts.
+	@param z The z co-ordinate of where the string starts.
+	@param string The string to draw.
+	@param scale How many pixels wide and tall each pixel of the font is drawn.
+	@param color The color to draw the string in.
+ */
+void addText(TextRenderer* text, float x, float y, float z, const char* string, int scale, const unsigned char color[4]);
+
+/*
+	This function draws every string queued this frame with one draw call, on top of everything.
+	@param text A pointer to the text renderer.
+ */
+void endText(TextRenderer* text);
+
+#endif
@@ -0,0 +1,315 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "profiler.h"
+#include "trace.h"
+
+/*
+	@file trace.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the tracer. Each thread owns a ring of events that only it writes to and
+	only the background thread reads from, so recording never takes a lock. A thread grabs a ring
+	the first time it records and hands it back when it exits, so short lived threads do not use
+	them all up.
+ */
+
+// A single finished event
+typedef struct {
+	// The name of the event
+	const char* name;
+	// When it started and ended in nanoseconds
+	int64_t start;
+	int64_t end;
+} TraceEventRecord;
+
+// A ring of events recorded by one thread
+typedef struct {
+	// The events, the recording thread writes at head and the background thread reads at tail
+	TraceEventRecord events[TRACE_BUFFER_EVENTS];
+	std::atomic<uint64_t> head;
+	std::atomic<uint64_t> tail;
+	// The id of the thread in the trace
+	std::atomic<int> tid;
+	// The name of the thread in the trace, or NULL if it has none
+	std::atomic<const char*> name;
+	// The name last written to the trace file and the id it was written for (a reused ring gets
+	// a new id, and the new thread may well have the same name), only the writer touches them
+	const char* writtenName;
+	int writtenTid;
+	// Whether a thread is using this ring
+	std::atomic<bool> owned;
+	// The number of events thrown away because the ring was full
+	std::atomic<uint64_t> dropped;
+} TraceBuffer;
+
+// A struct holding everything about the trace being recorded
+typedef struct {
+	// The file being written, or NULL if no trace is running
+	FILE* file;
+	// When the trace started, every timestamp is relative to it
+	int64_t origin;
+	// Whether an event has been written yet (every one after the first needs a comma)
+	bool wroteEvent;
+	// The thread writing the trace
+	std::thread flusher;
+	// Guards starting, stopping, and handing out rings
+	std::mutex lock;
+	// Signalled when the background thread should stop
+	std::condition_variable wake;
+	bool quit;
+	// Every ring that has been handed out, they live as long as the program
+	TraceBuffer* buffers[TRACE_MAX_THREADS];
+	std::atomic<int> numBuffers;
+	// The number of thread ids handed out
+	int nextTid;
+} Tracer;
+
+std::atomic<bool> traceOn(false);
+// The one tracer for the program
+static Tracer tracer;
+
+// A struct that hands a thread's ring back when the thread exits
+struct TraceBufferOwner {
+	TraceBuffer* buffer;
+	~TraceBufferOwner()
+	{
+		if (buffer != NULL)
+			buffer->owned.store(false, std::memory_order_release);
+	}
+};
+// The ring the current thread records into
+static thread_local TraceBufferOwner localBuffer = { NULL };
+// Set once a thread finds there are no rings left, so it stops asking
+static thread_local bool noBufferLeft = false;
+
+/*
+	This function finds the calling thread's ring, grabbing one the first time it is needed.
+	@return A pointer to the ring, or NULL if every ring is in use.
+ */
+static TraceBuffer* threadBuffer()
+{
+	if (localBuffer.buffer != NULL)
+		return localBuffer.buffer;
+	if (noBufferLeft)
+		return NULL;
+
+	std::lock_guard<std::mutex> guard(tracer.lock);
+	TraceBuffer* buffer = NULL;
+	int count = tracer.numBuffers.load(std::memory_order_relaxed);
+	// Reuse a ring a finished thread gave back, once everything in it has been written
+	for (int i = 0; (i < count) && (buffer == NULL); i++){
+		TraceBuffer* b = tracer.buffers[i];
+		if (!b->owned.load(std::memory_order_acquire) && (b->head.load() == b->tail.load()))
+			buffer = b;
+	}
+	// Otherwise make a new one
+	if ((buffer == NULL) && (count < TRACE_MAX_THREADS)){
+		buffer = new TraceBuffer();
+		buffer->head.store(0);
+		buffer->tail.store(0);
+		buffer->dropped.store(0);
+		buffer->writtenName = NULL;
+		buffer->writtenTid = 0;
+		tracer.buffers[count] = buffer;
+		tracer.numBuffers.store(count + 1, std::memory_order_release);
+	}
+	if (buffer == NULL){
+		noBufferLeft = true;
+		return NULL;
+	}
+
+	// Every thread gets a fresh id
+	buffer->tid = ++tracer.nextTid;
+	buffer->name.store(NULL);
+	buffer->owned.store(true);
+	localBuffer.buffer = buffer;
+	return buffer;
+}
+
+/*
+	This function writes one event to the trace file.
+	@param fields The JSON fields of the event, without the braces.
+ */
+static void writeEvent(const char* fields)
+{
+	fprintf(tracer.file, "%s{%s}", tracer.wroteEvent ? ",\n" : "", fields);
+	tracer.wroteEvent = true;
+}
+
+/*
+	This function writes out everything every thread has recorded so far.
+	Only the background thread (or stopTrace once it has left) calls this.
+ */
+static void flushBuffers()
+{
+	char fields[256];
+	int count = tracer.numBuffers.load(std::memory_order_acquire);
+	for (int i = 0; i < count; i++){
+		TraceBuffer* buffer = tracer.buffers[i];
+		// Name the thread the first time we see its name (the name is set after the id, so this id is the named thread's)
+		const char* name = buffer->name.load();
+		int tid = buffer->tid.load();
+		if ((name != NULL) && ((name != buffer->writtenName) || (tid != buffer->writtenTid))){
+			snprintf(fields, sizeof(fields), "\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}", tid, name);
+			writeEvent(fields);
+			buffer->writtenName = name;
+			buffer->writtenTid = tid;
+		}
+
+		// Write every event between what we last read and what was last recorded
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+		for (; tail < head; tail++){
+			TraceEventRecord* e = &buffer->events[tail & (TRACE_BUFFER_EVENTS - 1)];
+			// Chrome wants microseconds
+			snprintf(fields, sizeof(fields), "\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+				e->name, buffer->tid.load(), (e->start - tracer.origin) / 1000.0, (e->end - e->start) / 1000.0);
+			writeEvent(fields);
+		}
+		buffer->tail.store(tail, std::memory_order_release);
+	}
+}
+
+/*
+	This function is run by the background thread, it writes out the rings every so often until told to stop.
+ */
+static void flusherMain()
+{
+	std::unique_lock<std::mutex> guard(tracer.lock);
+	while (!tracer.quit){
+		tracer.wake.wait_for(guard, std::chrono::milliseconds(TRACE_FLUSH_MS));
+		// Do not hold up threads grabbing rings while we write
+		guard.unlock();
+		flushBuffers();
+		guard.lock();
+	}
+}
+
+/*
+	This function starts recording a trace and the thread that writes it to a file.
+	@param path Where to write the trace.
+	@return True if the trace was started, false if the file could not be opened or one is already running.
+*/
+bool startTrace(const char* path)
+{
+	std::lock_guard<std::mutex> guard(tracer.lock);
+	if (tracer.file != NULL)
+		return false;
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return false;
+
+	// Throw away anything recorded after the last trace stopped
+	int count = tracer.numBuffers.load();
+	for (int i = 0; i < count; i++){
+		tracer.buffers[i]->tail.store(tracer.buffers[i]->head.load());
+		tracer.buffers[i]->dropped.store(0);
+		tracer.buffers[i]->writtenName = NULL;
+		tracer.buffers[i]->writtenTid = 0;
+	}
+
+	tracer.file = file;
+	tracer.origin = profileNow();
+	tracer.wroteEvent = false;
+	tracer.quit = false;
+	fprintf(file, "[\n");
+	writeEvent("\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"asteroids\"}");
+
+	// Start writing, then start recording
+	tracer.flusher = std::thread(flusherMain);
+	traceOn.store(true);
+	return true;
+}
+
+/*
+	This function stops recording, writes out everything left, and closes the file.
+	It does nothing if no trace is running.
+	@return The number of events that were dropped because a thread's buffer was full.
+*/
+uint64_t stopTrace()
+{
+	{
+		std::lock_guard<std::mutex> guard(tracer.lock);
+		if (tracer.file == NULL)
+			return 0;
+		// Stop recording, then stop the writer
+		traceOn.store(false);
+		tracer.quit = true;
+	}
+	tracer.wake.notify_one();
+	tracer.flusher.join();
+
+	std::lock_guard<std::mutex> guard(tracer.lock);
+	// Write whatever made it in before recording stopped and close the file
+	flushBuffers();
+	fprintf(tracer.file, "\n]\n");
+	fclose(tracer.file);
+	tracer.file = NULL;
+
+	uint64_t dropped = 0;
+	int count = tracer.numBuffers.load();
+	for (int i = 0; i < count; i++)
+		dropped += tracer.buffers[i]->dropped.load();
+	return dropped;
+}
+
+/*
+	This function records an event that has already finished.
+	@param name The name of the event, it must be a string literal.
+	@param start When the event started in nanoseconds (on the profileNow clock).
+	@param end When the event ended in nanoseconds (on the profileNow clock).
+*/
+void traceEvent(const char* name, int64_t start, int64_t end)
+{
+	if (!traceEnabled())
+		return;
+	TraceBuffer* buffer = threadBuffer();
+	if (buffer == NULL)
+		return;
+
+	// Drop the event rather than wait if the writer has fallen behind
+	uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	if ((head - buffer->tail.load(std::memory_order_acquire)) >= TRACE_BUFFER_EVENTS){
+		buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	TraceEventRecord* e = &buffer->events[head & (TRACE_BUFFER_EVENTS - 1)];
+	e->name = name;
+	e->start = start;
+	e->end = end;
+	buffer->head.store(head + 1, std::memory_order_release);
+}
+
+/*
+	This function gives the calling thread a name in the trace. It does nothing if no trace is
+	being recorded, so a thread that is not traced never takes a buffer.
+	@param name The name of the thread, it must be a string literal.
+*/
+void traceNameThread(const char* name)
+{
+	if (!traceEnabled())
+		return;
+	TraceBuffer* buffer = threadBuffer();
+	if (buffer != NULL)
+		buffer->name.store(name);
+}
+
+/*
+	This starts timing a scope if a trace is being recorded.
+	@param n The name of the event, it must be a string literal.
+*/
+TraceScope::TraceScope(const char* n) : name(n), start(traceEnabled() ? profileNow() : 0)
+{
+}
+
+/*
+	This records the scope as an event if it was being timed.
+*/
+TraceScope::~TraceScope()
+{
+	if (start != 0)
+		traceEvent(name, start, profileNow());
+}
@@ -0,0 +1,77 @@
+#ifndef __TRACE__
+#define __TRACE__
+
+#include <stdint.h>
+#include <atomic>
+
+/*
+	@file trace.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines a tracer that streams timed events to a Chrome / Perfetto trace file
+	(the JSON array format, open it in chrome://tracing or ui.perfetto.dev). Recording an event only
+	appends it to the calling thread's own buffer, a background thread writes the buffers out.
+	Event names are kept as pointers, so they must be string literals (or live as long as the trace).
+*/
+
+// The number of events each thread can have waiting to be written (must be a power of 2)
+#define TRACE_BUFFER_EVENTS 65536
+// The most threads that can record at once
+#define TRACE_MAX_THREADS 64
+// How often (in ms) the background thread writes out what has been recorded
+#define TRACE_FLUSH_MS 20
+
+// Whether a trace is being recorded right now, read through traceEnabled
+extern std::atomic<bool> traceOn;
+
+/*
+	This function checks if a trace is being recorded, it is cheap enough to call anywhere.
+	@return True if events should be recorded.
+ */
+inline bool traceEnabled()
+{
+	return traceOn.load(std::memory_order_relaxed);
+}
+
+/*
+	This function starts recording a trace and the thread that writes it to a file.
+	@param path Where to write the trace.
+	@return True if the trace was started, false if the file could not be opened or one is already running.
+ */
+bool startTrace(const char* path);
+
+/*
+	This function stops recording, writes out everything left, and closes the file.
+	It does nothing if no trace is running.
+	@return The number of events that were dropped because a thread's buffer was full.
+ */
+uint64_t stopTrace();
+
+/*
+	This function records an event that has already finished.
+	@param name The name of the event, it must be a string literal.
+	@param start When the event started in nanoseconds (on the profileNow clock).
+	@param end When the event ended in nanoseconds (on the profileNow clock).
+ */
+void traceEvent(const char* name, int64_t start, int64_t end);
+
+/*
+	This function gives the calling thread a name in the trace. It does nothing if no trace is
+	being recorded, so a thread that is not traced never takes a buffer.
+	@param name The name of the thread, it must be a string literal.
+ */
+void traceNameThread(const char* name);
+
+// A struct that records the scope it lives in as an event when the scope ends
+struct TraceScope {
+	const char* name;
+	int64_t start;
+	TraceScope(const char* n);
+	~TraceScope();
+};
+
+// Records the rest of the current scope as an event with the given name
+#define TRACE_JOIN2(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_JOIN(traceScope, __LINE__)(name)
+
+#endif
@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <string.h>
+#include "objects.h"
+#include "datastructures.h"
+#include "rng.h"
+#include "world.h"
+#include "vecenv.h"
+
+/*
+	@file vecenv.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements stepping a batch of worlds on a pool of worker threads (workers.h).
+	Each world is one item of the pool's job, claimed VECENV_CHUNK at a time.
+ */
+
+/*
+	This function wraps the distance between two co-ordinates the short way around the window.
+	@param d The straight difference between the co-ordinates.
+	@param span The width (or height) of the window.
+	@return The wrapped difference.
+ */
+static inline float wrapDelta(float d, float span)
+{
+	if (d > (span / 2))
+		d -= span;
+	else if (d < -(span / 2))
+		d += span;
+	return d;
+}
+
+/*
+	This function keeps a short list of the nearest slots seen so far, sorted nearest first.
+	@param dists The distances of the slots in the list.
+	@param slots The slots in the list.
+	@param k The most slots the list can hold.
+	@param count A pointer to the number of slots in the list.
+	@param dist The (squared) distance of the new slot.
+	@param slot The new slot.
+ */
+static void keepNearest(float* dists, int* slots, int k, int* count, float dist, int slot)
+{
+	// Skip it if the list is full and it is further than everything in it
+	if ((*count == k) && (dist >= dists[k - 1]))
+		return;
+	// Slide further slots down to make room
+	int i = (*count < k) ? (*count)++ : (k - 1);
+	for (; (i > 0) && (dists[i - 1] > dist); i--){
+		dists[i] = dists[i - 1];
+		slots[i] = slots[i - 1];
+	}
+	dists[i] = dist;
+	slots[i] = slot;
+}
+
+/*
+	This function describes a world as a fixed number of floats, relative to the player.
+	@param world A pointer to the world to look at.
+	@param obs Where to write the OBS_SIZE floats.
+*/
+void observeWorld(const World* world, float* obs)
+{
+	const float spanX = BOUND_X_UPPER - BOUND_X_LOWER;
+	const float spanY = BOUND_Y_UPPER - BOUND_Y_LOWER;
+	PlayerShip* p = world->p;
+	float px = p->positionVector[X_];
+	float py = p->positionVector[Y_];
+	// Anything we do not fill in stays zero
+	memset(obs, 0, OBS_SIZE * sizeof(float));
+
+	// Describe the player
+	obs[0] = px;
+	obs[1] = py;
+	obs[2] = p->directionUnitVector[X_];
+	obs[3] = p->directionUnitVector[Y_];
+	obs[4] = p->vMag;
+	obs[5] = p->missleCoolDown / PLAYER_COOLDOWN;
+	obs[6] = (float)p->deathsLeft;
+	obs += OBS_PLAYER_SIZE;
+
+	float dists[OBS_NEAREST_ASTEROIDS];
+	int slots[OBS_NEAREST_ASTEROIDS];
+	int count = 0;
+
+	// Find and describe the nearest asteroids
+	ObjectPool* asteroids = world->asteroids;
+	MotionStore* m = asteroids->motion;
+	for (int i = 0; i < asteroids->highWater; i++){
+		if (!asteroids->live[i])
+			continue;
+		float dx = wrapDelta(m->posX[i] - px, spanX);
+		float dy = wrapDelta(m->posY[i] - py, spanY);
+		keepNearest(dists, slots, OBS_NEAREST_ASTEROIDS, &count, (dx * dx) + (dy * dy), i);
+	}
+	for (int k = 0; k < count; k++){
+		int i = slots[k];
+		float* o = obs + (k * OBS_ASTEROID_SIZE);
+		o[0] = wrapDelta(m->posX[i] - px, spanX);
+		o[1] = wrapDelta(m->posY[i] - py, spanY);
+		o[2] = m->velX[i];
+		o[3] = m->velY[i];
+		o[4] = ((Asteroid*)poolSlot(asteroids, i))->scale[X_];
+	}
+	obs += OBS_NEAREST_ASTEROIDS * OBS_ASTEROID_SIZE;
+
+	// Find and describe the nearest aliens
+	ObjectPool* aliens = world->aliens;
+	count = 0;
+	for (int i = 0; i < aliens->highWater; i++){
+		Alien* a = (Alien*)poolSlot(aliens, i);
+		if (a == NULL)
+			continue;
+		float dx = wrapDelta(a->positionVector[X_] - px, spanX);
+		float dy = wrapDelta(a->positionVector[Y_] - py, spanY);
+		keepNearest(dists, slots, OBS_NEAREST_ALIENS, &count, (dx * dx) + (dy * dy), i);
+	}
+	for (int k = 0; k < count; k++){
+		Alien* a = (Alien*)poolSlot(aliens, slots[k]);
+		float* o = obs + (k * OBS_ALIEN_SIZE);
+		o[0] = wrapDelta(a->positionVector[X_] - px, spanX);
+		o[1] = wrapDelta(a->positionVector[Y_] - py, spanY);
+		o[2] = a->isBig ? 1.0f : 0.0f;
+	}
+	obs += OBS_NEAREST_ALIENS * OBS_ALIEN_SIZE;
+
+	// Find and describe the nearest alien missles
+	ObjectPool* shots = world->alienShots;
+	m = shots->motion;
+	count = 0;
+	for (int i = 0; i < shots->highWater; i++){
+		if (!shots->live[i])
+			continue;
+		float dx = wrapDelta(m->posX[i] - px, spanX);
+		float dy = wrapDelta(m->posY[i] - py, spanY);
+		keepNearest(dists, slots, OBS_NEAREST_SHOTS, &count, (dx * dx) + (dy * dy), i);
+	}
+	for (int k = 0; k < count; k++){
+		int i = slots[k];
+		float* o = obs + (k * OBS_SHOT_SIZE);
+		o[0] = wrapDelta(m->posX[i] - px, spanX);
+		o[1] = wrapDelta(m->posY[i] - py, spanY);
+		o[2] = m->velX[i];
+		o[3] = m->velY[i];
+	}
+}
+
+/*
+	This function steps one world of a batch and writes its results, it is run on the worker threads.
+	@param data A pointer to the batch being stepped.
+	@param i The world to step.
+ */
+static void stepOne(void* data, int i)
+{
+	VecEnv* env = (VecEnv*)data;
+	World* world = env->worlds[i];
+	unsigned int deathsBefore = world->deaths;
+	// A NULL input buffer means a reset, everything else is a normal step
+	if (env->inputs == NULL)
+		restartWorld(world);
+	else stepWorld(world, env->inputs[i]);
+	// Write this world's results
+	if (env->obs != NULL)
+		observeWorld(world, env->obs + ((size_t)i * OBS_SIZE));
+	if (env->rewards != NULL)
+		env->rewards[i] = (env->inputs == NULL) ? 0.0f : (float)world->tickScore;
+	if (env->deaths != NULL)
+		env->deaths[i] = world->deaths - deathsBefore;
+}
+
+/*
+	This function creates a batch of worlds and starts its threads.
+	World n is seeded from the config's seed and n, so every world plays a different game.
+	@param numWorlds The number of worlds in the batch.
+	@param config The config for every world, or NULL for the defaults.
+	@param numThreads The number of worker threads to start on top of the caller, or -1 for one per core.
+	@return A pointer to the batch that was made.
+*/
+VecEnv* createVecEnv(int numWorlds, const WorldConfig* config, int numThreads)
+{
+	VecEnv* env = (VecEnv*)malloc(sizeof(VecEnv));
+
+	// Make every world with its own seed
+	WorldConfig worldConfig;
+	if (config == NULL)
+		defaultWorldConfig(&worldConfig);
+	else worldConfig = *config;
+	uint64_t seed = worldConfig.seed;
+	env->numWorlds = numWorlds;
+	env->worlds = (World**)malloc(numWorlds * sizeof(World*));
+	for (int i = 0; i < numWorlds; i++){
+		worldConfig.seed = rngHash(seed, (uint64_t)i);
+		env->worlds[i] = createWorld(&worldConfig);
+	}
+
+	// Start the threads that step the worlds
+	env->workers = createWorkers(numThreads, "vecenv worker");
+	return env;
+}
+
+/*
+	This function stops the threads of a batch and frees it and its worlds.
+	@param env A pointer to the batch to destroy.
+*/
+void destroyVecEnv(VecEnv* env)
+{
+	destroyWorkers(env->workers);
+	for (int i = 0; i < env->numWorlds; i++)
+		destroyWorld(env->worlds[i]);
+	free(env->worlds);
+	free(env);
+}
+
+/*
+	This function steps every world in a batch once, in parallel.
+	@param env A pointer to the batch to step.
+	@param inputs The INPUT_ bits for each world (numWorlds of them).
+	@param obs Where to write each world's observation (numWorlds * OBS_SIZE floats), or NULL.
+	@param rewards Where to write the score each world earned this step (numWorlds of them), or NULL.
+	@param deaths Where to write how many times each world's player died this step (numWorlds of them), or NULL.
+*/
+void stepVecEnv(VecEnv* env, const unsigned int* inputs, float* obs, float* rewards, unsigned int* deaths)
+{
+	env->inputs = inputs;
+	env->obs = obs;
+	env->rewards = rewards;
+	env->deaths = deaths;
+	runWorkers(env->workers, stepOne, env, env->numWorlds, VECENV_CHUNK);
+}
+
+/*
+	This function restarts every world in a batch and writes their observations.
+	@param env A pointer to the batch to reset.
+	@param obs Where to write each world's observation (numWorlds * OBS_SIZE floats), or NULL.
+*/
+void resetVecEnv(VecEnv* env, float* obs)
+{
+	env->inputs = NULL;
+	env->obs = obs;
+	env->rewards = NULL;
+	env->deaths = NULL;
+	runWorkers(env->workers, stepOne, env, env->numWorlds, VECENV_CHUNK);
+}
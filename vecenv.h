@@ -0,0 +1,87 @@
+#ifndef __VECENV__
+#define __VECENV__
+
+#include "world.h"
+#include "workers.h"
+
+/*
+	@file vecenv.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines a batch of worlds that are stepped together on a pool of threads.
+	Every step takes one input per world and writes what each world looks like, how much it
+	scored, and how many times it died into buffers the caller owns.
+*/
+
+// How many of the nearest objects of each kind go into an observation
+#define OBS_NEAREST_ASTEROIDS 8
+#define OBS_NEAREST_ALIENS 2
+#define OBS_NEAREST_SHOTS 4
+// How many floats describe the player: x, y, direction x, direction y, speed, cooldown, deaths left
+#define OBS_PLAYER_SIZE 7
+// How many floats describe an asteroid: dx, dy, vx, vy, radius
+#define OBS_ASTEROID_SIZE 5
+// How many floats describe an alien: dx, dy, whether it is big
+#define OBS_ALIEN_SIZE 3
+// How many floats describe an alien missle: dx, dy, vx, vy
+#define OBS_SHOT_SIZE 4
+// The number of floats in a single world's observation
+#define OBS_SIZE (OBS_PLAYER_SIZE + (OBS_NEAREST_ASTEROIDS * OBS_ASTEROID_SIZE) + \
+	(OBS_NEAREST_ALIENS * OBS_ALIEN_SIZE) + (OBS_NEAREST_SHOTS * OBS_SHOT_SIZE))
+// How many worlds a thread claims at a time
+#define VECENV_CHUNK 4
+
+// A struct holding a batch of worlds and the threads that step them
+typedef struct {
+	// The worlds in the batch
+	World** worlds;
+	int numWorlds;
+	// The worker threads (the thread calling stepVecEnv works too)
+	WorkerPool* workers;
+	// The buffers for the step in progress
+	const unsigned int* inputs;
+	float* obs;
+	float* rewards;
+	unsigned int* deaths;
+} VecEnv;
+
+/*
+	This function creates a batch of worlds and starts its threads.
+	World n is seeded from the config's seed and n, so every world plays a different game.
+	@param numWorlds The number of worlds in the batch.
+	@param config The config for every world, or NULL for the defaults.
+	@param numThreads The number of worker threads to start on top of the caller, or -1 for one per core.
+	@return A pointer to the batch that was made.
+ */
+VecEnv* createVecEnv(int numWorlds, const WorldConfig* config, int numThreads);
+
+/*
+	This function stops the threads of a batch and frees it and its worlds.
+	@param env A pointer to the batch to destroy.
+ */
+void destroyVecEnv(VecEnv* env);
+
+/*
+	This function steps every world in a batch once, in parallel.
+	@param env A pointer to the batch to step.
+	@param inputs The INPUT_ bits for each world (numWorlds of them).
+	@param obs Where to write each world's observation (numWorlds * OBS_SIZE floats), or NULL.
+	@param rewards Where to write the score each world earned this step (numWorlds of them), or NULL.
+	@param deaths Where to write how many times each world's player died this step (numWorlds of them), or NULL.
+ */
+void stepVecEnv(VecEnv* env, const unsigned int* inputs, float* obs, float* rewards, unsigned int* deaths);
+
+/*
+	This function restarts every world in a batch and writes their observations.
+	@param env A pointer to the batch to reset.
+	@param obs Where to write each world's observation (numWorlds * OBS_SIZE floats), or NULL.
+ */
+void resetVecEnv(VecEnv* env, float* obs);
+
+/*
+	This function describes a world as a fixed number of floats, relative to the player.
+	@param world A pointer to the world to look at.
+	@param obs Where to write the OBS_SIZE floats.
+ */
+void observeWorld(const World* world, float* obs);
+
+#endif
@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include "workers.h"
+#include "trace.h"
+
+/*
+	@file workers.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file implements the pool of worker threads. A job is handed out by storing it and bumping
+	a generation count under the lock, each worker wakes on the new generation, claims items until
+	there are none left, and the last one to finish wakes the caller.
+ */
+
+/*
+	This function runs the job in progress on items claimed off the shared counter until every
+	item has been claimed.
+	@param pool A pointer to the pool running the job.
+ */
+static void claimItems(WorkerPool* pool)
+{
+	for (;;){
+		// Claim the next few items
+		int first = pool->next.fetch_add(pool->chunk);
+		if (first >= pool->count)
+			return;
+		int last = first + pool->chunk;
+		if (last > pool->count)
+			last = pool->count;
+		for (int i = first; i < last; i++)
+			pool->work(pool->data, i);
+	}
+}
+
+/*
+	This function is run by every worker thread. It sleeps until there is a job to do,
+	helps with it, and reports back when there is nothing left to claim.
+	@param pool A pointer to the pool the thread works for.
+ */
+static void workerMain(WorkerPool* pool)
+{
+	unsigned long long seen = 0;
+	if (traceEnabled())
+		traceNameThread(pool->name);
+	for (;;){
+		// Wait for a new job (or to be told to quit)
+		{
+			std::unique_lock<std::mutex> guard(pool->lock);
+			pool->wake.wait(guard, [&]{ return pool->quit || (pool->generation != seen); });
+			if (pool->quit)
+				return;
+			seen = pool->generation;
+		}
+
+		claimItems(pool);
+
+		// Let the caller know once the last worker is done
+		std::lock_guard<std::mutex> guard(pool->lock);
+		if (--pool->running == 0)
+			pool->done.notify_one();
+	}
+}
+
+/*
+	This function creates a pool of worker threads and starts them.
+	@param numThreads The number of worker threads to start on top of the caller, or -1 for one per
+		core (leaving one for the caller).
+	@param name What to call the threads in a trace, it must be a string literal.
+	@return A pointer to the pool.
+*/
+WorkerPool* createWorkers(int numThreads, const char* name)
+{
+	// The locks and threads need real constructors
+	WorkerPool* pool = new WorkerPool();
+	if (numThreads < 0)
+		numThreads = (int)std::thread::hardware_concurrency() - 1;
+	if (numThreads < 0)
+		numThreads = 0;
+	pool->numThreads = numThreads;
+	pool->name = name;
+	pool->generation = 0;
+	pool->running = 0;
+	pool->quit = false;
+	pool->work = NULL;
+	pool->data = NULL;
+	pool->count = 0;
+	pool->chunk = 1;
+	pool->next.store(0);
+	pool->threads = new std::thread[numThreads];
+	for (int i = 0; i < numThreads; i++)
+		pool->threads[i] = std::thread(workerMain, pool);
+	return pool;
+}
+
+/*
+	This function stops the threads of a pool and frees it.
+	@param pool A pointer to the pool to destroy.
+*/
+void destroyWorkers(WorkerPool* pool)
+{
+	if (pool == NULL)
+		return;
+	// Tell the workers to leave and wait for them
+	{
+		std::lock_guard<std::mutex> guard(pool->lock);
+		pool->quit = true;
+	}
+	pool->wake.notify_all();
+	for (int i = 0; i < pool->numThreads; i++)
+		pool->threads[i].join();
+	delete[] pool->threads;
+	delete pool;
+}
+
+/*
+	This function runs a job on every thread of a pool, and the calling thread, and waits until it
+	is done. Items are claimed a few at a time off a shared counter, so a slow item never holds up
+	a whole thread's worth of others. Items may run in any order on any thread.
+	@param pool A pointer to the pool to run the job on.
+	@param work The function to run for every item.
+	@param data What to hand the function.
+	@param count The number of items, numbered from 0.
+	@param chunk How many items a thread claims at a time.
+*/
+void runWorkers(WorkerPool* pool, WorkFunction work, void* data, int count, int chunk)
+{
+	pool->work = work;
+	pool->data = data;
+	pool->count = count;
+	pool->chunk = (chunk < 1) ? 1 : chunk;
+	pool->next.store(0);
+	// Wake the workers (with none, the caller does it all)
+	if (pool->numThreads > 0){
+		{
+			std::lock_guard<std::mutex> guard(pool->lock);
+			pool->running = pool->numThreads;
+			pool->generation++;
+		}
+		pool->wake.notify_all();
+	}
+
+	// Pitch in, then wait for the stragglers
+	claimItems(pool);
+	std::unique_lock<std::mutex> guard(pool->lock);
+	pool->done.wait(guard, [&]{ return pool->running == 0; });
+}
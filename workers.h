@@ -0,0 +1,75 @@
+#ifndef __WORKERS__
+#define __WORKERS__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/*
+	@file workers.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines a pool of worker threads that split a job of numbered items between
+	them. The threads sleep between jobs, and the thread handing out a job works on it too and
+	only returns once every item is done.
+*/
+
+// The function a job runs for every item, given the job's data and the item's number
+typedef void (*WorkFunction)(void* data, int item);
+
+// A struct holding a pool of worker threads
+typedef struct {
+	// The worker threads (the thread calling runWorkers works too)
+	std::thread* threads;
+	int numThreads;
+	// What the threads are called in a trace
+	const char* name;
+	// Guards everything the workers wait on
+	std::mutex lock;
+	// Signalled when there is a new job, or when it is time to quit
+	std::condition_variable wake;
+	// Signalled when the last worker finishes a job
+	std::condition_variable done;
+	// Bumped once per job so workers know there is new work
+	unsigned long long generation;
+	// The number of workers still busy with this job
+	int running;
+	// Set when the workers should exit
+	bool quit;
+	// The job in progress: what to run, on what, for how many items, claimed how many at a time
+	WorkFunction work;
+	void* data;
+	int count;
+	int chunk;
+	// The next item that has not been claimed this job
+	std::atomic<int> next;
+} WorkerPool;
+
+/*
+	This function creates a pool of worker threads and starts them.
+	@param numThreads The number of worker threads to start on top of the caller, or -1 for one per
+		core (leaving one for the caller).
+	@param name What to call the threads in a trace, it must be a string literal.
+	@return A pointer to the pool.
+ */
+WorkerPool* createWorkers(int numThreads, const char* name);
+
+/*
+	This function stops the threads of a pool and frees it.
+	@param pool A pointer to the pool to destroy.
+ */
+void destroyWorkers(WorkerPool* pool);
+
+/*
+	This function runs a job on every thread of a pool, and the calling thread, and waits until it
+	is done. Items are claimed a few at a time off a shared counter, so a slow item never holds up
+	a whole thread's worth of others. Items may run in any order on any thread.
+	@param pool A pointer to the pool to run the job on.
+	@param work The function to run for every item.
+	@param data What to hand the function.
+	@param count The number of items, numbered from 0.
+	@param chunk How many items a thread claims at a time.
+ */
+void runWorkers(WorkerPool* pool, WorkFunction work, void* data, int count, int chunk);
+
+#endif
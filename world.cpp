@@ -0,0 +1,638 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "objects.h"
+#include "datastructures.h"
+#include "smack.h"
+#include "grid.h"
+#include "world.h"
+#include "profiler.h"
+
+/*
+	@file world.cpp
+	@author Derek Batts - dsbatts@ncsu.edu
+	This file contains the game loop for a single tick along with
+	setting up, restarting, and tearing down a world.
+ */
+
+// The first four bytes of every world snapshot
+#define WORLD_SNAPSHOT_MAGIC 0x50534E53
+
+// The fixed size front of a world snapshot, the pools follow it
+typedef struct {
+	// Checks that the snapshot belongs to a world like this one
+	unsigned int magic;
+	size_t size;
+	int capacities[5];
+	int tickRate;
+	// The player and everything else in the world that is not in a pool
+	PlayerShip player;
+	int num_asteroids;
+	float alienTimer;
+	bool firstSpawned;
+	int lifetimeScore;
+	int tickScore;
+	unsigned int ticks;
+	unsigned int deaths;
+	uint64_t seed;
+	Rng rng;
+	uint64_t aliensSpawned;
+} WorldSnapshotHeader;
+
+/*
+	This function fills in a config with the sizes the game normally runs with.
+	@param config A pointer to the config to fill in.
+*/
+void defaultWorldConfig(WorldConfig* config)
+{
+	config->maxAsteroids = MAX_ASTEROIDS;
+	config->maxMissles = MAX_MISSLES;
+	config->maxAliens = MAX_ALIENS;
+	config->maxExplosions = MAX_EXPLOSIONS;
+	config->tickRate = SIM_BASE_HZ;
+	config->seed = 1;
+}
+
+/*
+	This function creates a world and starts a new game in it.
+	All of the memory the world will ever use is allocated here.
+	@param config The sizes to use, or NULL for the defaults.
+	@return A pointer to the world that was made.
+*/
+World* createWorld(const WorldConfig* config)
+{
+	// Fall back on the normal sizes
+	WorldConfig defaults;
+	if (config == NULL){
+		defaultWorldConfig(&defaults);
+		config = &defaults;
+	}
+
+	World* world = (World*)malloc(sizeof(World));
+	world->p = initPlayer();
+	// Create pools of stuff, this is the only time they allocate
+	world->asteroids = createPool(sizeof(Asteroid), config->maxAsteroids, true);
+	world->explosions = createPool(sizeof(Explosion), config->maxExplosions, false);
+	world->playerShots = createPool(sizeof(Missle), config->maxMissles, true);
+	world->aliens = createPool(sizeof(Alien), config->maxAliens, false);
+	world->alienShots = createPool(sizeof(Missle), config->maxMissles, true);
+	// Create the grids used to find collision candidates
+	world->playerShotGrid = createGrid(config->maxMissles);
+	world->alienShotGrid = createGrid(config->maxMissles);
+	world->alienGrid = createGrid(config->maxAliens);
+	world->targets = createTargetBlock();
+
+	// Setup player ship
+	world->p->positionVector[X_] = PLAYER_INIT_POSX;
+	world->p->positionVector[Y_] = PLAYER_INIT_POSY;
+	world->p->positionVector[Z_] = Z_LEVEL;
+	world->p->orientation[Y_] = 1.0f;
+
+	// Work out how much game time passes every tick, keeping the rate sane
+	world->tickRate = config->tickRate;
+	if (world->tickRate < MIN_TICK_RATE)
+		world->tickRate = MIN_TICK_RATE;
+	else if (world->tickRate > MAX_TICK_RATE)
+		world->tickRate = MAX_TICK_RATE;
+	world->dt = (float)SIM_BASE_HZ / world->tickRate;
+
+	// Start the world's random streams
+	world->seed = config->seed;
+	seedRng(&world->rng, world->seed, RNG_STREAM_WORLD);
+	world->aliensSpawned = 0;
+
+	// Start a fresh game
+	world->ticks = 0;
+	world->deaths = 0;
+	world->tickScore = 0;
+	world->profiler = NULL;
+	restartWorld(world);
+	return world;
+}
+
+/*
+	This function frees a world and everything in it.
+	@param world A pointer to the world to destroy.
+*/
+void destroyWorld(World* world)
+{
+	free(world->p);
+	destroyPool(world->asteroids);
+	destroyPool(world->playerShots);
+	destroyPool(world->explosions);
+	destroyPool(world->aliens);
+	destroyPool(world->alienShots);
+	destroyGrid(world->playerShotGrid);
+	destroyGrid(world->alienShotGrid);
+	destroyGrid(world->alienGrid);
+	destroyTargetBlock(world->targets);
+	free(world);
+}
+
+/*
+	This function advances the world by one tick of 1 / tickRate seconds.
+	@param world A pointer to the world to step.
+	@param input The INPUT_ bits for this tick.
+*/
+void stepWorld(World* world, unsigned int input)
+{
+	// Grab everything out of the world
+	PlayerShip* p = world->p;
+	ObjectPool* asteroids = world->asteroids;
+	ObjectPool* playerShots = world->playerShots;
+	ObjectPool* explosions = world->explosions;
+	ObjectPool* aliens = world->aliens;
+	ObjectPool* alienShots = world->alienShots;
+	float dt = world->dt;
+
+	// Start timing the tick if anyone is watching
+	Profiler* profiler = world->profiler;
+	ProfileTimer timer;
+	profileBeginFrame(profiler);
+	startProfileTimer(&timer, profiler);
+	int64_t tickStart = timer.last;
+	// The number of pairs handed to the narrowphase this tick
+	unsigned int tests = 0;
+
+	// Nothing has been scored yet this tick
+	world->tickScore = 0;
+
+	// Start over if asked to, this goes through the input so replays see it too
+	if (input & INPUT_RESTART)
+		restartWorld(world);
+
+	// Try to fire a shot if the fire button was pressed
+	if (input & INPUT_FIRE)
+		fireShot(p, playerShots);
+
+	// Check if we can spawn a new alien
+	if ((world->alienTimer <= 0) && (asteroids->size < 10) && (aliens->size <= 4)){
+		// Give the new alien its own stream
+		Rng stream;
+		seedRng(&stream, world->seed, RNG_STREAM_ALIENS + world->aliensSpawned++);
+		// Spawn a larger alien if this is the first alien of the screen / level
+		if (!world->firstSpawned){
+			initAlienShip(true, aliens, &stream);
+			world->firstSpawned = true;
+		}
+		// Check if the lifetime score will let us spawn a small alien
+		else if (world->lifetimeScore >= ALIEN_SMALL_SPAWN_REQ)
+			initAlienShip(rngInt(&world->rng, 2), aliens, &stream);
+		// Otherwise spawn a big alien
+		else initAlienShip(true, aliens, &stream);
+
+		world->alienTimer = ALIEN_SPAWN_TIME;
+	}
+	// Decrement the timer for alien spawn
+	else if (world->alienTimer > 0)
+		world->alienTimer -= dt;
+	profileLap(&timer, PHASE_ALIEN_SPAWN);
+
+	// Update all the aliens
+	for (int i = 0; i < aliens->highWater; i++){
+		Alien* a = (Alien*)poolSlot(aliens, i);
+		if (a == NULL)
+			continue;
+		// Remove the alien if it has run its course as we update it
+		if (updateAlien(a, dt))
+			poolRemove(a, aliens);
+		// Otherwise try to make the alien shoot a missle
+		else alienShoot(a, asteroids, p, alienShots);
+	}
+	profileLap(&timer, PHASE_ALIEN_UPDATE);
+
+	// Update every asteroid at once
+	updateAsteroids(asteroids, dt);
+	profileLap(&timer, PHASE_ASTEROID_UPDATE);
+
+	// Update explosions
+	for (int i = 0; i < explosions->highWater; i++){
+		Explosion* e = (Explosion*)poolSlot(explosions, i);
+		if (e == NULL)
+			continue;
+		// Remove if it has reached its limit
+		if (e->age >= EXPLOSION_MAX_AGE)
+			poolRemove(e, explosions);
+		else updateExplosion(e, dt);
+	}
+	profileLap(&timer, PHASE_EXPLOSION_UPDATE);
+
+	// Update the player ship
+	updatePlayer(p, input, dt);
+	profileLap(&timer, PHASE_PLAYER_UPDATE);
+
+	// Move all the player and alien missles, getting rid of the old ones
+	updateMissles(playerShots, dt);
+	updateMissles(alienShots, dt);
+	profileLap(&timer, PHASE_MISSLE_UPDATE);
+
+	// Everything has moved, so work out where each object can be hit once for every test below
+	updateColliders(p, asteroids, aliens);
+	profileLap(&timer, PHASE_COLLIDER_UPDATE);
+
+	// Bucket the missles and aliens so the collision checks below only look at nearby pairs
+	SpatialGrid* playerShotGrid = world->playerShotGrid;
+	SpatialGrid* alienShotGrid = world->alienShotGrid;
+	SpatialGrid* alienGrid = world->alienGrid;
+	buildGridFromPool(playerShotGrid, playerShots);
+	buildGridFromPool(alienShotGrid, alienShots);
+	resetGrid(alienGrid);
+	for (int i = 0; i < aliens->highWater; i++){
+		Alien* a = (Alien*)poolSlot(aliens, i);
+		if (a != NULL)
+			gridAddPoint(alienGrid, i, a->positionVector[X_], a->positionVector[Y_]);
+	}
+	finishGrid(alienGrid);
+	profileLap(&timer, PHASE_GRID_BUILD);
+
+	// Candidates are packed into blocks and tested a block at a time, the first hit in a block is
+	// the one the pair by pair loop would have found
+	TargetBlock* targets = world->targets;
+
+	// Check all the alien missles near the player
+	int found = queryGrid(alienShotGrid, p->positionVector[X_], p->positionVector[Y_], PLAYER_REACH, PLAYER_REACH);
+	tests += found;
+	for (int next = 0; next < found;){
+		next = gatherShots(targets, alienShots, alienShotGrid->found, found, next);
+		uint32_t hits = detectCollidePlayerShots(p, targets);
+		if (hits != 0){
+			// Decrement the deaths left counter
+			p->deathsLeft--;
+			world->deaths++;
+			// Handle the collision
+			handleCollidePlayerShot(p, alienShots, targets->slot[batchFirstHit(hits)], explosions);
+			break;
+		}
+	}
+	profileLap(&timer, PHASE_COLLIDE_PLAYER);
+
+	// Loop through each asteroid in our pool
+	for (int i = 0; i < asteroids->highWater; i++){
+		Asteroid* a = (Asteroid*)poolSlot(asteroids, i);
+		if (a == NULL)
+			continue;
+		float ax = asteroids->motion->posX[i];
+		float ay = asteroids->motion->posY[i];
+		float radius = a->scale[X_];
+		// Check if it collides with the player (skipping the full test if the player is nowhere near)
+		if ((fabs(p->positionVector[X_] - ax) <= (radius + PLAYER_REACH)) &&
+			(fabs(p->positionVector[Y_] - ay) <= (radius + PLAYER_REACH)) &&
+			detectCollideAsteroidShip(asteroids, i, p)){
+			handleCollideAsteroidShip(asteroids, i, p, explosions);
+			p->deathsLeft--;
+			world->deaths++;
+			continue;
+		}
+
+		bool changed = false;
+		// Check for collisions between nearby aliens and asteroids
+		found = queryGrid(alienGrid, ax, ay, ALIEN_REACH_X + (ASTEROID_ALIEN_REACH * radius), ALIEN_REACH_Y + (ASTEROID_ALIEN_REACH * radius));
+		tests += found;
+		for (int next = 0; (next < found) && !changed;){
+			next = gatherAliens(targets, aliens, alienGrid->found, found, next);
+			uint32_t hits = detectCollideAsteroidAliens(asteroids, i, targets);
+			if (hits != 0){
+				changed = true;
+				Alien* alien = (Alien*)poolSlot(aliens, targets->slot[batchFirstHit(hits)]);
+				handleCollideAsteroidAlien(asteroids, i, aliens, alien, explosions);
+			}
+		}
+		// Check all the player missles near the asteroid
+		found = changed ? 0 : queryGrid(playerShotGrid, ax, ay, radius, radius);
+		tests += found;
+		for (int next = 0; (next < found) && !changed;){
+			next = gatherShots(targets, playerShots, playerShotGrid->found, found, next);
+			uint32_t hits = detectCollideAsteroidShots(asteroids, i, targets);
+			if (hits != 0){
+				int j = targets->slot[batchFirstHit(hits)];
+				// Calculate score for the player
+				int score = 0;
+				if (a->age == 2)
+					score = 20;
+				else if (a->age == 1)
+					score = 50;
+				else if (a->age == 0)
+					score = 100;
+				p->score += score;
+				world->lifetimeScore += score;
+				world->tickScore += score;
+				changed = true;
+				handleCollideAsteroidShot(asteroids, i, playerShots, j, explosions);
+			}
+		}
+		// Check all alien shots near the asteroid
+		found = changed ? 0 : queryGrid(alienShotGrid, ax, ay, radius, radius);
+		tests += found;
+		for (int next = 0; (next < found) && !changed;){
+			next = gatherShots(targets, alienShots, alienShotGrid->found, found, next);
+			uint32_t hits = detectCollideAsteroidShots(asteroids, i, targets);
+			if (hits != 0){
+				changed = true;
+				handleCollideAsteroidShot(asteroids, i, alienShots, targets->slot[batchFirstHit(hits)], explosions);
+			}
+		}
+	}
+	profileLap(&timer, PHASE_COLLIDE_ASTEROIDS);
+
+	// Loop through all the aliens
+	for (int i = 0; i < aliens->highWater; i++){
+		Alien* a = (Alien*)poolSlot(aliens, i);
+		if (a == NULL)
+			continue;
+		// Check if the player and alien collide
+		tests++;
+		if (detectCollideAlienPlayer(a, p)){
+			// Handle the collision and update the player's deaths left
+			handleCollideAlienPlayer(aliens, a, p, explosions);
+			p->deathsLeft--;
+			world->deaths++;
+			continue;
+		}
+		// Check if player shots near the alien hit it
+		found = queryGrid(playerShotGrid, a->positionVector[X_], a->positionVector[Y_], ALIEN_REACH_X, ALIEN_REACH_Y);
+		tests += found;
+		for (int next = 0; next < found;){
+			next = gatherShots(targets, playerShots, playerShotGrid->found, found, next);
+			uint32_t hits = detectCollideAlienShots(a, targets);
+			if (hits != 0){
+				int j = targets->slot[batchFirstHit(hits)];
+				// Calculate score
+				int score = 0;
+				if (a->isBig)
+					score = 200;
+				else score = 1000;
+				p->score += score;
+				world->lifetimeScore += score;
+				world->tickScore += score;
+
+				// Handle the collision
+				handleCollideAlienShot(aliens, a, playerShots, j, explosions);
+				break;
+			}
+		}
+	}
+	profileLap(&timer, PHASE_COLLIDE_ALIENS);
+
+	// See if the player has scored enough for a new life
+	if (p->score >= NEW_LIFE_REQ){
+		p->score -= NEW_LIFE_REQ;
+		p->deathsLeft++;
+	}
+
+	// Check for no asteroids
+	if (asteroids->size == 0){
+		// Reset game
+		if(world->num_asteroids < MAX_NUM_ASTEROIDS)
+			world->num_asteroids++;
+		addAsteroids(world, world->num_asteroids);
+		p->positionVector[X_] = PLAYER_INIT_POSX;
+		p->positionVector[Y_] = PLAYER_INIT_POSY;
+		p->spin = 0.0f;
+		clearPool(playerShots);
+		clearPool(alienShots);
+		clearPool(aliens);
+		world->alienTimer = ALIEN_SPAWN_TIME;
+		world->firstSpawned = false;
+	}
+	// See if the player is out of lives
+	if (p->deathsLeft <= -1)
+		restartWorld(world);
+	profileLap(&timer, PHASE_LEVEL);
+
+	// Finish timing the tick and count what is in the world
+	profileSpan(&timer, PHASE_TICK, tickStart);
+	profileCount(profiler, COUNTER_ASTEROIDS, asteroids->size);
+	profileCount(profiler, COUNTER_MISSLES, playerShots->size + alienShots->size);
+	profileCount(profiler, COUNTER_ALIENS, aliens->size);
+	profileCount(profiler, COUNTER_EXPLOSIONS, explosions->size);
+	profileCount(profiler, COUNTER_COLLISION_TESTS, tests);
+	profileEndFrame(profiler);
+
+	world->ticks++;
+}
+
+/*
+	This function restarts the game as if it had just been launched.
+	@param world A pointer to the world to restart.
+*/
+void restartWorld(World* world)
+{
+	// Grab everything out of the world
+	PlayerShip* p = world->p;
+	ObjectPool* asteroids = world->asteroids;
+	ObjectPool* playerShots = world->playerShots;
+	ObjectPool* explosions = world->explosions;
+	ObjectPool* aliens = world->aliens;
+	ObjectPool* alienShots = world->alienShots;
+
+	// Clear all the pools
+	clearPool(asteroids);
+	clearPool(playerShots);
+	clearPool(explosions);
+	clearPool(aliens);
+	clearPool(alienShots);
+
+	// Reset the asteroid count and remake the list of asteroids
+	world->num_asteroids = 1;
+	addAsteroids(world, world->num_asteroids);
+	
+	// Reset the player
+	p->positionVector[X_] = PLAYER_INIT_POSX;
+	p->positionVector[Y_] = PLAYER_INIT_POSY;
+	p->spin = 0.0f;
+	p->score = 0;
+	world->lifetimeScore = 0;
+	p->deathsLeft = PLAYER_DEATHS_INIT;
+
+	// Reset stuff for spawning alienss
+	world->alienTimer = ALIEN_SPAWN_TIME;
+	world->firstSpawned = false;
+}
+
+/*
+	This function works out how many bytes a snapshot of the world takes right now.
+	@param world A pointer to the world.
+	@return The number of bytes.
+*/
+size_t worldSnapshotSize(const World* world)
+{
+	return sizeof(WorldSnapshotHeader) + poolSnapshotSize(world->asteroids) +
+		poolSnapshotSize(world->playerShots) + poolSnapshotSize(world->explosions) +
+		poolSnapshotSize(world->aliens) + poolSnapshotSize(world->alienShots);
+}
+
+/*
+	This function works out the most bytes a snapshot of the world could ever take,
+	so a buffer of this size can hold any snapshot of it.
+	@param world A pointer to the world.
+	@return The number of bytes.
+*/
+size_t maxWorldSnapshotSize(const World* world)
+{
+	return sizeof(WorldSnapshotHeader) + poolMaxSnapshotSize(world->asteroids) +
+		poolMaxSnapshotSize(world->playerShots) + poolMaxSnapshotSize(world->explosions) +
+		poolMaxSnapshotSize(world->aliens) + poolMaxSnapshotSize(world->alienShots);
+}
+
+/*
+	This function fills in the capacities of every pool in a world, in snapshot order.
+	@param world A pointer to the world.
+	@param capacities Where to put the capacities.
+ */
+static void worldCapacities(const World* world, int (&capacities)[5])
+{
+	capacities[0] = world->asteroids->capacity;
+	capacities[1] = world->playerShots->capacity;
+	capacities[2] = world->explosions->capacity;
+	capacities[3] = world->aliens->capacity;
+	capacities[4] = world->alienShots->capacity;
+}
+
+/*
+	This function copies the whole state of a world into one flat buffer.
+	The buffer holds no pointers, so it can be copied around with memcpy.
+	@param world A pointer to the world to save.
+	@param buffer Where to write the snapshot.
+	@param capacity The number of bytes of room in the buffer.
+	@return The number of bytes written, or 0 if the buffer is too small.
+*/
+size_t snapshotWorld(const World* world, void* buffer, size_t capacity)
+{
+	size_t size = worldSnapshotSize(world);
+	if (size > capacity)
+		return 0;
+
+	// Fill in the header
+	WorldSnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = WORLD_SNAPSHOT_MAGIC;
+	header.size = size;
+	worldCapacities(world, header.capacities);
+	header.tickRate = world->tickRate;
+	header.player = *world->p;
+	header.num_asteroids = world->num_asteroids;
+	header.alienTimer = world->alienTimer;
+	header.firstSpawned = world->firstSpawned;
+	header.lifetimeScore = world->lifetimeScore;
+	header.tickScore = world->tickScore;
+	header.ticks = world->ticks;
+	header.deaths = world->deaths;
+	header.seed = world->seed;
+	header.rng = world->rng;
+	header.aliensSpawned = world->aliensSpawned;
+
+	// Write the header and then every pool back to back (the grids are rebuilt every tick, so they are skipped)
+	char* out = (char*)buffer;
+	memcpy(out, &header, sizeof(header));
+	out += sizeof(header);
+	out = savePool(world->asteroids, out);
+	out = savePool(world->playerShots, out);
+	out = savePool(world->explosions, out);
+	out = savePool(world->aliens, out);
+	out = savePool(world->alienShots, out);
+	return size;
+}
+
+/*
+	This function puts a world back the way it was when a snapshot was taken.
+	The world must have been made with the same config as the one saved.
+	@param world A pointer to the world to restore.
+	@param buffer The snapshot.
+	@param size The number of bytes in the snapshot.
+	@return True if the world was restored, false if the snapshot does not fit this world.
+*/
+bool restoreWorld(World* world, const void* buffer, size_t size)
+{
+	if (size < sizeof(WorldSnapshotHeader))
+		return false;
+	const char* in = (const char*)buffer;
+	WorldSnapshotHeader header;
+	memcpy(&header, in, sizeof(header));
+	in += sizeof(header);
+
+	// Make sure the snapshot came from a world with the same pools and tick rate
+	int capacities[5];
+	worldCapacities(world, capacities);
+	if ((header.magic != WORLD_SNAPSHOT_MAGIC) || (header.size != size) || (header.tickRate != world->tickRate) ||
+		(memcmp(header.capacities, capacities, sizeof(capacities)) != 0))
+		return false;
+
+	// Put everything back
+	*world->p = header.player;
+	world->num_asteroids = header.num_asteroids;
+	world->alienTimer = header.alienTimer;
+	world->firstSpawned = header.firstSpawned;
+	world->lifetimeScore = header.lifetimeScore;
+	world->tickScore = header.tickScore;
+	world->ticks = header.ticks;
+	world->deaths = header.deaths;
+	world->seed = header.seed;
+	world->rng = header.rng;
+	world->aliensSpawned = header.aliensSpawned;
+	in = loadPool(world->asteroids, in);
+	in = loadPool(world->playerShots, in);
+	in = loadPool(world->explosions, in);
+	in = loadPool(world->aliens, in);
+	in = loadPool(world->alienShots, in);
+	return true;
+}
+
+/*
+	This function adds randomly placed asteroids to the world according to the specified rules,
+	a new screen is filled with num_asteroids of them.
+	@param world A pointer to the world to add asteroids to.
+	@param count The number of asteroids to add, it stops early if the pool fills up.
+*/
+void addAsteroids(World* world, int count)
+{
+	Rng* rng = &world->rng;
+	// Loop through the whole array
+	for (int i = 0; i < count; i++){
+		// Create an asteroid
+		Asteroid* a = initAsteroid(world->asteroids, rng);
+		if (a == NULL)
+			break;
+		int slot = poolIndexOf(a, world->asteroids);
+		MotionStore* motion = world->asteroids->motion;
+
+		// Randomly set its spin
+		motion->spin[slot] = (float)rngInt(rng, 90);
+		// Randomly set the spin factor
+		float spinFactor;
+		for (spinFactor = 100.0f; (spinFactor < -2.0) || (spinFactor > 2.0) || (spinFactor == -0.0f) || (spinFactor == 0.0f); spinFactor = (float)-1 * rngInt(rng, 2) * ((float)3 / rngInt(rng, 15)));
+			motion->spinFactor[slot] = spinFactor;
+		
+		// Randomly generate and set scale
+		float scale;
+		for (scale = 0.0f; (scale < 0.4f) || (scale > 0.9f); scale = (float)1 / rngInt(rng, 10));
+		for (int j = 0; j < 3; j++)
+			a->scale[j] = scale;
+
+		// Randomly pick an axis to spin about
+		a->orientation[rngInt(rng, 3)] = 1.0f;
+
+		for (int j = 0; j < 2; j++){
+			// Randomly generate a velocity
+			float vel;
+			for (vel = 0.0f; (vel < -0.06f) || (vel > 0.06f) || (vel == 0.0f) || (vel == -0.0f); vel = (float)1 / (10 + (25 + rngInt(rng, 100))));
+			
+			// Alternal direction
+			if (i >= (count / 2))
+				vel = -vel;
+
+			// Randomly generate a starting position
+			float pos;
+			for (pos = -10.f; (pos < -6.0f) || (pos > 6.0f) || (pos == -0.00); pos = (float)-1 * rngInt(rng, 2) * rngInt(rng, 7));
+
+			// Store them in the column for this axis
+			if (j == X_){
+				motion->velX[slot] = vel;
+				motion->posX[slot] = pos;
+			}
+			else {
+				motion->velY[slot] = vel;
+				motion->posY[slot] = pos;
+			}
+		}
+	}
+}
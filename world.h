@@ -0,0 +1,168 @@
+#ifndef __WORLD__
+#define __WORLD__
+
+#include "objects.h"
+#include "datastructures.h"
+#include "grid.h"
+#include "batch.h"
+#include "rng.h"
+#include "profiler.h"
+
+/*
+	@file world.h
+	@author Derek Batts - dsbatts@ncsu.edu
+	This header file defines the game world and the functions that run it one tick at a time.
+	Nothing in here knows about GLUT or OpenGL, so the game can run without a window.
+*/
+
+// The max number of asteroids that cand spawn at the begining of a screen / level
+#define MAX_NUM_ASTEROIDS 6
+// The time between aliens spawning
+#define ALIEN_SPAWN_TIME 700
+// The minimum lifetime score needed for a small alien ship to spawn
+#define ALIEN_SMALL_SPAWN_REQ 5000
+// The amount of score needed to get a new life
+#define NEW_LIFE_REQ 7000
+// An input bit asking for the game to be restarted before the tick runs (player bits are in objects.h)
+#define INPUT_RESTART 0x10
+// The slowest and fastest a world can be stepped
+#define MIN_TICK_RATE 10
+#define MAX_TICK_RATE 1000
+
+// A struct holding the sizes of everything a world allocates up front
+typedef struct {
+	// The most asteroids that can be alive at once
+	int maxAsteroids;
+	// The most missles that can be in flight at once (per shooter)
+	int maxMissles;
+	// The most aliens that can be alive at once
+	int maxAliens;
+	// The most explosions that can be going at once
+	int maxExplosions;
+	// How many times a second the world is stepped
+	int tickRate;
+	// The seed every random number in the world comes from
+	uint64_t seed;
+} WorldConfig;
+
+// A struct holding everything in a running game
+typedef struct {
+	// The player's ship
+	PlayerShip* p;
+	// Pools of everything else in the game
+	ObjectPool* asteroids;
+	ObjectPool* playerShots;
+	ObjectPool* explosions;
+	ObjectPool* aliens;
+	ObjectPool* alienShots;
+	// Grids used to find collision candidates
+	SpatialGrid* playerShotGrid;
+	SpatialGrid* alienShotGrid;
+	SpatialGrid* alienGrid;
+	// Scratch space for packing collision candidates into blocks for the batch tests
+	TargetBlock* targets;
+	// The number of asteroid to spawn on a new screen
+	int num_asteroids;
+	// The timer to count until a new alien spawns
+	float alienTimer;
+	// Whether the first (always big) alien of this screen has spawned
+	bool firstSpawned;
+	// The score the player has earned since the game started (never spent on lives)
+	int lifetimeScore;
+	// The score the player earned during the last tick
+	int tickScore;
+	// The number of ticks the world has been stepped
+	unsigned int ticks;
+	// The number of times the player has died since the world was made (restarts do not reset it)
+	unsigned int deaths;
+	// How many ticks the world is stepped a second
+	int tickRate;
+	// How many base ticks (SIM_BASE_HZ) a single tick lasts
+	float dt;
+	// The seed every random number in the world comes from
+	uint64_t seed;
+	// The world's own stream, used for spawning and setting up levels
+	Rng rng;
+	// The number of aliens spawned so far, each one gets the next alien stream
+	uint64_t aliensSpawned;
+	// The profiler timing every tick, or NULL if nobody is watching (never part of a snapshot)
+	Profiler* profiler;
+} World;
+
+/*
+	This function fills in a config with the sizes the game normally runs with.
+	@param config A pointer to the config to fill in.
+ */
+void defaultWorldConfig(WorldConfig* config);
+
+/*
+	This function creates a world and starts a new game in it.
+	All of the memory the world will ever use is allocated here.
+	@param config The sizes to use, or NULL for the defaults.
+	@return A pointer to the world that was made.
+ */
+World* createWorld(const WorldConfig* config);
+
+/*
+	This function frees a world and everything in it.
+	@param world A pointer to the world to destroy.
+ */
+void destroyWorld(World* world);
+
+/*
+	This function advances the world by one tick of 1 / tickRate seconds.
+	@param world A pointer to the world to step.
+	@param input The INPUT_ bits for this tick.
+ */
+void stepWorld(World* world, unsigned int input);
+
+/*
+	This function restarts the game as if it had just been launched.
+	@param world A pointer to the world to restart.
+ */
+void restartWorld(World* world);
+
+/*
+	This function adds randomly placed asteroids to the world according to the specified rules,
+	a new screen is filled with num_asteroids of them.
+	@param world A pointer to the world to add asteroids to.
+	@param count The number of asteroids to add, it stops early if the pool fills up.
+ */
+void addAsteroids(World* world, int count);
+
+/*
+	This function works out how many bytes a snapshot of the world takes right now.
+	@param world A pointer to the world.
+	@return The number of bytes.
+ */
+size_t worldSnapshotSize(const World* world);
+
+/*
+	This function works out the most bytes a snapshot of the world could ever take,
+	so a buffer of this size can hold any snapshot of it.
+	@param world A pointer to the world.
+	@return The number of bytes.
+ */
+size_t maxWorldSnapshotSize(const World* world);
+
+/*
+	This function copies the whole state of a world into one flat buffer.
+	The buffer holds no pointers, so it can be copied around with memcpy.
+	@param world A pointer to the world to save.
+	@param buffer Where to write the snapshot.
+	@param capacity The number of bytes of room in the buffer.
+	@return The number of bytes written, or 0 if the buffer is too small.
+ */
+size_t snapshotWorld(const World* world, void* buffer, size_t capacity);
+
+/*
+	This function puts a world back the way it was when a snapshot was taken.
+	The world must have been made with the same config as the one saved.
+	@param world A pointer to the world to restore.
+	@param buffer The snapshot.
+	@param size The number of bytes in the snapshot.
+	@return True if the world was restored, false if the snapshot does not fit this world.
+ */
+bool restoreWorld(World* world, const void* buffer, size_t size);
+
+#endif